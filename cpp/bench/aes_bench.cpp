@@ -0,0 +1,135 @@
+#include "bench.hpp"
+
+#include <aes.hpp>
+#include <block.hpp>
+#include <packed_block.hpp>
+#include <padding.hpp>
+#include <raw_bytes.hpp>
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+constexpr size_t AES_BENCH_MESSAGE_BYTES = 4096;
+constexpr size_t AES_BENCH_ITERATIONS = 2000;
+constexpr size_t MIX_COLUMNS_BENCH_ITERATIONS = 10000000;
+
+// The per-block to_word_array/from_word_array glue AES_ECB_encrypt used
+// before the kernels read raw bytes, kept here as the baseline
+static RawBytes legacy_ECB_encrypt(const RawBytes &plaintext_raw,
+                                   const AES128KeySchedule &key_schedule) {
+  RawBytes ciphertext_raw(pkcs7_padded_length(plaintext_raw.size()));
+  std::copy(std::begin(plaintext_raw), std::end(plaintext_raw),
+            std::begin(ciphertext_raw));
+  pad_pkcs7_in_place(ciphertext_raw, plaintext_raw.size());
+
+  const size_t num_blocks = ciphertext_raw.size() / BLOCK_SIZE_BYTES;
+  for (size_t block_index = 0; block_index < num_blocks; ++block_index) {
+    ByteBlock plaintext;
+    to_word_array<RawBytes, BLOCK_SIZE_WORDS>(
+        ciphertext_raw, plaintext, block_index * BLOCK_SIZE_BYTES);
+    ByteBlock ciphertext;
+    AES_cipher(plaintext, ciphertext, key_schedule);
+    from_word_array<RawBytes, BLOCK_SIZE_WORDS>(
+        ciphertext, ciphertext_raw, block_index * BLOCK_SIZE_BYTES);
+  }
+  return ciphertext_raw;
+}
+
+void bench_aes() {
+  std::cout << "---- AES-128 ----" << std::endl;
+
+  const c_AES128SecretKeyEncrypter encrypter;
+  const AES128KeySchedule &key_schedule = encrypter.m_key_schedule;
+  // One short of a block boundary, so padding fills a single byte
+  const RawBytes plaintext_raw(AES_BENCH_MESSAGE_BYTES - 1, 'A');
+  const size_t num_blocks =
+      pkcs7_padded_length(plaintext_raw.size()) / BLOCK_SIZE_BYTES;
+
+  if (legacy_ECB_encrypt(plaintext_raw, key_schedule) !=
+      AES_ECB_encrypt(plaintext_raw, key_schedule)) {
+    throw std::logic_error("ECB implementations disagree!");
+  }
+
+  const double legacy_ns =
+      time_ns_per_op(AES_BENCH_ITERATIONS, [&] {
+        do_not_optimize(legacy_ECB_encrypt(plaintext_raw, key_schedule));
+      }) /
+      num_blocks;
+  print_bench_result("ECB encrypt, per-block glue (block)", legacy_ns);
+
+  const double ecb_ns =
+      time_ns_per_op(AES_BENCH_ITERATIONS, [&] {
+        do_not_optimize(AES_ECB_encrypt(plaintext_raw, key_schedule));
+      }) /
+      num_blocks;
+  print_bench_result("ECB encrypt, AES_ECB_encrypt (block)", ecb_ns,
+                     legacy_ns);
+
+  RawBytes buffer_raw(num_blocks * BLOCK_SIZE_BYTES);
+  const double kernel_ns =
+      time_ns_per_op(AES_BENCH_ITERATIONS, [&] {
+        AES_cipher_bytes(buffer_raw.data(), buffer_raw.data(), num_blocks,
+                         key_schedule);
+        do_not_optimize(buffer_raw);
+      }) /
+      num_blocks;
+  print_bench_result("kernel only, AES_cipher_bytes (block)", kernel_ns,
+                     legacy_ns);
+
+  const RawBytes ciphertext_raw = AES_ECB_encrypt(plaintext_raw, key_schedule);
+  const double decrypt_ns =
+      time_ns_per_op(AES_BENCH_ITERATIONS, [&] {
+        do_not_optimize(AES_ECB_decrypt(ciphertext_raw,
+                                        encrypter.m_decryption_key_schedule));
+      }) /
+      num_blocks;
+  print_bench_result("ECB decrypt, AES_ECB_decrypt (block)", decrypt_ns,
+                     ecb_ns);
+
+  c_PackedBlock block = load_block(ciphertext_raw.data());
+  const double inv_cipher_ns =
+      time_ns_per_op(AES_BENCH_ITERATIONS * num_blocks, [&] {
+        AES_inv_cipher(block, key_schedule);
+        do_not_optimize(block);
+      });
+  print_bench_result("inverse cipher (block)", inv_cipher_ns);
+
+  const double eq_inv_cipher_ns =
+      time_ns_per_op(AES_BENCH_ITERATIONS * num_blocks, [&] {
+        AES_inv_cipher(block, encrypter.m_decryption_key_schedule);
+        do_not_optimize(block);
+      });
+  print_bench_result("equivalent inverse cipher (block)", eq_inv_cipher_ns,
+                     inv_cipher_ns);
+
+  c_PackedBlock state = load_block(plaintext_raw.data());
+  const double mix_tables_ns =
+      time_ns_per_op(MIX_COLUMNS_BENCH_ITERATIONS, [&state] {
+        mix_columns_tables(state);
+        do_not_optimize(state);
+      });
+  print_bench_result("MixColumns, tables", mix_tables_ns);
+
+  const double mix_xtime_ns =
+      time_ns_per_op(MIX_COLUMNS_BENCH_ITERATIONS, [&state] {
+        mix_columns_xtime(state);
+        do_not_optimize(state);
+      });
+  print_bench_result("MixColumns, xtime", mix_xtime_ns, mix_tables_ns);
+
+  const double inv_mix_tables_ns =
+      time_ns_per_op(MIX_COLUMNS_BENCH_ITERATIONS, [&state] {
+        inv_mix_columns_tables(state);
+        do_not_optimize(state);
+      });
+  print_bench_result("InvMixColumns, tables", inv_mix_tables_ns);
+
+  const double inv_mix_xtime_ns =
+      time_ns_per_op(MIX_COLUMNS_BENCH_ITERATIONS, [&state] {
+        inv_mix_columns_xtime(state);
+        do_not_optimize(state);
+      });
+  print_bench_result("InvMixColumns, xtime", inv_mix_xtime_ns,
+                     inv_mix_tables_ns);
+}
@@ -0,0 +1,71 @@
+#include "bench.hpp"
+
+#include <analysis.hpp>
+#include <crypt.hpp>
+#include <freq_map.hpp>
+#include <raw_bytes.hpp>
+
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+constexpr size_t ANALYSIS_BENCH_TEXT_BYTES = 4096;
+constexpr size_t ANALYSIS_BENCH_ITERATIONS = 20;
+
+// What find_likely_single_xor used to do: XOR and rebuild the frequency map
+// for every key
+static std::pair<char, double> find_single_xor_per_key(const RawBytes &input) {
+  double score = std::numeric_limits<double>::max();
+  char winner = 0;
+  for (size_t key = 0; key < 256; ++key) {
+    const double test_score =
+        score_freq(gen_frequency(input ^ uint8_t(key)));
+    if (test_score < score) {
+      score = test_score;
+      winner = char(key);
+    }
+  }
+  return std::make_pair(winner, score);
+}
+
+void bench_analysis() {
+  std::cout << "---- Analysis (" << ANALYSIS_BENCH_TEXT_BYTES
+            << " byte text) ----" << std::endl;
+
+  const std::string sentence =
+      "the quick brown fox jumps over the lazy dog while the cat sleeps. ";
+  RawBytes plaintext_raw;
+  while (plaintext_raw.size() < ANALYSIS_BENCH_TEXT_BYTES) {
+    plaintext_raw.insert(plaintext_raw.end(), sentence.begin(),
+                         sentence.end());
+  }
+  plaintext_raw.resize(ANALYSIS_BENCH_TEXT_BYTES);
+  const RawBytes ciphertext_raw = plaintext_raw ^ uint8_t(0x5a);
+  if (find_likely_single_xor(ciphertext_raw).first != char(0x5a)) {
+    throw std::logic_error("Single byte XOR was not recovered!");
+  }
+
+  const double histogram_ns =
+      time_ns_per_op(ANALYSIS_BENCH_ITERATIONS * 100,
+                     [&] { do_not_optimize(gen_histogram(ciphertext_raw)); });
+  print_bench_result("gen_histogram", histogram_ns);
+
+  const double per_key_ns = time_ns_per_op(ANALYSIS_BENCH_ITERATIONS, [&] {
+    do_not_optimize(find_single_xor_per_key(ciphertext_raw));
+  });
+  const double histogram_keys_ns = time_ns_per_op(
+      ANALYSIS_BENCH_ITERATIONS,
+      [&] { do_not_optimize(find_likely_single_xor(ciphertext_raw)); });
+  print_bench_result("single XOR, frequency map per key", per_key_ns);
+  print_bench_result("single XOR, one histogram", histogram_keys_ns,
+                     per_key_ns);
+
+  const RawBytes key_raw = from_ascii_string("Terminator X: Bring the noise");
+  const RawBytes repeating_raw = encrypt_repeating_xor(plaintext_raw, key_raw);
+  const double key_ns = time_ns_per_op(ANALYSIS_BENCH_ITERATIONS, [&] {
+    do_not_optimize(find_likely_key(repeating_raw, key_raw.size()));
+  });
+  print_bench_result("find_likely_key, 29 byte key", key_ns);
+}
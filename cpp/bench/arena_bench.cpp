@@ -0,0 +1,180 @@
+#include "bench.hpp"
+
+#include <aes.hpp>
+#include <arena.hpp>
+#include <crypt.hpp>
+#include <oracle.hpp>
+#include <raw_bytes.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory_resource>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+// Counts every heap allocation in this binary, which is why it is kept out
+// of crypt-bench
+static std::atomic<size_t> num_heap_allocations{0};
+
+void *operator new(const size_t num_bytes) {
+  ++num_heap_allocations;
+  if (void *output = std::malloc(num_bytes == 0 ? 1 : num_bytes)) {
+    return output;
+  }
+  throw std::bad_alloc();
+}
+
+void *operator new[](const size_t num_bytes) { return operator new(num_bytes); }
+
+void *operator new(const size_t num_bytes, const std::align_val_t alignment) {
+  ++num_heap_allocations;
+  const size_t alignment_bytes = size_t(alignment);
+  const size_t padded_bytes =
+      (std::max<size_t>(num_bytes, 1) + alignment_bytes - 1) &
+      ~(alignment_bytes - 1);
+  if (void *output = std::aligned_alloc(alignment_bytes, padded_bytes)) {
+    return output;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void *pointer) noexcept { std::free(pointer); }
+
+void operator delete[](void *pointer) noexcept { std::free(pointer); }
+
+void operator delete(void *pointer, size_t) noexcept { std::free(pointer); }
+
+void operator delete[](void *pointer, size_t) noexcept { std::free(pointer); }
+
+void operator delete(void *pointer, std::align_val_t) noexcept {
+  std::free(pointer);
+}
+
+void operator delete(void *pointer, size_t, std::align_val_t) noexcept {
+  std::free(pointer);
+}
+
+constexpr size_t ARENA_BENCH_XOR_INPUT_BYTES = 256;
+constexpr size_t ARENA_BENCH_XOR_ITERATIONS = 200;
+constexpr size_t ARENA_BENCH_DETECT_ITERATIONS = 2000;
+constexpr size_t ARENA_BENCH_BREAK_ITERATIONS = 3;
+constexpr size_t ARENA_BENCH_BREAK_THREADS = 4;
+
+template <typename FuncType>
+double heap_allocations_per_op(const size_t num_iterations, FuncType &&func) {
+  func();
+  const size_t begin = num_heap_allocations;
+  for (size_t iter = 0; iter < num_iterations; ++iter) {
+    func();
+  }
+  return double(num_heap_allocations - begin) / num_iterations;
+}
+
+static void print_arena_result(const std::string_view name,
+                               const double ns_per_op,
+                               const double allocations_per_op,
+                               const double baseline_ns_per_op = 0.0) {
+  std::cout << std::left << std::setw(40) << name << std::right
+            << std::setw(10) << std::fixed << std::setprecision(1)
+            << ns_per_op << " ns/op" << std::setw(10) << allocations_per_op
+            << " allocs/op";
+  if (baseline_ns_per_op > 0.0) {
+    std::cout << std::setw(8) << std::setprecision(2)
+              << baseline_ns_per_op / ns_per_op << "x";
+  }
+  std::cout << std::endl;
+}
+
+// Runs func with its scratch buffers on the heap, then in the arena
+template <typename FuncType>
+void bench_scratch_resources(const std::string_view name,
+                             const size_t num_iterations, FuncType &&func) {
+  set_scratch_resource(std::pmr::new_delete_resource());
+  const double heap_ns = time_ns_per_op(num_iterations, func);
+  const double heap_allocations = heap_allocations_per_op(num_iterations, func);
+  set_scratch_resource(nullptr);
+  const double arena_ns = time_ns_per_op(num_iterations, func);
+  const double arena_allocations =
+      heap_allocations_per_op(num_iterations, func);
+
+  std::cout << name << std::endl;
+  print_arena_result("  scratch on the heap", heap_ns, heap_allocations);
+  print_arena_result("  scratch in the arena", arena_ns, arena_allocations,
+                     heap_ns);
+}
+
+int main() {
+  std::cout << "---- Scratch arena ----" << std::endl;
+
+  const RawBytes input_raw(ARENA_BENCH_XOR_INPUT_BYTES, 'A');
+  const double copy_ns = time_ns_per_op(ARENA_BENCH_XOR_ITERATIONS, [&] {
+    for (size_t key = 0; key < 256; ++key) {
+      do_not_optimize(input_raw ^ uint8_t(key));
+    }
+  });
+  const double copy_allocations =
+      heap_allocations_per_op(ARENA_BENCH_XOR_ITERATIONS, [&] {
+        for (size_t key = 0; key < 256; ++key) {
+          do_not_optimize(input_raw ^ uint8_t(key));
+        }
+      });
+  const auto xor_into_scratch = [&] {
+    c_ScratchScope scope;
+    ScratchBytes output_raw(std::begin(input_raw), std::end(input_raw),
+                            scratch_resource());
+    for (size_t key = 1; key < 256; ++key) {
+      xor_in_place(output_raw, uint8_t(key ^ (key - 1)));
+      do_not_optimize(output_raw);
+    }
+  };
+  const double scratch_ns =
+      time_ns_per_op(ARENA_BENCH_XOR_ITERATIONS, xor_into_scratch);
+  const double scratch_allocations =
+      heap_allocations_per_op(ARENA_BENCH_XOR_ITERATIONS, xor_into_scratch);
+  std::cout << "XOR with all 256 keys" << std::endl;
+  print_arena_result("  operator^ copies", copy_ns, copy_allocations);
+  print_arena_result("  one scratch buffer", scratch_ns, scratch_allocations,
+                     copy_ns);
+
+  const RawBytes secret_suffix_raw(138, 'S');
+  c_AES128SecretKeyEncrypter encrypter;
+  c_ECBSuffixOracle oracle(encrypter, secret_suffix_raw);
+
+  bench_scratch_resources("detect_length_bytes",
+                          ARENA_BENCH_DETECT_ITERATIONS, [&] {
+                            do_not_optimize(detect_length_bytes(
+                                BLOCK_SIZE_BYTES, oracle));
+                          });
+
+  // Worker threads get the caller's override, but each new thread starts an
+  // arena of its own, whose first chunk comes from the heap
+  for (const size_t num_threads : {size_t(1), ARENA_BENCH_BREAK_THREADS}) {
+    c_ByteAtATimeConfig config;
+    config.m_num_threads = num_threads;
+    bench_scratch_resources(
+        "break_ecb_byte_at_a_time on " + std::to_string(num_threads) +
+            ((num_threads == 1) ? " thread" : " threads"),
+        ARENA_BENCH_BREAK_ITERATIONS, [&] {
+          c_ByteAtATimeStats stats;
+          const RawBytes decrypted_raw =
+              break_ecb_byte_at_a_time(BLOCK_SIZE_BYTES,
+                                       secret_suffix_raw.size(), oracle,
+                                       config, stats);
+          if (decrypted_raw != secret_suffix_raw) {
+            throw std::logic_error("Byte at a time attack failed!");
+          }
+        });
+  }
+
+  const c_ArenaStats &stats = scratch_arena().m_stats;
+  std::cout << "Arena: " << stats.m_num_allocations << " allocations served by "
+            << stats.m_num_chunk_allocations << " chunks, high water "
+            << stats.m_high_water_bytes << " bytes" << std::endl;
+
+  return 0;
+}
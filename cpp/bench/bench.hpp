@@ -0,0 +1,41 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string_view>
+
+// Keeps the compiler from discarding a result that is otherwise unused
+template <typename ValueType> void do_not_optimize(const ValueType &value) {
+  asm volatile("" : : "r"(&value) : "memory");
+}
+
+// Mean wall clock nanoseconds per call of func over num_iterations calls
+template <typename FuncType>
+double time_ns_per_op(const size_t num_iterations, FuncType &&func) {
+  // Warm caches and branch predictors first
+  for (size_t iter = 0; iter < num_iterations / 10 + 1; ++iter) {
+    func();
+  }
+  const auto begin = std::chrono::steady_clock::now();
+  for (size_t iter = 0; iter < num_iterations; ++iter) {
+    func();
+  }
+  const std::chrono::duration<double, std::nano> elapsed =
+      std::chrono::steady_clock::now() - begin;
+  return elapsed.count() / num_iterations;
+}
+
+inline void print_bench_result(const std::string_view name,
+                               const double ns_per_op,
+                               const double baseline_ns_per_op = 0.0) {
+  std::cout << std::left << std::setw(40) << name << std::right
+            << std::setw(10) << std::fixed << std::setprecision(1)
+            << ns_per_op << " ns/op";
+  if (baseline_ns_per_op > 0.0) {
+    std::cout << std::setw(8) << std::setprecision(2)
+              << baseline_ns_per_op / ns_per_op << "x";
+  }
+  std::cout << std::endl;
+}
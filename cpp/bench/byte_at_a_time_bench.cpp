@@ -0,0 +1,77 @@
+#include "bench.hpp"
+
+#include <aes.hpp>
+#include <crypt.hpp>
+#include <oracle.hpp>
+#include <raw_bytes.hpp>
+
+#include <array>
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+constexpr size_t BYTE_AT_A_TIME_BENCH_SUFFIX_BYTES = 138;
+constexpr size_t BYTE_AT_A_TIME_BENCH_ITERATIONS = 5;
+// Round trip of an oracle behind a network hop
+constexpr std::chrono::microseconds BYTE_AT_A_TIME_BENCH_LATENCY{50};
+
+// Times the attack on 1, 2 and 4 threads and on every core, against 1 thread
+template <typename OracleType>
+static void bench_thread_counts(const std::string &name, OracleType &oracle,
+                                const RawBytes &secret_suffix_raw,
+                                const bool use_candidate_model,
+                                const size_t num_iterations) {
+  std::cout << name << std::endl;
+  double serial_ns = 0.0;
+  for (const size_t num_threads : std::array<size_t, 4>{1, 2, 4, 0}) {
+    c_ByteAtATimeConfig config;
+    config.m_use_candidate_model = use_candidate_model;
+    config.m_num_threads = num_threads;
+    const double ns = time_ns_per_op(num_iterations, [&] {
+      c_ByteAtATimeStats stats;
+      const RawBytes decrypted_raw = break_ecb_byte_at_a_time(
+          BLOCK_SIZE_BYTES, secret_suffix_raw.size(), oracle, config, stats);
+      if (decrypted_raw != secret_suffix_raw) {
+        throw std::logic_error("Byte at a time attack failed!");
+      }
+    });
+    if (num_threads == 1) {
+      serial_ns = ns;
+    }
+    const std::string label =
+        (num_threads == 0) ? "  every core (" +
+                                 std::to_string(
+                                     std::thread::hardware_concurrency()) +
+                                 ")"
+                           : "  " + std::to_string(num_threads) + " threads";
+    print_bench_result(label, ns, serial_ns);
+  }
+}
+
+void bench_byte_at_a_time() {
+  std::cout << "---- ECB byte at a time (" << BYTE_AT_A_TIME_BENCH_SUFFIX_BYTES
+            << " byte suffix) ----" << std::endl;
+
+  const RawBytes secret_suffix_raw = from_ascii_string(
+      std::string("Rollin' in my 5.0\nWith my rag-top down so my hair can "
+                  "blow\nThe girlies on standby waving just to say hi\nDid "
+                  "you stop? No, I just drove by\n")
+          .substr(0, BYTE_AT_A_TIME_BENCH_SUFFIX_BYTES));
+  c_AES128SecretKeyEncrypter encrypter;
+  c_ECBSuffixOracle oracle(encrypter, secret_suffix_raw);
+  bench_thread_counts("in process oracle", oracle, secret_suffix_raw, true,
+                      BYTE_AT_A_TIME_BENCH_ITERATIONS);
+
+  c_CountingOracle remote_oracle([&oracle](const ByteSpan input) {
+    std::this_thread::sleep_for(BYTE_AT_A_TIME_BENCH_LATENCY);
+    return oracle.query(input);
+  });
+  // The model finds most bytes in the first batch, leaving threads nothing
+  // to overlap; numeric order leaves several round trips per byte
+  bench_thread_counts("50 us oracle, candidate model", remote_oracle,
+                      secret_suffix_raw, true, 1);
+  bench_thread_counts("50 us oracle, numeric order", remote_oracle,
+                      secret_suffix_raw, false, 1);
+}
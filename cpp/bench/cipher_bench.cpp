@@ -0,0 +1,156 @@
+#include "bench.hpp"
+
+#include <cipher.hpp>
+#include <mode.hpp>
+#include <padding.hpp>
+#include <raw_bytes.hpp>
+#include <xts.hpp>
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+constexpr size_t CIPHER_BENCH_NUM_BLOCKS = 256;
+constexpr size_t CIPHER_BENCH_ITERATIONS = 200;
+constexpr size_t CBC_STREAMS_BENCH_NUM_STREAMS = 1024;
+constexpr size_t CBC_STREAMS_BENCH_MESSAGE_BYTES = 255;
+constexpr size_t CBC_STREAMS_BENCH_ITERATIONS = 10;
+constexpr size_t XTS_BENCH_SECTOR_BYTES = 4096;
+constexpr size_t XTS_BENCH_NUM_SECTORS = 256;
+constexpr size_t XTS_BENCH_ITERATIONS = 10;
+
+// Every registered backend against the reference kernels, per block
+void bench_cipher_backends() {
+  std::cout << "---- AES-128 backends ----" << std::endl;
+
+  const RawBytes key_raw(16, 0x2b);
+  RawBytes buffer_raw(CIPHER_BENCH_NUM_BLOCKS * BLOCK_SIZE_BYTES, 'A');
+  const ByteBlock counter{};
+
+  const auto reference = make_block_cipher("reference", key_raw);
+  const double reference_ns =
+      time_ns_per_op(CIPHER_BENCH_ITERATIONS, [&] {
+        reference->encrypt_blocks(buffer_raw.data(), buffer_raw.data(),
+                                  CIPHER_BENCH_NUM_BLOCKS);
+        do_not_optimize(buffer_raw);
+      }) /
+      CIPHER_BENCH_NUM_BLOCKS;
+
+  for (const auto &backend : get_cipher_backends()) {
+    const auto cipher = backend.m_factory(key_raw);
+    const double encrypt_ns =
+        time_ns_per_op(CIPHER_BENCH_ITERATIONS, [&] {
+          cipher->encrypt_blocks(buffer_raw.data(), buffer_raw.data(),
+                                 CIPHER_BENCH_NUM_BLOCKS);
+          do_not_optimize(buffer_raw);
+        }) /
+        CIPHER_BENCH_NUM_BLOCKS;
+    print_bench_result(backend.m_name + " encrypt (block)", encrypt_ns,
+                       reference_ns);
+
+    const double decrypt_ns =
+        time_ns_per_op(CIPHER_BENCH_ITERATIONS, [&] {
+          cipher->decrypt_blocks(buffer_raw.data(), buffer_raw.data(),
+                                 CIPHER_BENCH_NUM_BLOCKS);
+          do_not_optimize(buffer_raw);
+        }) /
+        CIPHER_BENCH_NUM_BLOCKS;
+    print_bench_result(backend.m_name + " decrypt (block)", decrypt_ns,
+                       reference_ns);
+
+    const double ctr_ns =
+        time_ns_per_op(CIPHER_BENCH_ITERATIONS, [&] {
+          CTR_crypt(*cipher, counter, buffer_raw, buffer_raw);
+          do_not_optimize(buffer_raw);
+        }) /
+        CIPHER_BENCH_NUM_BLOCKS;
+    print_bench_result(backend.m_name + " CTR (block)", ctr_ns, reference_ns);
+  }
+}
+
+// Many short messages, the session payload case
+void bench_cbc_streams() {
+  std::cout << "---- AES-128 CBC streams ----" << std::endl;
+
+  const RawBytes key_raw(16, 0x2b);
+  const std::vector<RawBytes> plaintexts(
+      CBC_STREAMS_BENCH_NUM_STREAMS,
+      RawBytes(CBC_STREAMS_BENCH_MESSAGE_BYTES, 'A'));
+  std::vector<ByteBlock> ivs(CBC_STREAMS_BENCH_NUM_STREAMS);
+  for (size_t stream_index = 0; stream_index < ivs.size(); ++stream_index) {
+    ivs[stream_index][0][0] = uint8_t(stream_index);
+  }
+  const size_t num_blocks =
+      CBC_STREAMS_BENCH_NUM_STREAMS *
+      pkcs7_padded_length(CBC_STREAMS_BENCH_MESSAGE_BYTES) / BLOCK_SIZE_BYTES;
+
+  for (const auto &backend : get_cipher_backends()) {
+    const auto cipher = backend.m_factory(key_raw);
+    if (CBC_encrypt_streams(*cipher, plaintexts, ivs).back() !=
+        CBC_encrypt(*cipher, plaintexts.back(), ivs.back())) {
+      throw std::logic_error("CBC stream encryption disagrees!");
+    }
+
+    const double serial_ns =
+        time_ns_per_op(CBC_STREAMS_BENCH_ITERATIONS, [&] {
+          for (size_t stream_index = 0; stream_index < plaintexts.size();
+               ++stream_index) {
+            do_not_optimize(CBC_encrypt(*cipher, plaintexts[stream_index],
+                                        ivs[stream_index]));
+          }
+        }) /
+        num_blocks;
+    print_bench_result(backend.m_name + " CBC, one at a time (block)",
+                       serial_ns);
+
+    const double streams_ns =
+        time_ns_per_op(CBC_STREAMS_BENCH_ITERATIONS, [&] {
+          do_not_optimize(CBC_encrypt_streams(*cipher, plaintexts, ivs));
+        }) /
+        num_blocks;
+    print_bench_result(backend.m_name + " CBC, streams (block)", streams_ns,
+                       serial_ns);
+
+    const double ecb_ns =
+        time_ns_per_op(CBC_STREAMS_BENCH_ITERATIONS, [&] {
+          for (const auto &plaintext_raw : plaintexts) {
+            do_not_optimize(ECB_encrypt(*cipher, plaintext_raw));
+          }
+        }) /
+        num_blocks;
+    print_bench_result(backend.m_name + " ECB, for scale (block)", ecb_ns,
+                       serial_ns);
+  }
+}
+
+// 1 MiB of 4 KiB sectors with the default backend, one thread against all
+void bench_xts() {
+  std::cout << "---- XTS-AES-128 ----" << std::endl;
+
+  const c_XTSCipher cipher(RawBytes(XTS_AES_128_KEY_LENGTH_BYTES, 0x2b));
+  RawBytes buffer_raw(XTS_BENCH_NUM_SECTORS * XTS_BENCH_SECTOR_BYTES, 'A');
+  const size_t num_blocks = buffer_raw.size() / BLOCK_SIZE_BYTES;
+
+  const double single_ns =
+      time_ns_per_op(XTS_BENCH_ITERATIONS, [&] {
+        cipher.encrypt_sectors(0, XTS_BENCH_SECTOR_BYTES, buffer_raw,
+                               buffer_raw, 1);
+        do_not_optimize(buffer_raw);
+      }) /
+      num_blocks;
+  print_bench_result("encrypt_sectors, 1 thread (block)", single_ns);
+
+  const double parallel_ns =
+      time_ns_per_op(XTS_BENCH_ITERATIONS, [&] {
+        cipher.encrypt_sectors(0, XTS_BENCH_SECTOR_BYTES, buffer_raw,
+                               buffer_raw);
+        do_not_optimize(buffer_raw);
+      }) /
+      num_blocks;
+  print_bench_result("encrypt_sectors, " +
+                         std::to_string(std::thread::hardware_concurrency()) +
+                         " threads (block)",
+                     parallel_ns, single_ns);
+}
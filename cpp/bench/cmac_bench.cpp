@@ -0,0 +1,49 @@
+#include "bench.hpp"
+
+#include <aes.hpp>
+#include <cmac.hpp>
+#include <raw_bytes.hpp>
+
+#include <iostream>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+constexpr size_t CMAC_BENCH_NUM_MESSAGES = 1024;
+constexpr size_t CMAC_BENCH_MESSAGE_BYTES = 256;
+constexpr size_t CMAC_BENCH_ITERATIONS = 10;
+
+void bench_cmac() {
+  std::cout << "---- AES-128 CMAC ----" << std::endl;
+
+  const AES128KeySchedule key_schedule =
+      gen_key_schedule(gen_key<AES128Key>(RawBytes(16, 0x2b)));
+  const std::vector<RawBytes> messages(CMAC_BENCH_NUM_MESSAGES,
+                                       RawBytes(CMAC_BENCH_MESSAGE_BYTES, 'A'));
+  const std::vector<ByteSpan> message_spans(messages.begin(), messages.end());
+  const size_t num_blocks =
+      CMAC_BENCH_NUM_MESSAGES * CMAC_BENCH_MESSAGE_BYTES / BLOCK_SIZE_BYTES;
+
+  if (CMAC_batch(key_schedule, std::span{message_spans}).back() !=
+      CMAC(key_schedule, message_spans.back())) {
+    throw std::logic_error("CMAC implementations disagree!");
+  }
+
+  c_AES128CMAC cmac(key_schedule);
+  const double streaming_ns =
+      time_ns_per_op(CMAC_BENCH_ITERATIONS, [&] {
+        for (const auto &message : message_spans) {
+          cmac.update(message);
+          do_not_optimize(cmac.finalize());
+        }
+      }) /
+      num_blocks;
+  print_bench_result("c_CMAC, one message at a time (block)", streaming_ns);
+
+  const double batch_ns =
+      time_ns_per_op(CMAC_BENCH_ITERATIONS, [&] {
+        do_not_optimize(CMAC_batch(key_schedule, std::span{message_spans}));
+      }) /
+      num_blocks;
+  print_bench_result("CMAC_batch (block)", batch_ns, streaming_ns);
+}
@@ -0,0 +1,141 @@
+#include "bench.hpp"
+
+#include <aes.hpp>
+#include <cookie.hpp>
+
+#include <array>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+constexpr size_t COOKIE_BENCH_ITERATIONS = 1000000;
+constexpr size_t COOKIE_BATCH_SIZE = 256;
+constexpr size_t COOKIE_BATCH_ITERATIONS = 2000;
+
+// The substr/stoi/stringstream implementation the view based code replaced,
+// kept here as the baseline
+static c_ProfileCookie legacy_from_string(const std::string &input) {
+  size_t str_pos = 0;
+  c_ProfileCookie output;
+  while (str_pos < input.size()) {
+    size_t equal_pos = input.find_first_of('=', str_pos);
+    std::string key_str = input.substr(str_pos, equal_pos - str_pos);
+    size_t and_pos = input.find_first_of('&', equal_pos);
+    if (and_pos == std::string_view::npos) {
+      and_pos = input.size();
+    }
+    std::string value_str =
+        input.substr(equal_pos + 1, and_pos - (equal_pos + 1));
+    if (key_str == "email") {
+      output.m_email = value_str;
+    } else if (key_str == "uid") {
+      output.m_uid = std::stoi(value_str);
+    } else if (key_str == "role") {
+      output.m_role = value_str;
+    } else {
+      throw std::invalid_argument(key_str);
+    }
+    str_pos = and_pos + 1;
+  }
+  return output;
+}
+
+static std::string legacy_to_string(const c_ProfileCookie &cookie) {
+  std::stringstream string_stream;
+  string_stream << "email=" << c_ProfileCookie::encode_string(cookie.m_email);
+  string_stream << "&";
+  string_stream << "uid=" << cookie.m_uid;
+  string_stream << "&";
+  string_stream << "role=" << cookie.m_role;
+  return string_stream.str();
+}
+
+void bench_cookie() {
+  std::cout << "---- c_ProfileCookie ----" << std::endl;
+
+  const c_ProfileCookie cookie("some.user.name@example.com", 1234567, "user");
+  const std::string cookie_string = cookie.to_string();
+  if (legacy_to_string(cookie) != cookie_string) {
+    throw std::logic_error("Serializers disagree!");
+  }
+
+  const double legacy_parse_ns =
+      time_ns_per_op(COOKIE_BENCH_ITERATIONS, [&cookie_string] {
+        do_not_optimize(legacy_from_string(cookie_string));
+      });
+  print_bench_result("parse: substr + stoi", legacy_parse_ns);
+
+  const double from_string_ns =
+      time_ns_per_op(COOKIE_BENCH_ITERATIONS, [&cookie_string] {
+        do_not_optimize(c_ProfileCookie::from_string(cookie_string));
+      });
+  print_bench_result("parse: from_string", from_string_ns, legacy_parse_ns);
+
+  const double view_parse_ns =
+      time_ns_per_op(COOKIE_BENCH_ITERATIONS, [&cookie_string] {
+        c_ProfileCookieView view;
+        do_not_optimize(parse_profile_cookie(cookie_string, view));
+        do_not_optimize(view);
+      });
+  print_bench_result("parse: parse_profile_cookie", view_parse_ns,
+                     legacy_parse_ns);
+
+  const double legacy_serialize_ns =
+      time_ns_per_op(COOKIE_BENCH_ITERATIONS,
+                     [&cookie] { do_not_optimize(legacy_to_string(cookie)); });
+  print_bench_result("serialize: stringstream", legacy_serialize_ns);
+
+  const double to_string_ns =
+      time_ns_per_op(COOKIE_BENCH_ITERATIONS,
+                     [&cookie] { do_not_optimize(cookie.to_string()); });
+  print_bench_result("serialize: to_string", to_string_ns,
+                     legacy_serialize_ns);
+
+  std::array<char, 128> buffer;
+  const c_ProfileCookieView view = cookie.view();
+  const double view_serialize_ns =
+      time_ns_per_op(COOKIE_BENCH_ITERATIONS, [&buffer, &view] {
+        size_t num_written = 0;
+        serialize_profile_cookie(view, buffer, num_written);
+        do_not_optimize(buffer);
+      });
+  print_bench_result("serialize: serialize_profile_cookie",
+                     view_serialize_ns, legacy_serialize_ns);
+
+  const std::string email = "some.user.name@example.com";
+  const double profile_for_ns =
+      time_ns_per_op(COOKIE_BENCH_ITERATIONS,
+                     [&email] { do_not_optimize(profile_for(email)); });
+  print_bench_result("profile_for", profile_for_ns);
+
+  c_ProfileFactory factory;
+  const std::vector<std::string_view> emails(COOKIE_BATCH_SIZE, email);
+  const double batch_ns =
+      time_ns_per_op(COOKIE_BATCH_ITERATIONS, [&factory, &emails] {
+        do_not_optimize(factory.profile_for_batch(emails));
+      });
+  print_bench_result("profile_for_batch (per cookie)",
+                     batch_ns / COOKIE_BATCH_SIZE, profile_for_ns);
+
+  const c_AES128SecretKeyEncrypter encrypter;
+  const double encrypt_each_ns =
+      time_ns_per_op(COOKIE_BATCH_ITERATIONS, [&encrypter, &email] {
+        for (size_t iter = 0; iter < COOKIE_BATCH_SIZE; ++iter) {
+          do_not_optimize(
+              encrypter.encrypt(from_ascii_string(profile_for(email))));
+        }
+      });
+  print_bench_result("profile_for + encrypt (per cookie)",
+                     encrypt_each_ns / COOKIE_BATCH_SIZE);
+
+  const double encrypt_batch_ns =
+      time_ns_per_op(COOKIE_BATCH_ITERATIONS, [&factory, &encrypter, &emails] {
+        do_not_optimize(factory.encrypt_profiles_for(encrypter, emails));
+      });
+  print_bench_result("encrypt_profiles_for (per cookie)",
+                     encrypt_batch_ns / COOKIE_BATCH_SIZE,
+                     encrypt_each_ns / COOKIE_BATCH_SIZE);
+}
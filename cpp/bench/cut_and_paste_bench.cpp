@@ -0,0 +1,126 @@
+#include "bench.hpp"
+
+#include <aes.hpp>
+#include <cookie.hpp>
+#include <cut_and_paste.hpp>
+#include <oracle.hpp>
+#include <raw_bytes.hpp>
+
+#include <array>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+constexpr size_t CUT_AND_PASTE_BENCH_VARIANTS = 4096;
+
+static constexpr std::array<std::string_view, 8> CUT_AND_PASTE_BENCH_FIELDS = {
+    "email", "mail", "user", "login", "e", "address", "account", "id"};
+
+// profile_for with its own field names and a fixed uid
+struct c_CookieFormat {
+  std::string operator()(const std::string_view email) const {
+    return to_string(email, "user");
+  }
+
+  std::string to_string(const std::string_view email,
+                        const std::string_view role) const {
+    std::string output(m_email_field);
+    output += '=';
+    output += c_ProfileCookie::encode_string(std::string(email));
+    output += '&';
+    output += m_uid_field;
+    output += '=';
+    output += std::to_string(m_uid);
+    output += '&';
+    output += m_role_field;
+    output += '=';
+    output += role;
+    return output;
+  }
+
+  std::string_view m_email_field;
+  std::string_view m_uid_field;
+  std::string_view m_role_field;
+  size_t m_uid = 0;
+};
+
+static c_CookieFormat gen_cookie_format(const size_t variant_index) {
+  const size_t num_fields = CUT_AND_PASTE_BENCH_FIELDS.size();
+  return {CUT_AND_PASTE_BENCH_FIELDS[variant_index % num_fields],
+          CUT_AND_PASTE_BENCH_FIELDS[(variant_index / num_fields) %
+                                     num_fields],
+          CUT_AND_PASTE_BENCH_FIELDS[(variant_index / num_fields / num_fields) %
+                                     num_fields],
+          variant_index * 7919};
+}
+
+// The first email length that puts the admin role on a block boundary
+static std::string find_admin_target(const c_CookieFormat &format) {
+  for (size_t local_length = 1; local_length <= BLOCK_SIZE_BYTES;
+       ++local_length) {
+    const std::string target = format.to_string(
+        std::string(local_length, 'x') + "@admin.com", "admin");
+    try {
+      plan_cut_and_paste(format, target, BLOCK_SIZE_BYTES);
+      return target;
+    } catch (const std::invalid_argument &) {
+    }
+  }
+  throw std::logic_error("No email length aligns the role!");
+}
+
+void bench_cut_and_paste() {
+  std::cout << "---- ECB cut and paste (" << CUT_AND_PASTE_BENCH_VARIANTS
+            << " cookie formats) ----" << std::endl;
+
+  const c_AES128Encrypter encrypter(RawBytes(BLOCK_SIZE_BYTES, 0x42));
+  std::vector<c_CookieFormat> formats;
+  std::vector<std::string> targets;
+  for (size_t variant_index = 0; variant_index < CUT_AND_PASTE_BENCH_VARIANTS;
+       ++variant_index) {
+    formats.push_back(gen_cookie_format(variant_index));
+    targets.push_back(find_admin_target(formats.back()));
+  }
+
+  std::vector<c_CutAndPastePlan> plans(formats.size());
+  const double plan_ns = time_ns_per_op(1, [&] {
+    for (size_t index = 0; index < formats.size(); ++index) {
+      plans[index] =
+          plan_cut_and_paste(formats[index], targets[index], BLOCK_SIZE_BYTES);
+    }
+  });
+
+  size_t num_oracle_calls = 0;
+  const double forge_ns = time_ns_per_op(1, [&] {
+    num_oracle_calls = 0;
+    for (size_t index = 0; index < formats.size(); ++index) {
+      const c_CookieFormat &format = formats[index];
+      c_CountingOracle oracle([&encrypter, &format](const ByteSpan input) {
+        return encrypter.encrypt(from_ascii_string(format(std::string_view(
+            reinterpret_cast<const char *>(input.data()), input.size()))));
+      });
+      const RawBytes forged_raw =
+          forge_cut_and_paste(plans[index], BLOCK_SIZE_BYTES, oracle);
+      if (encrypter.decrypt(forged_raw) != from_ascii_string(targets[index])) {
+        throw std::logic_error("Forged cookie does not decrypt to the target!");
+      }
+      num_oracle_calls += oracle.m_stats.m_num_calls;
+    }
+  });
+
+  const double search_ns = time_ns_per_op(1, [&] {
+    for (const c_CookieFormat &format : formats) {
+      do_not_optimize(find_admin_target(format));
+    }
+  });
+
+  const double num_formats = double(formats.size());
+  print_bench_result("plan, per format", plan_ns / num_formats);
+  print_bench_result("forge in one batch, per format", forge_ns / num_formats);
+  print_bench_result("search email lengths, per format",
+                     search_ns / num_formats);
+  std::cout << "oracle calls per format: "
+            << double(num_oracle_calls) / num_formats << std::endl;
+}
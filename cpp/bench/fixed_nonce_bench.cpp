@@ -0,0 +1,105 @@
+#include "bench.hpp"
+
+#include <cipher.hpp>
+#include <fixed_nonce.hpp>
+#include <mode.hpp>
+#include <rand.hpp>
+#include <raw_bytes.hpp>
+
+#include <array>
+#include <cctype>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+constexpr size_t FIXED_NONCE_BENCH_ROWS = 20000;
+constexpr size_t FIXED_NONCE_BENCH_ITERATIONS = 3;
+constexpr size_t FIXED_NONCE_BENCH_SEED = 20;
+
+static constexpr std::array<std::string_view, 24> FIXED_NONCE_BENCH_WORDS = {
+    "the",  "of",   "and",   "to",   "in",    "is",    "you",   "that",
+    "it",   "was",  "for",   "on",   "are",   "with",  "they",  "be",
+    "have", "from", "which", "said", "there", "their", "would", "people"};
+
+// Sentences of 4 to 16 words, the first capitalised, under one CTR nonce
+static std::vector<RawBytes> gen_fixed_nonce_ciphertexts(
+    std::vector<RawBytes> &plaintexts) {
+  c_RandomByteGenerator generator(FIXED_NONCE_BENCH_SEED);
+  for (size_t row = 0; row < FIXED_NONCE_BENCH_ROWS; ++row) {
+    std::string sentence;
+    const size_t num_words = generator.generate_in_range(4, 16);
+    for (size_t word_index = 0; word_index < num_words; ++word_index) {
+      if (word_index > 0) {
+        sentence += ' ';
+      }
+      sentence += FIXED_NONCE_BENCH_WORDS[generator.generate_in_range(
+          0, FIXED_NONCE_BENCH_WORDS.size() - 1)];
+    }
+    sentence.front() = char(std::toupper(sentence.front()));
+    sentence += '.';
+    plaintexts.push_back(from_ascii_string(sentence));
+  }
+
+  const auto cipher =
+      make_block_cipher(generator.generate_n_random_bytes(BLOCK_SIZE_BYTES));
+  const ByteBlock nonce{};
+  std::vector<RawBytes> output;
+  for (const auto &plaintext : plaintexts) {
+    output.push_back(CTR_crypt(*cipher, nonce, plaintext));
+  }
+  return output;
+}
+
+void bench_fixed_nonce() {
+  std::cout << "---- Fixed nonce CTR (" << FIXED_NONCE_BENCH_ROWS
+            << " ciphertexts) ----" << std::endl;
+
+  std::vector<RawBytes> plaintexts;
+  const std::vector<RawBytes> ciphertexts =
+      gen_fixed_nonce_ciphertexts(plaintexts);
+  const c_KeystreamMatrix matrix(ciphertexts);
+
+  c_FixedNonceConfig config;
+  config.m_num_threads = 1;
+  const RawBytes keystream =
+      recover_fixed_nonce_keystream(matrix, english_language_model(), config);
+  const std::vector<RawBytes> decrypted =
+      decrypt_fixed_nonce(ciphertexts, keystream);
+  size_t num_bytes = 0;
+  size_t num_recovered_bytes = 0;
+  for (size_t row = 0; row < plaintexts.size(); ++row) {
+    for (size_t index = 0; index < plaintexts[row].size(); ++index) {
+      num_recovered_bytes +=
+          (decrypted[row][index] == plaintexts[row][index]) ? 1 : 0;
+    }
+    num_bytes += plaintexts[row].size();
+  }
+  std::cout << "plaintext bytes recovered: " << num_recovered_bytes << " of "
+            << num_bytes << std::endl;
+
+  const double matrix_ns = time_ns_per_op(FIXED_NONCE_BENCH_ITERATIONS, [&] {
+    do_not_optimize(c_KeystreamMatrix(ciphertexts));
+  });
+  print_bench_result("keystream matrix", matrix_ns);
+
+  const double serial_ns = time_ns_per_op(FIXED_NONCE_BENCH_ITERATIONS, [&] {
+    do_not_optimize(recover_fixed_nonce_keystream(
+        matrix, english_language_model(), config));
+  });
+  config.m_num_threads = 0;
+  const double parallel_ns = time_ns_per_op(FIXED_NONCE_BENCH_ITERATIONS, [&] {
+    do_not_optimize(recover_fixed_nonce_keystream(
+        matrix, english_language_model(), config));
+  });
+  print_bench_result("keystream, 1 thread", serial_ns);
+  print_bench_result("keystream, every core", parallel_ns, serial_ns);
+
+  const RawBytes crib = from_ascii_string(" people would ");
+  const double crib_ns = time_ns_per_op(FIXED_NONCE_BENCH_ITERATIONS, [&] {
+    do_not_optimize(drag_crib(matrix, crib, 10, english_language_model(),
+                              config));
+  });
+  print_bench_result("drag_crib, 14 bytes", crib_ns);
+}
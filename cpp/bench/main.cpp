@@ -0,0 +1,33 @@
+#include "bench.hpp"
+
+#include <iostream>
+
+void bench_aes();
+void bench_cipher_backends();
+void bench_cbc_streams();
+void bench_xts();
+void bench_cmac();
+void bench_byte_at_a_time();
+void bench_xor();
+void bench_analysis();
+void bench_fixed_nonce();
+void bench_cookie();
+void bench_cut_and_paste();
+
+int main() {
+  std::cout << "Cryptopals benchmarks" << std::endl;
+
+  bench_aes();
+  bench_cipher_backends();
+  bench_cbc_streams();
+  bench_xts();
+  bench_cmac();
+  bench_byte_at_a_time();
+  bench_xor();
+  bench_analysis();
+  bench_fixed_nonce();
+  bench_cookie();
+  bench_cut_and_paste();
+
+  return 0;
+}
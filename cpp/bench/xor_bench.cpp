@@ -0,0 +1,77 @@
+#include "bench.hpp"
+
+#include <raw_bytes.hpp>
+
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+constexpr size_t XOR_BENCH_BUFFER_BYTES = 32 * 1024 * 1024;
+constexpr size_t XOR_BENCH_ITERATIONS = 4;
+constexpr size_t XOR_BENCH_UNIT_BYTES = 1024;
+
+// The byte at a time loop repeating key XOR used to be
+static void xor_repeating_per_byte(RawBytes &output, const RawBytes &key) {
+  size_t key_pointer = 0;
+  for (auto &character : output) {
+    character ^= key[key_pointer];
+    ++key_pointer;
+    if (key_pointer == key.size()) {
+      key_pointer = 0;
+    }
+  }
+}
+
+void bench_xor() {
+  std::cout << "---- XOR (" << XOR_BENCH_BUFFER_BYTES / (1024 * 1024)
+            << " MiB buffer) ----" << std::endl;
+
+  RawBytes buffer_raw(XOR_BENCH_BUFFER_BYTES, 'A');
+  const RawBytes other_raw(XOR_BENCH_BUFFER_BYTES, 'B');
+  const double num_units =
+      double(XOR_BENCH_BUFFER_BYTES) / XOR_BENCH_UNIT_BYTES;
+
+  const double copy_ns = time_ns_per_op(XOR_BENCH_ITERATIONS, [&] {
+                           std::memcpy(buffer_raw.data(), other_raw.data(),
+                                       buffer_raw.size());
+                           do_not_optimize(buffer_raw);
+                         }) /
+                         num_units;
+  print_bench_result("memcpy, for reference (KiB)", copy_ns);
+
+  const double buffer_ns = time_ns_per_op(XOR_BENCH_ITERATIONS, [&] {
+                             buffer_raw ^= other_raw;
+                             do_not_optimize(buffer_raw);
+                           }) /
+                           num_units;
+  print_bench_result("buffer ^= buffer (KiB)", buffer_ns, copy_ns);
+
+  for (const std::string &key :
+       {std::string("X"), std::string("ICE"), std::string("YELLOW SUBMARINE"),
+        std::string("Terminator X: Bring the noise"), std::string(1000, 'K')}) {
+    const RawBytes key_raw = from_ascii_string(key);
+    RawBytes expected_raw(buffer_raw);
+    xor_repeating_per_byte(expected_raw, key_raw);
+    RawBytes actual_raw(buffer_raw);
+    xor_repeating_in_place(actual_raw, key_raw);
+    if (actual_raw != expected_raw) {
+      throw std::logic_error("Repeating key XOR implementations disagree!");
+    }
+
+    const std::string key_length = std::to_string(key_raw.size());
+    const double per_byte_ns = time_ns_per_op(XOR_BENCH_ITERATIONS, [&] {
+                                 xor_repeating_per_byte(buffer_raw, key_raw);
+                                 do_not_optimize(buffer_raw);
+                               }) /
+                               num_units;
+    print_bench_result(key_length + " byte key, per byte (KiB)", per_byte_ns);
+    const double pattern_ns = time_ns_per_op(XOR_BENCH_ITERATIONS, [&] {
+                                xor_repeating_in_place(buffer_raw, key_raw);
+                                do_not_optimize(buffer_raw);
+                              }) /
+                              num_units;
+    print_bench_result(key_length + " byte key, vectorized (KiB)", pattern_ns,
+                       per_byte_ns);
+  }
+}
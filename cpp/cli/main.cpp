@@ -0,0 +1,191 @@
+#include "pipeline.hpp"
+
+#include <block.hpp>
+#include <cipher.hpp>
+#include <raw_bytes.hpp>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+constexpr std::string_view USAGE =
+    "usage: crypt-cli [-e | -d] -aes-{128,192,256}-{ecb,cbc,ctr} -K hex_key\n"
+    "                 [-iv hex_iv] [-in file] [-out file] [-a | -hex]\n"
+    "                 [-nopad] [-backend name] [-threads n] [-chunk bytes]\n"
+    "                 [-q]\n"
+    "\n"
+    "Reads stdin and writes stdout unless -in and -out name files. -a\n"
+    "frames the ciphertext as base64 and -hex as hex. Throughput goes to\n"
+    "stderr unless -q is given.\n";
+
+struct c_CliOptions {
+  c_PipelineConfig m_pipeline;
+  std::string m_cipher_name;
+  size_t m_key_length_bytes = 0;
+  RawBytes m_key;
+  std::optional<RawBytes> m_iv;
+  std::string m_input_path = "-";
+  std::string m_output_path = "-";
+  std::string m_backend_name;
+  bool m_is_quiet = false;
+};
+
+// Names as openssl enc spells them, such as -aes-128-cbc
+static void parse_cipher_name(const std::string_view name,
+                              c_CliOptions &options) {
+  constexpr std::string_view PREFIX = "-aes-";
+  const size_t mode_separator = name.rfind('-');
+  if (!name.starts_with(PREFIX) || mode_separator < PREFIX.size()) {
+    throw std::invalid_argument("Unknown option " + std::string(name));
+  }
+  const std::string_view key_bits =
+      name.substr(PREFIX.size(), mode_separator - PREFIX.size());
+  const std::string_view mode = name.substr(mode_separator + 1);
+
+  if (key_bits == "128" || key_bits == "192" || key_bits == "256") {
+    options.m_key_length_bytes = std::stoul(std::string(key_bits)) / 8;
+  } else {
+    throw std::invalid_argument("Unknown key size " + std::string(key_bits));
+  }
+  if (mode == "ecb") {
+    options.m_pipeline.m_mode = CipherMode::ecb;
+  } else if (mode == "cbc") {
+    options.m_pipeline.m_mode = CipherMode::cbc;
+  } else if (mode == "ctr") {
+    options.m_pipeline.m_mode = CipherMode::ctr;
+  } else {
+    throw std::invalid_argument("Unknown mode " + std::string(mode));
+  }
+  options.m_cipher_name = std::string(name.substr(1));
+}
+
+static c_CliOptions parse_options(const int argc, char **argv) {
+  c_CliOptions options;
+  for (int arg_index = 1; arg_index < argc; ++arg_index) {
+    const std::string_view arg = argv[arg_index];
+    const auto next_value = [&]() -> std::string {
+      if (arg_index + 1 >= argc) {
+        throw std::invalid_argument(std::string(arg) + " needs a value");
+      }
+      return argv[++arg_index];
+    };
+
+    if (arg == "-e") {
+      options.m_pipeline.m_is_encrypt = true;
+    } else if (arg == "-d") {
+      options.m_pipeline.m_is_encrypt = false;
+    } else if (arg == "-K") {
+      options.m_key = from_hex_string(next_value());
+    } else if (arg == "-iv") {
+      options.m_iv = from_hex_string(next_value());
+    } else if (arg == "-in") {
+      options.m_input_path = next_value();
+    } else if (arg == "-out") {
+      options.m_output_path = next_value();
+    } else if (arg == "-a" || arg == "-base64") {
+      options.m_pipeline.m_framing = Framing::base64;
+    } else if (arg == "-hex") {
+      options.m_pipeline.m_framing = Framing::hex;
+    } else if (arg == "-nopad") {
+      options.m_pipeline.m_use_padding = false;
+    } else if (arg == "-backend") {
+      options.m_backend_name = next_value();
+    } else if (arg == "-threads") {
+      options.m_pipeline.m_num_workers = std::stoul(next_value());
+    } else if (arg == "-chunk") {
+      options.m_pipeline.m_chunk_bytes = std::stoul(next_value());
+    } else if (arg == "-q") {
+      options.m_is_quiet = true;
+    } else {
+      parse_cipher_name(arg, options);
+    }
+  }
+
+  if (options.m_cipher_name.empty()) {
+    throw std::invalid_argument("No cipher given");
+  }
+  if (options.m_key.size() != options.m_key_length_bytes) {
+    throw std::invalid_argument(options.m_cipher_name + " needs a " +
+                                std::to_string(options.m_key_length_bytes) +
+                                " byte key");
+  }
+  const bool needs_iv = options.m_pipeline.m_mode != CipherMode::ecb;
+  if (needs_iv && (!options.m_iv || options.m_iv->size() != BLOCK_SIZE_BYTES)) {
+    throw std::invalid_argument(options.m_cipher_name + " needs a " +
+                                std::to_string(BLOCK_SIZE_BYTES) +
+                                " byte IV");
+  }
+  return options;
+}
+
+struct c_FileCloser {
+  void operator()(std::FILE *file) const {
+    if (file != stdin && file != stdout) {
+      std::fclose(file);
+    }
+  }
+};
+
+using FileHandle = std::unique_ptr<std::FILE, c_FileCloser>;
+
+static FileHandle open_file(const std::string &path, const bool is_input) {
+  if (path == "-") {
+    return FileHandle(is_input ? stdin : stdout);
+  }
+  std::FILE *file = std::fopen(path.c_str(), is_input ? "rb" : "wb");
+  if (file == nullptr) {
+    throw std::runtime_error("Could not open " + path + ": " +
+                             std::strerror(errno));
+  }
+  return FileHandle(file);
+}
+
+int main(int argc, char **argv) {
+  c_CliOptions options;
+  try {
+    options = parse_options(argc, argv);
+  } catch (const std::exception &error) {
+    std::cerr << "crypt-cli: " << error.what() << std::endl << USAGE;
+    return 1;
+  }
+
+  try {
+    const std::unique_ptr<c_BlockCipher> cipher =
+        options.m_backend_name.empty()
+            ? make_block_cipher(options.m_key)
+            : make_block_cipher(options.m_backend_name, options.m_key);
+    const ByteBlock iv = options.m_iv
+                             ? from_raw_bytes_to_byte_block(*options.m_iv)
+                             : ByteBlock{};
+
+    const FileHandle input = open_file(options.m_input_path, true);
+    const FileHandle output = open_file(options.m_output_path, false);
+    const c_PipelineStats stats = run_pipeline(
+        *cipher, iv, options.m_pipeline, input.get(), output.get());
+
+    if (!options.m_is_quiet) {
+      const double megabytes_per_s =
+          (stats.m_elapsed_s > 0.0)
+              ? double(stats.m_bytes_in) / 1e6 / stats.m_elapsed_s
+              : 0.0;
+      std::cerr << options.m_cipher_name << " "
+                << (options.m_pipeline.m_is_encrypt ? "encrypt" : "decrypt")
+                << ": " << stats.m_bytes_in << " bytes in " << std::fixed
+                << std::setprecision(3) << stats.m_elapsed_s << "s, "
+                << std::setprecision(1) << megabytes_per_s << " MB/s"
+                << std::endl;
+    }
+  } catch (const std::exception &error) {
+    std::cerr << "crypt-cli: " << error.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
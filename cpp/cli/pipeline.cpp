@@ -0,0 +1,405 @@
+#include "pipeline.hpp"
+
+#include <block.hpp>
+#include <cipher.hpp>
+#include <mode.hpp>
+#include <padding.hpp>
+#include <raw_bytes.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Framed input is read this many characters at a time
+constexpr inline size_t FRAMED_READ_BYTES = 64 * 1024;
+
+c_ByteSource::c_ByteSource(std::FILE *file, const Framing framing)
+    : m_file(file)
+    , m_framing(framing) {}
+
+size_t c_ByteSource::read(std::span<uint8_t> output) {
+  size_t num_read = 0;
+  while (num_read < output.size()) {
+    if (m_framing == Framing::none) {
+      const size_t result = std::fread(output.data() + num_read, 1,
+                                       output.size() - num_read, m_file);
+      if (result == 0) {
+        if (std::ferror(m_file)) {
+          throw std::runtime_error("Could not read the input!");
+        }
+        break;
+      }
+      num_read += result;
+      continue;
+    }
+
+    if (m_decoded_offset == m_decoded.size()) {
+      if (m_is_eof) {
+        break;
+      }
+      decode_more();
+      continue;
+    }
+    const size_t num_bytes = std::min(output.size() - num_read,
+                                      m_decoded.size() - m_decoded_offset);
+    std::memcpy(output.data() + num_read, m_decoded.data() + m_decoded_offset,
+                num_bytes);
+    num_read += num_bytes;
+    m_decoded_offset += num_bytes;
+  }
+  return num_read;
+}
+
+// Decodes every whole group of characters read so far
+void c_ByteSource::decode_more() {
+  std::array<char, FRAMED_READ_BYTES> buffer;
+  const size_t num_read = std::fread(buffer.data(), 1, buffer.size(), m_file);
+  if (num_read < buffer.size()) {
+    if (std::ferror(m_file)) {
+      throw std::runtime_error("Could not read the input!");
+    }
+    m_is_eof = true;
+  }
+  for (size_t index = 0; index < num_read; ++index) {
+    if (!std::isspace(static_cast<unsigned char>(buffer[index]))) {
+      m_text.push_back(buffer[index]);
+    }
+  }
+
+  const size_t group_length = (m_framing == Framing::base64) ? 4 : 2;
+  const size_t num_chars =
+      m_is_eof ? m_text.size() : m_text.size() - (m_text.size() % group_length);
+  if (num_chars % group_length != 0) {
+    throw std::runtime_error("Framed input is truncated!");
+  }
+  const std::string text = m_text.substr(0, num_chars);
+  try {
+    m_decoded = (m_framing == Framing::base64) ? from_base64_string(text)
+                                               : from_hex_string(text);
+  } catch (const std::invalid_argument &) {
+    throw std::runtime_error("Framed input does not decode!");
+  }
+  m_decoded_offset = 0;
+  m_text.erase(0, num_chars);
+}
+
+c_ByteSink::c_ByteSink(std::FILE *file, const Framing framing)
+    : m_file(file)
+    , m_framing(framing) {}
+
+void c_ByteSink::write(const ByteSpan input) {
+  if (m_framing == Framing::none) {
+    write_raw(reinterpret_cast<const char *>(input.data()), input.size());
+    return;
+  }
+
+  std::ostringstream text;
+  const RawBytes input_raw(input.begin(), input.end());
+  if (m_framing == Framing::base64) {
+    to_base64_string(text, input_raw);
+  } else {
+    to_hex_string(text, input_raw);
+  }
+  const std::string encoded = text.str();
+  for (size_t offset = 0; offset < encoded.size();) {
+    const size_t length =
+        std::min(FRAMING_LINE_LENGTH - m_column, encoded.size() - offset);
+    write_raw(encoded.data() + offset, length);
+    offset += length;
+    m_column += length;
+    if (m_column == FRAMING_LINE_LENGTH) {
+      write_raw("\n", 1);
+      m_column = 0;
+    }
+  }
+}
+
+void c_ByteSink::finish() {
+  if (m_column > 0) {
+    write_raw("\n", 1);
+    m_column = 0;
+  }
+  if (std::fflush(m_file) != 0) {
+    throw std::runtime_error("Could not write the output!");
+  }
+}
+
+void c_ByteSink::write_raw(const char *input, const size_t length) {
+  if (std::fwrite(input, 1, length, m_file) != length) {
+    throw std::runtime_error("Could not write the output!");
+  }
+}
+
+struct c_Chunk {
+  size_t m_index = 0;
+  bool m_is_last = false;
+  // Both leave room for a block of padding
+  RawBytes m_input;
+  size_t m_input_length = 0;
+  RawBytes m_output;
+  size_t m_output_length = 0;
+  // For CBC decryption, the ciphertext block before this chunk
+  ByteBlock m_previous_block{};
+};
+
+// The CTR counter block num_blocks on from counter, as a 128 bit big-endian
+// integer
+static ByteBlock advance_counter(const ByteBlock &counter,
+                                 uint64_t num_blocks) {
+  ByteBlock output = counter;
+  uint8_t *bytes = reinterpret_cast<uint8_t *>(&output);
+  unsigned carry = 0;
+  for (size_t byte_index = BLOCK_SIZE_BYTES; byte_index-- > 0;) {
+    const unsigned sum =
+        bytes[byte_index] + unsigned(num_blocks & 0xFF) + carry;
+    bytes[byte_index] = uint8_t(sum);
+    carry = sum >> 8;
+    num_blocks >>= 8;
+  }
+  return output;
+}
+
+static void check_whole_blocks(const size_t length) {
+  if (length % BLOCK_SIZE_BYTES != 0) {
+    throw std::runtime_error("Input is not a whole number of blocks!");
+  }
+}
+
+static void encrypt_chunk(const c_BlockCipher &cipher,
+                          const c_PipelineConfig &config,
+                          ByteBlock &cbc_chain, c_Chunk &chunk) {
+  size_t length = chunk.m_input_length;
+  if (chunk.m_is_last && config.m_use_padding) {
+    length = pad_pkcs7_in_place(chunk.m_input, length);
+  }
+  check_whole_blocks(length);
+  const size_t num_blocks = length / BLOCK_SIZE_BYTES;
+
+  if (config.m_mode == CipherMode::ecb) {
+    cipher.encrypt_blocks(chunk.m_input.data(), chunk.m_output.data(),
+                          num_blocks);
+  } else {
+    CBC_encrypt_blocks(cipher, cbc_chain,
+                       ByteSpan{chunk.m_input}.first(length), chunk.m_output);
+  }
+  chunk.m_output_length = length;
+}
+
+static void decrypt_chunk(const c_BlockCipher &cipher,
+                          const c_PipelineConfig &config, c_Chunk &chunk) {
+  const size_t length = chunk.m_input_length;
+  check_whole_blocks(length);
+  const size_t num_blocks = length / BLOCK_SIZE_BYTES;
+
+  const ByteSpan input = ByteSpan{chunk.m_input}.first(length);
+  if (config.m_mode == CipherMode::cbc) {
+    ByteBlock chain = chunk.m_previous_block;
+    CBC_decrypt_blocks(cipher, chain, input, chunk.m_output);
+  } else {
+    cipher.decrypt_blocks(input.data(), chunk.m_output.data(), num_blocks);
+  }
+
+  chunk.m_output_length = length;
+  if (chunk.m_is_last && config.m_use_padding &&
+      !validate_pkcs7_padding(ByteSpan{chunk.m_output}.first(length),
+                              BLOCK_SIZE_BYTES, chunk.m_output_length)) {
+    throw std::runtime_error("Bad decrypt, the padding does not validate!");
+  }
+}
+
+static void process_chunk(const c_BlockCipher &cipher, const ByteBlock &iv,
+                          const c_PipelineConfig &config,
+                          const size_t chunk_bytes, ByteBlock &cbc_chain,
+                          c_Chunk &chunk) {
+  if (config.m_mode == CipherMode::ctr) {
+    const ByteBlock counter =
+        advance_counter(iv, chunk.m_index * (chunk_bytes / BLOCK_SIZE_BYTES));
+    CTR_crypt(cipher, counter,
+              ByteSpan{chunk.m_input}.first(chunk.m_input_length),
+              chunk.m_output);
+    chunk.m_output_length = chunk.m_input_length;
+  } else if (config.m_is_encrypt) {
+    encrypt_chunk(cipher, config, cbc_chain, chunk);
+  } else {
+    decrypt_chunk(cipher, config, chunk);
+  }
+}
+
+c_PipelineStats run_pipeline(const c_BlockCipher &cipher, const ByteBlock &iv,
+                             const c_PipelineConfig &config, std::FILE *input,
+                             std::FILE *output) {
+  const size_t chunk_bytes =
+      std::max<size_t>((config.m_chunk_bytes + CHUNK_ALIGNMENT_BYTES - 1) /
+                           CHUNK_ALIGNMENT_BYTES,
+                       1) *
+      CHUNK_ALIGNMENT_BYTES;
+  const bool is_serial =
+      config.m_mode == CipherMode::cbc && config.m_is_encrypt;
+  const size_t requested_workers = (config.m_num_workers == 0)
+                                       ? std::thread::hardware_concurrency()
+                                       : config.m_num_workers;
+  const size_t num_workers =
+      is_serial ? 1 : std::max<size_t>(requested_workers, 1);
+
+  // Enough for every stage to hold one chunk while the next is queued
+  const size_t num_chunks = 2 * num_workers + 2;
+  c_ChannelQueue<std::unique_ptr<c_Chunk>> free_chunks;
+  c_ChannelQueue<std::unique_ptr<c_Chunk>> work;
+  c_ChannelQueue<std::unique_ptr<c_Chunk>> done;
+  for (size_t chunk_index = 0; chunk_index < num_chunks; ++chunk_index) {
+    auto chunk = std::make_unique<c_Chunk>();
+    chunk->m_input.resize(chunk_bytes + BLOCK_SIZE_BYTES);
+    chunk->m_output.resize(chunk_bytes + BLOCK_SIZE_BYTES);
+    free_chunks.push(std::move(chunk));
+  }
+
+  std::mutex error_mutex;
+  std::exception_ptr error;
+  std::atomic<bool> has_failed{false};
+  const auto fail = [&](std::exception_ptr exception) {
+    {
+      std::lock_guard lock(error_mutex);
+      if (!error) {
+        error = exception;
+      }
+    }
+    has_failed = true;
+    free_chunks.close();
+    work.close();
+    done.close();
+  };
+
+  c_ByteSource source(input,
+                      config.m_is_encrypt ? Framing::none : config.m_framing);
+  c_ByteSink sink(output,
+                  config.m_is_encrypt ? config.m_framing : Framing::none);
+  c_PipelineStats stats;
+  const auto begin = std::chrono::steady_clock::now();
+
+  // Reads one chunk ahead, so that the last chunk is known to be the last
+  std::thread reader([&] {
+    try {
+      const auto take_chunk = [&]() -> std::unique_ptr<c_Chunk> {
+        std::optional<std::unique_ptr<c_Chunk>> chunk = free_chunks.pop();
+        return chunk ? std::move(*chunk) : nullptr;
+      };
+      const auto fill_chunk = [&](c_Chunk &chunk) {
+        chunk.m_input_length =
+            source.read(std::span{chunk.m_input}.first(chunk_bytes));
+        stats.m_bytes_in += chunk.m_input_length;
+      };
+
+      ByteBlock previous_block = iv;
+      std::unique_ptr<c_Chunk> current = take_chunk();
+      if (!current) {
+        return;
+      }
+      fill_chunk(*current);
+      for (size_t chunk_index = 0;; ++chunk_index) {
+        std::unique_ptr<c_Chunk> next;
+        if (current->m_input_length == chunk_bytes) {
+          next = take_chunk();
+          if (!next) {
+            return;
+          }
+          fill_chunk(*next);
+          if (next->m_input_length == 0) {
+            free_chunks.push(std::move(next));
+            next = nullptr;
+          }
+        }
+
+        current->m_index = chunk_index;
+        current->m_is_last = (next == nullptr);
+        current->m_previous_block = previous_block;
+        if (current->m_input_length >= BLOCK_SIZE_BYTES) {
+          std::memcpy(&previous_block,
+                      current->m_input.data() + current->m_input_length -
+                          BLOCK_SIZE_BYTES,
+                      BLOCK_SIZE_BYTES);
+        }
+        work.push(std::move(current));
+        if (!next) {
+          break;
+        }
+        current = std::move(next);
+      }
+    } catch (...) {
+      fail(std::current_exception());
+    }
+    work.close();
+  });
+
+  // Only touched by the single CBC encryption worker
+  ByteBlock cbc_chain = iv;
+  std::vector<std::thread> workers;
+  for (size_t worker_index = 0; worker_index < num_workers; ++worker_index) {
+    workers.emplace_back([&] {
+      try {
+        while (std::optional<std::unique_ptr<c_Chunk>> chunk = work.pop()) {
+          process_chunk(cipher, iv, config, chunk_bytes, cbc_chain, **chunk);
+          done.push(std::move(*chunk));
+        }
+      } catch (...) {
+        fail(std::current_exception());
+      }
+    });
+  }
+
+  // Chunks finish out of order; they are written in order
+  std::thread writer([&] {
+    try {
+      std::map<size_t, std::unique_ptr<c_Chunk>> pending;
+      size_t next_index = 0;
+      while (std::optional<std::unique_ptr<c_Chunk>> chunk = done.pop()) {
+        const size_t chunk_index = (*chunk)->m_index;
+        pending.emplace(chunk_index, std::move(*chunk));
+        while (!pending.empty() && pending.begin()->first == next_index) {
+          std::unique_ptr<c_Chunk> ready = std::move(pending.begin()->second);
+          pending.erase(pending.begin());
+          if (has_failed) {
+            return;
+          }
+          sink.write(ByteSpan{ready->m_output}.first(ready->m_output_length));
+          stats.m_bytes_out += ready->m_output_length;
+          free_chunks.push(std::move(ready));
+          ++next_index;
+        }
+      }
+      if (!has_failed) {
+        sink.finish();
+      }
+    } catch (...) {
+      fail(std::current_exception());
+    }
+  });
+
+  reader.join();
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  done.close();
+  writer.join();
+
+  if (error) {
+    std::rethrow_exception(error);
+  }
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - begin;
+  stats.m_elapsed_s = elapsed.count();
+  return stats;
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <block.hpp>
+#include <cipher.hpp>
+#include <raw_bytes.hpp>
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+
+// Chunks are whole blocks, and whole base64 lines of 48 bytes, so that only
+// the final chunk can end part way through either.
+constexpr inline size_t CHUNK_ALIGNMENT_BYTES = 48;
+constexpr inline size_t DEFAULT_CHUNK_BYTES =
+    (1024 * 1024 / CHUNK_ALIGNMENT_BYTES) * CHUNK_ALIGNMENT_BYTES;
+// Characters per line of framed output, as openssl enc -a writes
+constexpr inline size_t FRAMING_LINE_LENGTH = 64;
+
+enum class CipherMode { ecb, cbc, ctr };
+
+// Ciphertext is framed on the way out when encrypting and on the way in when
+// decrypting
+enum class Framing { none, hex, base64 };
+
+struct c_PipelineConfig {
+  CipherMode m_mode = CipherMode::cbc;
+  bool m_is_encrypt = true;
+  // PKCS#7 padding for ECB and CBC
+  bool m_use_padding = true;
+  Framing m_framing = Framing::none;
+  size_t m_chunk_bytes = DEFAULT_CHUNK_BYTES;
+  // 0 means one per core. CBC encryption is serial and uses one.
+  size_t m_num_workers = 0;
+};
+
+struct c_PipelineStats {
+  // Bytes through the cipher, after any framing is removed
+  size_t m_bytes_in = 0;
+  size_t m_bytes_out = 0;
+  double m_elapsed_s = 0.0;
+};
+
+// A queue between pipeline stages. Once closed, pushes are dropped and pops
+// drain what is left, then return nothing.
+template <typename ValueType> struct c_ChannelQueue {
+  void push(ValueType value) {
+    {
+      std::lock_guard lock(m_mutex);
+      if (m_is_closed) {
+        return;
+      }
+      m_values.push_back(std::move(value));
+    }
+    m_ready.notify_one();
+  }
+
+  std::optional<ValueType> pop() {
+    std::unique_lock lock(m_mutex);
+    m_ready.wait(lock, [this] { return !m_values.empty() || m_is_closed; });
+    if (m_values.empty()) {
+      return std::nullopt;
+    }
+    ValueType value = std::move(m_values.front());
+    m_values.pop_front();
+    return value;
+  }
+
+  void close() {
+    {
+      std::lock_guard lock(m_mutex);
+      m_is_closed = true;
+    }
+    m_ready.notify_all();
+  }
+
+private:
+  std::mutex m_mutex;
+  std::condition_variable m_ready;
+  std::deque<ValueType> m_values;
+  bool m_is_closed = false;
+};
+
+// Reads whole chunks, removing any framing
+struct c_ByteSource {
+  c_ByteSource(std::FILE *file, Framing framing);
+
+  // Fills output unless the input runs out first; returns the bytes read
+  size_t read(std::span<uint8_t> output);
+
+private:
+  void decode_more();
+
+  std::FILE *m_file;
+  const Framing m_framing;
+  bool m_is_eof = false;
+  std::string m_text;
+  RawBytes m_decoded;
+  size_t m_decoded_offset = 0;
+};
+
+// Writes bytes, adding any framing
+struct c_ByteSink {
+  c_ByteSink(std::FILE *file, Framing framing);
+
+  void write(ByteSpan input);
+  // Ends the last framed line and flushes
+  void finish();
+
+private:
+  void write_raw(const char *input, size_t length);
+
+  std::FILE *m_file;
+  const Framing m_framing;
+  size_t m_column = 0;
+};
+
+// Streams input through the cipher to output on a reader thread, a pool of
+// workers and a writer thread, with chunk buffers recycled between them so
+// that reads, cipher work and writes overlap. iv is the CBC IV or the
+// initial CTR counter block, and is ignored by ECB.
+c_PipelineStats run_pipeline(const c_BlockCipher &cipher, const ByteBlock &iv,
+                             const c_PipelineConfig &config, std::FILE *input,
+                             std::FILE *output);
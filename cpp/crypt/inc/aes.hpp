@@ -1,17 +1,24 @@
 #pragma once
 
 #include <block.hpp>
+#include <packed_block.hpp>
+#include <padding.hpp>
 #include <rand.hpp>
 #include <raw_bytes.hpp>
 
+#include <algorithm>
 #include <array>
 #include <cstdint>
 #include <iostream>
+#include <span>
+#include <stdexcept>
 
 constexpr inline size_t AES_128_KEY_LENGTH_WORDS = 4;
 constexpr inline size_t AES_192_KEY_LENGTH_WORDS = 6;
 constexpr inline size_t AES_256_KEY_LENGTH_WORDS = 8;
 
+constexpr inline size_t AES_MULTI_BLOCK_LANES = 4;
+
 constexpr inline size_t AES_128_NUM_ROUNDS = 10;
 constexpr inline size_t AES_192_NUM_ROUNDS = 12;
 constexpr inline size_t AES_256_NUM_ROUNDS = 14;
@@ -46,7 +53,7 @@ template <typename KeyType> KeyType gen_key(const RawBytes &flat_key) {
   KeyType key;
   for (size_t word_index = 0; word_index < KEY_SIZE_WORDS; ++word_index) {
     for (size_t byte_index = 0; byte_index < WORD_SIZE_BYTES; ++byte_index) {
-      size_t flat_index = (word_index * KEY_SIZE_WORDS) + byte_index;
+      size_t flat_index = (word_index * WORD_SIZE_BYTES) + byte_index;
       key[word_index][byte_index] = flat_key[flat_index];
     }
   }
@@ -61,12 +68,6 @@ AES128KeySchedule gen_key_schedule(const AES128Key &key);
 AES192KeySchedule gen_key_schedule(const AES192Key &key);
 AES256KeySchedule gen_key_schedule(const AES256Key &key);
 
-RawBytes add_pkcs7_padding(const RawBytes &input,
-                           const size_t block_size_bytes = BLOCK_SIZE_BYTES);
-
-RawBytes remove_pkcs7_padding(const RawBytes &input,
-                              const size_t block_size_bytes = BLOCK_SIZE_BYTES);
-
 template <typename KeyScheduleType>
 ByteBlock get_round_key(const KeyScheduleType &key_schedule,
                         const size_t round_index) {
@@ -79,22 +80,35 @@ ByteBlock get_round_key(const KeyScheduleType &key_schedule,
   return round_key;
 }
 
+// The schedule is contiguous, so a round key is a single load
+template <typename KeyScheduleType>
+c_PackedBlock load_round_key(const KeyScheduleType &key_schedule,
+                             const size_t round_index) {
+  static_assert(sizeof(KeyScheduleType) ==
+                std::tuple_size<KeyScheduleType>{} * WORD_SIZE_BYTES);
+  return load_block(reinterpret_cast<const uint8_t *>(
+      &key_schedule[round_index * BLOCK_SIZE_WORDS]));
+}
+
 template <typename KeyScheduleType>
 void add_round_key(ByteBlock &input, const KeyScheduleType &key_schedule,
                    const size_t round_index) {
-  const ByteBlock round_key = get_round_key(key_schedule, round_index);
-  input = (input ^ round_key);
+  input = to_byte_block(load_block(input) ^
+                        load_round_key(key_schedule, round_index));
 }
 
 template <typename KeyScheduleType>
-void AES_cipher(const ByteBlock &input, ByteBlock &output,
-                const KeyScheduleType &key_schedule) {
+void add_round_key(c_PackedBlock &input, const KeyScheduleType &key_schedule,
+                   const size_t round_index) {
+  input ^= load_round_key(key_schedule, round_index);
+}
+
+template <typename KeyScheduleType>
+void AES_cipher(c_PackedBlock &state, const KeyScheduleType &key_schedule) {
   constexpr size_t KEY_SCHEDULE_SIZE_WORDS = std::tuple_size<KeyScheduleType>{};
   constexpr size_t NUM_ROUNDS =
       (KEY_SCHEDULE_SIZE_WORDS / BLOCK_SIZE_WORDS) - 1;
 
-  ByteBlock state(input);
-
   add_round_key(state, key_schedule, 0);
 
   for (size_t round_index = 1; round_index < NUM_ROUNDS; ++round_index) {
@@ -106,8 +120,63 @@ void AES_cipher(const ByteBlock &input, ByteBlock &output,
   sub_bytes(state);
   shift_rows(state);
   add_round_key(state, key_schedule, NUM_ROUNDS);
+}
+
+template <typename KeyScheduleType>
+void AES_cipher(const ByteBlock &input, ByteBlock &output,
+                const KeyScheduleType &key_schedule) {
+  c_PackedBlock state = load_block(input);
+  AES_cipher(state, key_schedule);
+  output = to_byte_block(state);
+}
+
+// Encrypts num_blocks contiguous blocks, running independent blocks through
+// the rounds in lockstep so that the work for up to AES_MULTI_BLOCK_LANES
+// blocks is interleaved within each round. input and output may be the same
+// buffer.
+template <typename KeyScheduleType>
+void AES_cipher_bytes(const uint8_t *input, uint8_t *output,
+                      const size_t num_blocks,
+                      const KeyScheduleType &key_schedule) {
+  constexpr size_t KEY_SCHEDULE_SIZE_WORDS = std::tuple_size<KeyScheduleType>{};
+  constexpr size_t NUM_ROUNDS =
+      (KEY_SCHEDULE_SIZE_WORDS / BLOCK_SIZE_WORDS) - 1;
+
+  for (size_t block_index = 0; block_index < num_blocks;
+       block_index += AES_MULTI_BLOCK_LANES) {
+    const size_t num_lanes =
+        std::min(AES_MULTI_BLOCK_LANES, num_blocks - block_index);
+    const size_t offset = block_index * BLOCK_SIZE_BYTES;
+    std::array<c_PackedBlock, AES_MULTI_BLOCK_LANES> states;
+
+    for (size_t lane = 0; lane < num_lanes; ++lane) {
+      states[lane] = load_block(input + offset + (lane * BLOCK_SIZE_BYTES));
+      add_round_key(states[lane], key_schedule, 0);
+    }
+    for (size_t round_index = 1; round_index < NUM_ROUNDS; ++round_index) {
+      for (size_t lane = 0; lane < num_lanes; ++lane) {
+        sub_bytes(states[lane]);
+        shift_rows(states[lane]);
+        mix_columns(states[lane]);
+        add_round_key(states[lane], key_schedule, round_index);
+      }
+    }
+    for (size_t lane = 0; lane < num_lanes; ++lane) {
+      sub_bytes(states[lane]);
+      shift_rows(states[lane]);
+      add_round_key(states[lane], key_schedule, NUM_ROUNDS);
+      store_block(states[lane], output + offset + (lane * BLOCK_SIZE_BYTES));
+    }
+  }
+}
 
-  output = state;
+template <typename KeyScheduleType>
+void AES_cipher_blocks(std::span<const ByteBlock> input,
+                       std::span<ByteBlock> output,
+                       const KeyScheduleType &key_schedule) {
+  AES_cipher_bytes<KeyScheduleType>(
+      reinterpret_cast<const uint8_t *>(input.data()),
+      reinterpret_cast<uint8_t *>(output.data()), input.size(), key_schedule);
 }
 
 void AES_128_cipher(const ByteBlock &input, ByteBlock &output,
@@ -120,20 +189,16 @@ void AES_256_cipher(const ByteBlock &input, ByteBlock &output,
 template <typename KeyScheduleType>
 RawBytes AES_ECB_encrypt(const RawBytes &plaintext_raw,
                          const KeyScheduleType &key_schedule) {
-  RawBytes plaintext_padded_raw =
-      add_pkcs7_padding(plaintext_raw, BLOCK_SIZE_BYTES);
-  RawBytes ciphertext_raw(plaintext_padded_raw.size());
-
-  const size_t num_blocks =
-      std::ceil<size_t>(double(plaintext_padded_raw.size()) / BLOCK_SIZE_BYTES);
-  for (size_t block_index = 0; block_index < num_blocks; ++block_index) {
-    ByteBlock plaintext =
-        from_raw_bytes_to_byte_block(plaintext_padded_raw, block_index);
-    ByteBlock ciphertext;
-    AES_cipher(plaintext, ciphertext, key_schedule);
-
-    from_byte_block_to_raw_bytes(ciphertext, ciphertext_raw, block_index);
-  }
+  // Pad in the output buffer and encrypt it in place
+  RawBytes ciphertext_raw(pkcs7_padded_length(plaintext_raw.size()));
+  std::copy(std::begin(plaintext_raw), std::end(plaintext_raw),
+            std::begin(ciphertext_raw));
+  pad_pkcs7_in_place(ciphertext_raw, plaintext_raw.size());
+
+  AES_cipher_bytes<KeyScheduleType>(ciphertext_raw.data(),
+                                    ciphertext_raw.data(),
+                                    ciphertext_raw.size() / BLOCK_SIZE_BYTES,
+                                    key_schedule);
   return ciphertext_raw;
 }
 
@@ -150,14 +215,11 @@ RawBytes AES_256_ECB_encrypt(const RawBytes &plaintext_raw,
                              const RawBytes &key_raw);
 
 template <typename KeyScheduleType>
-void AES_inv_cipher(const ByteBlock &input, ByteBlock &output,
-                    const KeyScheduleType &key_schedule) {
+void AES_inv_cipher(c_PackedBlock &state, const KeyScheduleType &key_schedule) {
   constexpr size_t KEY_SCHEDULE_SIZE_WORDS = std::tuple_size<KeyScheduleType>{};
   constexpr size_t NUM_ROUNDS =
       (KEY_SCHEDULE_SIZE_WORDS / BLOCK_SIZE_WORDS) - 1;
 
-  ByteBlock state(input);
-
   add_round_key(state, key_schedule, NUM_ROUNDS);
 
   for (size_t round_index = NUM_ROUNDS - 1; round_index > 0; --round_index) {
@@ -169,8 +231,130 @@ void AES_inv_cipher(const ByteBlock &input, ByteBlock &output,
   inv_shift_rows(state);
   inv_sub_bytes(state);
   add_round_key(state, key_schedule, 0);
+}
+
+template <typename KeyScheduleType>
+void AES_inv_cipher(const ByteBlock &input, ByteBlock &output,
+                    const KeyScheduleType &key_schedule) {
+  c_PackedBlock state = load_block(input);
+  AES_inv_cipher(state, key_schedule);
+  output = to_byte_block(state);
+}
+
+// Round keys for the equivalent inverse cipher (FIPS-197 5.3.5): the
+// encryption schedule with InvMixColumns applied to rounds 1 to Nr - 1.
+// Decryption can then run the rounds in the same order as encryption.
+template <typename KeyScheduleType> struct c_DecryptionKeySchedule {
+  KeyScheduleType m_round_keys;
+};
+
+template <typename KeyScheduleType>
+c_DecryptionKeySchedule<KeyScheduleType>
+gen_decryption_key_schedule(const KeyScheduleType &key_schedule) {
+  constexpr size_t KEY_SCHEDULE_SIZE_WORDS = std::tuple_size<KeyScheduleType>{};
+  constexpr size_t NUM_ROUNDS =
+      (KEY_SCHEDULE_SIZE_WORDS / BLOCK_SIZE_WORDS) - 1;
+
+  c_DecryptionKeySchedule<KeyScheduleType> decryption_key_schedule{
+      key_schedule};
+  for (size_t round_index = 1; round_index < NUM_ROUNDS; ++round_index) {
+    c_PackedBlock round_key = load_round_key(key_schedule, round_index);
+    inv_mix_columns(round_key);
+    store_block(round_key,
+                reinterpret_cast<uint8_t *>(
+                    &decryption_key_schedule
+                         .m_round_keys[round_index * BLOCK_SIZE_WORDS]));
+  }
+  return decryption_key_schedule;
+}
+
+template <typename KeyScheduleType>
+void AES_inv_cipher(
+    c_PackedBlock &state,
+    const c_DecryptionKeySchedule<KeyScheduleType> &decryption_key_schedule) {
+  constexpr size_t KEY_SCHEDULE_SIZE_WORDS = std::tuple_size<KeyScheduleType>{};
+  constexpr size_t NUM_ROUNDS =
+      (KEY_SCHEDULE_SIZE_WORDS / BLOCK_SIZE_WORDS) - 1;
+  const KeyScheduleType &round_keys = decryption_key_schedule.m_round_keys;
+
+  add_round_key(state, round_keys, NUM_ROUNDS);
+
+  for (size_t round_index = NUM_ROUNDS - 1; round_index > 0; --round_index) {
+    inv_sub_bytes(state);
+    inv_shift_rows(state);
+    inv_mix_columns(state);
+    add_round_key(state, round_keys, round_index);
+  }
+  inv_sub_bytes(state);
+  inv_shift_rows(state);
+  add_round_key(state, round_keys, 0);
+}
 
-  output = state;
+// Inverse of AES_cipher_bytes, with the same lane interleaving, using the
+// equivalent inverse cipher
+template <typename KeyScheduleType>
+void AES_inv_cipher_bytes(
+    const uint8_t *input, uint8_t *output, const size_t num_blocks,
+    const c_DecryptionKeySchedule<KeyScheduleType> &decryption_key_schedule) {
+  constexpr size_t KEY_SCHEDULE_SIZE_WORDS = std::tuple_size<KeyScheduleType>{};
+  constexpr size_t NUM_ROUNDS =
+      (KEY_SCHEDULE_SIZE_WORDS / BLOCK_SIZE_WORDS) - 1;
+  const KeyScheduleType &round_keys = decryption_key_schedule.m_round_keys;
+
+  for (size_t block_index = 0; block_index < num_blocks;
+       block_index += AES_MULTI_BLOCK_LANES) {
+    const size_t num_lanes =
+        std::min(AES_MULTI_BLOCK_LANES, num_blocks - block_index);
+    const size_t offset = block_index * BLOCK_SIZE_BYTES;
+    std::array<c_PackedBlock, AES_MULTI_BLOCK_LANES> states;
+
+    for (size_t lane = 0; lane < num_lanes; ++lane) {
+      states[lane] = load_block(input + offset + (lane * BLOCK_SIZE_BYTES));
+      add_round_key(states[lane], round_keys, NUM_ROUNDS);
+    }
+    for (size_t round_index = NUM_ROUNDS - 1; round_index > 0; --round_index) {
+      for (size_t lane = 0; lane < num_lanes; ++lane) {
+        inv_sub_bytes(states[lane]);
+        inv_shift_rows(states[lane]);
+        inv_mix_columns(states[lane]);
+        add_round_key(states[lane], round_keys, round_index);
+      }
+    }
+    for (size_t lane = 0; lane < num_lanes; ++lane) {
+      inv_sub_bytes(states[lane]);
+      inv_shift_rows(states[lane]);
+      add_round_key(states[lane], round_keys, 0);
+      store_block(states[lane], output + offset + (lane * BLOCK_SIZE_BYTES));
+    }
+  }
+}
+
+// Callers holding a decryption schedule should pass it instead, this
+// derives one on every call
+template <typename KeyScheduleType>
+void AES_inv_cipher_bytes(const uint8_t *input, uint8_t *output,
+                          const size_t num_blocks,
+                          const KeyScheduleType &key_schedule) {
+  AES_inv_cipher_bytes<KeyScheduleType>(
+      input, output, num_blocks, gen_decryption_key_schedule(key_schedule));
+}
+
+template <typename KeyScheduleType>
+void AES_inv_cipher_blocks(
+    std::span<const ByteBlock> input, std::span<ByteBlock> output,
+    const c_DecryptionKeySchedule<KeyScheduleType> &decryption_key_schedule) {
+  AES_inv_cipher_bytes<KeyScheduleType>(
+      reinterpret_cast<const uint8_t *>(input.data()),
+      reinterpret_cast<uint8_t *>(output.data()), input.size(),
+      decryption_key_schedule);
+}
+
+template <typename KeyScheduleType>
+void AES_inv_cipher_blocks(std::span<const ByteBlock> input,
+                           std::span<ByteBlock> output,
+                           const KeyScheduleType &key_schedule) {
+  AES_inv_cipher_blocks<KeyScheduleType>(
+      input, output, gen_decryption_key_schedule(key_schedule));
 }
 
 void AES_128_inv_cipher(const ByteBlock &input, ByteBlock &output,
@@ -181,21 +365,26 @@ void AES_256_inv_cipher(const ByteBlock &input, ByteBlock &output,
                         const AES256KeySchedule &key_schedule);
 
 template <typename KeyScheduleType>
-RawBytes AES_ECB_decrypt(const RawBytes &ciphertext_raw,
-                         const KeyScheduleType &key_schedule) {
+RawBytes AES_ECB_decrypt(
+    const RawBytes &ciphertext_raw,
+    const c_DecryptionKeySchedule<KeyScheduleType> &decryption_key_schedule) {
+  if (ciphertext_raw.size() % BLOCK_SIZE_BYTES != 0) {
+    throw std::invalid_argument("ECB ciphertext is not a whole number of "
+                                "blocks");
+  }
   RawBytes plaintext_raw(ciphertext_raw.size());
+  AES_inv_cipher_bytes<KeyScheduleType>(
+      ciphertext_raw.data(), plaintext_raw.data(),
+      ciphertext_raw.size() / BLOCK_SIZE_BYTES, decryption_key_schedule);
+  plaintext_raw.resize(strip_pkcs7_padding(plaintext_raw).size());
+  return plaintext_raw;
+}
 
-  const size_t num_blocks =
-      std::ceil<size_t>(double(ciphertext_raw.size()) / BLOCK_SIZE_BYTES);
-  for (size_t block_index = 0; block_index < num_blocks; ++block_index) {
-    ByteBlock ciphertext =
-        from_raw_bytes_to_byte_block(ciphertext_raw, block_index);
-    ByteBlock plaintext;
-    AES_inv_cipher(ciphertext, plaintext, key_schedule);
-
-    from_byte_block_to_raw_bytes(plaintext, plaintext_raw, block_index);
-  }
-  return remove_pkcs7_padding(plaintext_raw, BLOCK_SIZE_BYTES);
+template <typename KeyScheduleType>
+RawBytes AES_ECB_decrypt(const RawBytes &ciphertext_raw,
+                         const KeyScheduleType &key_schedule) {
+  return AES_ECB_decrypt<KeyScheduleType>(
+      ciphertext_raw, gen_decryption_key_schedule(key_schedule));
 }
 
 RawBytes AES_128_ECB_decrypt(const RawBytes &ciphertext_raw,
@@ -205,6 +394,77 @@ RawBytes AES_192_ECB_decrypt(const RawBytes &ciphertext_raw,
 RawBytes AES_256_ECB_decrypt(const RawBytes &ciphertext_raw,
                              const RawBytes &key_raw);
 
+template <typename KeyScheduleType>
+RawBytes AES_CBC_encrypt(const RawBytes &plaintext_raw,
+                         const KeyScheduleType &key_schedule,
+                         const ByteBlock &iv) {
+  RawBytes ciphertext_raw(pkcs7_padded_length(plaintext_raw.size()));
+  std::copy(std::begin(plaintext_raw), std::end(plaintext_raw),
+            std::begin(ciphertext_raw));
+  pad_pkcs7_in_place(ciphertext_raw, plaintext_raw.size());
+
+  c_PackedBlock chain = load_block(iv);
+  for (size_t offset = 0; offset < ciphertext_raw.size();
+       offset += BLOCK_SIZE_BYTES) {
+    chain ^= load_block(ciphertext_raw.data() + offset);
+    AES_cipher(chain, key_schedule);
+    store_block(chain, ciphertext_raw.data() + offset);
+  }
+  return ciphertext_raw;
+}
+
+template <typename KeyScheduleType>
+RawBytes AES_CBC_encrypt(const RawBytes &plaintext_raw,
+                         const KeyScheduleType &key_schedule,
+                         const RawBytes &iv_raw) {
+  const ByteBlock iv = from_raw_bytes_to_byte_block(iv_raw);
+  return AES_CBC_encrypt<KeyScheduleType>(plaintext_raw, key_schedule, iv);
+}
+
+template <typename KeyScheduleType>
+RawBytes AES_CBC_decrypt_padded(
+    const ByteSpan ciphertext_raw,
+    const c_DecryptionKeySchedule<KeyScheduleType> &decryption_key_schedule,
+    const ByteBlock &iv) {
+  if (ciphertext_raw.size() % BLOCK_SIZE_BYTES != 0) {
+    throw std::invalid_argument("CBC ciphertext is not a whole number of "
+                                "blocks");
+  }
+  // Unlike encryption, every block can be deciphered independently
+  RawBytes plaintext_raw(ciphertext_raw.size());
+  AES_inv_cipher_bytes<KeyScheduleType>(
+      ciphertext_raw.data(), plaintext_raw.data(),
+      ciphertext_raw.size() / BLOCK_SIZE_BYTES, decryption_key_schedule);
+
+  c_PackedBlock last_ciphertext = load_block(iv);
+  for (size_t offset = 0; offset < plaintext_raw.size();
+       offset += BLOCK_SIZE_BYTES) {
+    const c_PackedBlock plaintext =
+        load_block(plaintext_raw.data() + offset) ^ last_ciphertext;
+    last_ciphertext = load_block(ciphertext_raw.data() + offset);
+    store_block(plaintext, plaintext_raw.data() + offset);
+  }
+  return plaintext_raw;
+}
+
+template <typename KeyScheduleType>
+RawBytes AES_CBC_decrypt_padded(const ByteSpan ciphertext_raw,
+                                const KeyScheduleType &key_schedule,
+                                const ByteBlock &iv) {
+  return AES_CBC_decrypt_padded<KeyScheduleType>(
+      ciphertext_raw, gen_decryption_key_schedule(key_schedule), iv);
+}
+
+template <typename KeyScheduleType>
+RawBytes AES_CBC_decrypt(const RawBytes &ciphertext_raw,
+                         const KeyScheduleType &key_schedule,
+                         const RawBytes &iv_raw) {
+  RawBytes plaintext_raw = AES_CBC_decrypt_padded<KeyScheduleType>(
+      ciphertext_raw, key_schedule, from_raw_bytes_to_byte_block(iv_raw));
+  plaintext_raw.resize(strip_pkcs7_padding(plaintext_raw).size());
+  return plaintext_raw;
+}
+
 RawBytes AES_128_CBC_encrypt(const RawBytes &plaintext_raw,
                              const RawBytes &key_raw, const RawBytes &iv_raw);
 RawBytes AES_192_CBC_encrypt(const RawBytes &plaintext_raw,
@@ -220,14 +480,12 @@ RawBytes AES_256_CBC_decrypt(const RawBytes &ciphertext_raw,
                              const RawBytes &key_raw, const RawBytes &iv_raw);
 
 template <typename KeyType> KeyType gen_rand_key() {
-  static c_RandomByteGenerator generator;
-  KeyType key;
-  for (auto &word : key) {
-    word = generator.generate_random_word();
-  }
-  return key;
+  constexpr size_t KEY_SIZE_WORDS = std::tuple_size<KeyType>{};
+  return c_RandomByteGenerator().generate_random_word_array<KEY_SIZE_WORDS>();
 }
 
+ByteBlock gen_rand_block();
+
 AES128Key gen_rand_aes128_key();
 AES192Key gen_rand_aes192_key();
 AES256Key gen_rand_aes256_key();
@@ -254,13 +512,22 @@ RawBytes AES_128_rand_encrypt(const RawBytes &plaintext_raw);
 template <typename KeyType, typename KeyScheduleType> struct c_Encrypter {
   c_Encrypter(const KeyType &key)
       : m_key(key)
-      , m_key_schedule(gen_key_schedule(m_key)) {}
+      , m_key_schedule(gen_key_schedule(m_key))
+      , m_decryption_key_schedule(gen_decryption_key_schedule(m_key_schedule)) {
+  }
 
   c_Encrypter(const RawBytes &key_raw)
       : c_Encrypter(gen_key<KeyType>(key_raw)) {}
 
   RawBytes decrypt(const RawBytes &ciphertext_raw) const {
-    return AES_ECB_decrypt<KeyScheduleType>(ciphertext_raw, m_key_schedule);
+    return AES_ECB_decrypt<KeyScheduleType>(ciphertext_raw,
+                                            m_decryption_key_schedule);
+  }
+
+  void decrypt(std::span<const ByteBlock> ciphertexts,
+               std::span<ByteBlock> plaintexts) const {
+    AES_inv_cipher_blocks<KeyScheduleType>(ciphertexts, plaintexts,
+                                           m_decryption_key_schedule);
   }
 
   ByteBlock encrypt(const ByteBlock &plaintext) const {
@@ -269,18 +536,35 @@ template <typename KeyType, typename KeyScheduleType> struct c_Encrypter {
     return output;
   }
 
+  void encrypt(std::span<const ByteBlock> plaintexts,
+               std::span<ByteBlock> ciphertexts) const {
+    AES_cipher_blocks<KeyScheduleType>(plaintexts, ciphertexts, m_key_schedule);
+  }
+
   RawBytes encrypt(const RawBytes &plaintext_raw) const {
     return AES_ECB_encrypt<KeyScheduleType>(plaintext_raw, m_key_schedule);
   }
 
+  // ECB(prefix || plaintext), assembled in the output buffer
   RawBytes encrypt(const RawBytes &plaintext_raw,
                    const RawBytes &prefix) const {
-    const RawBytes full_plaintext_raw = prepend_bytes(plaintext_raw, prefix);
-    return encrypt(full_plaintext_raw);
+    const size_t length = prefix.size() + plaintext_raw.size();
+    RawBytes ciphertext_raw(pkcs7_padded_length(length));
+    std::copy(std::begin(prefix), std::end(prefix),
+              std::begin(ciphertext_raw));
+    std::copy(std::begin(plaintext_raw), std::end(plaintext_raw),
+              std::begin(ciphertext_raw) + prefix.size());
+    pad_pkcs7_in_place(ciphertext_raw, length);
+    AES_cipher_bytes<KeyScheduleType>(ciphertext_raw.data(),
+                                      ciphertext_raw.data(),
+                                      ciphertext_raw.size() / BLOCK_SIZE_BYTES,
+                                      m_key_schedule);
+    return ciphertext_raw;
   }
 
   const KeyType m_key;
   const KeyScheduleType m_key_schedule;
+  const c_DecryptionKeySchedule<KeyScheduleType> m_decryption_key_schedule;
 };
 
 template <typename KeyType, typename KeyScheduleType>
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <freq_map.hpp>
+#include <raw_bytes.hpp>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+struct c_ByteHistogram {
+  std::array<uint64_t, 256> m_counts{};
+  uint64_t m_total = 0;
+};
+
+// Counts into several interleaved tables, so that runs of one byte value do
+// not serialise on a single counter
+c_ByteHistogram gen_histogram(ByteSpan input);
+
+// Histograms of bytes index % num_columns == column, in one pass. These are
+// the positions a repeating key of num_columns bytes XORs with one key byte.
+std::vector<c_ByteHistogram> gen_column_histograms(ByteSpan input,
+                                                   size_t num_columns);
+
+// Chance that two bytes drawn without replacement are equal. XOR with a
+// constant leaves it unchanged.
+double index_of_coincidence(const c_ByteHistogram &histogram);
+
+double mean_column_index_of_coincidence(ByteSpan input, size_t num_columns);
+
+// Bigrams and trigrams are counted over a folded alphabet: letters without
+// case, whitespace, digits, punctuation, quotes and everything else
+constexpr inline size_t NGRAM_ALPHABET_SIZE = 32;
+
+// Byte and n-gram probabilities with their log2 tables computed up front, so
+// that scoring is lookups and adds. Every probability is smoothed above zero.
+struct c_LanguageModel {
+  // Byte probabilities from freq_map, read as c_CandidateModel reads it, and
+  // n-grams trained on corpus
+  c_LanguageModel(const FreqMap &freq_map, ByteSpan corpus);
+  // Everything trained on corpus
+  explicit c_LanguageModel(ByteSpan corpus);
+
+  std::array<double, 256> m_probabilities{};
+  std::array<double, 256> m_log_probabilities{};
+  std::array<double, 256> m_inverse_probabilities{};
+  // log2 P(next | previous) and P(next | previous two), indexed by the folded
+  // symbols as previous * NGRAM_ALPHABET_SIZE + next
+  std::vector<double> m_bigram_log_probabilities;
+  std::vector<double> m_trigram_log_probabilities;
+
+private:
+  void cache_byte_tables();
+  void train_ngrams(ByteSpan corpus);
+};
+
+// english_freq_map with n-grams from a built in English corpus, built once
+const c_LanguageModel &english_language_model();
+
+double chi_squared(const c_ByteHistogram &histogram,
+                   const c_LanguageModel &model);
+
+// Total log2 likelihood of the bytes under the byte probabilities alone
+double log_likelihood(const c_ByteHistogram &histogram,
+                      const c_LanguageModel &model);
+
+// Total log2 likelihood of every byte after the first order - 1, given those
+// before it. order is 2 or 3.
+double ngram_log_likelihood(ByteSpan text, const c_LanguageModel &model,
+                            size_t order);
+
+// Total log2 likelihood of next[i] following previous[i], for i up to the
+// shorter of the two. Scores two aligned columns of many texts.
+double pairwise_bigram_log_likelihood(ByteSpan previous, ByteSpan next,
+                                      const c_LanguageModel &model);
+
+// Negative log2 likelihood per byte from the byte, bigram and trigram
+// tables together. Lower is more like the model.
+double score_text(ByteSpan text, const c_LanguageModel &model);
+
+enum class ScoreMethod { log_likelihood, chi_squared };
+
+// Scores input ^ key for all 256 keys from the histogram of input alone,
+// since XOR with key only permutes the counts. Lower is more like the model:
+// negative log2 likelihood per byte, or the chi-squared statistic.
+std::array<double, 256>
+score_single_xor_keys(const c_ByteHistogram &histogram,
+                      const c_LanguageModel &model,
+                      ScoreMethod method = ScoreMethod::log_likelihood);
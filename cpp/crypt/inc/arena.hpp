@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+constexpr inline size_t ARENA_INITIAL_CHUNK_BYTES = 64 * 1024;
+
+struct c_ArenaStats {
+  // Bump allocations served
+  size_t m_num_allocations = 0;
+  // Chunks taken from the heap; flat once a thread has warmed up
+  size_t m_num_chunk_allocations = 0;
+  size_t m_bytes_reserved = 0;
+  size_t m_high_water_bytes = 0;
+};
+
+// Bump allocator for the short lived buffers of the analysis and attack code.
+// Deallocation is a no-op; memory comes back when a c_ScratchScope rewinds
+// the arena to where it stood when the scope was opened. Chunks are kept
+// after a rewind, so a warmed up arena no longer touches the heap.
+struct c_BumpArena : std::pmr::memory_resource {
+  struct c_Mark {
+    size_t m_chunk_index = 0;
+    size_t m_offset = 0;
+  };
+
+  c_BumpArena(size_t initial_chunk_bytes = ARENA_INITIAL_CHUNK_BYTES);
+  c_BumpArena(const c_BumpArena &) = delete;
+  c_BumpArena &operator=(const c_BumpArena &) = delete;
+
+  c_Mark mark() const;
+  // Frees everything allocated since mark was taken
+  void rewind(const c_Mark &mark);
+  size_t bytes_in_use() const;
+
+  c_ArenaStats m_stats;
+
+private:
+  struct c_Chunk {
+    std::unique_ptr<std::byte[]> m_data;
+    size_t m_size = 0;
+  };
+
+  void *do_allocate(size_t num_bytes, size_t alignment) override;
+  void do_deallocate(void *, size_t, size_t) override {}
+  bool do_is_equal(const std::pmr::memory_resource &other) const
+      noexcept override {
+    return this == &other;
+  }
+
+  const size_t m_initial_chunk_bytes;
+  std::vector<c_Chunk> m_chunks;
+  size_t m_chunk_index = 0;
+  size_t m_offset = 0;
+};
+
+// The calling thread's arena. Every thread has its own, so a new worker
+// thread starts with an empty arena and takes its first chunk from the heap.
+c_BumpArena &scratch_arena();
+
+// Where the calling thread's scratch buffers come from, the arena unless
+// overridden. Benchmarks point this at the heap to measure the difference.
+// The override is per thread too; for_each_worker passes it on to workers.
+std::pmr::memory_resource *scratch_resource();
+// nullptr restores the arena
+void set_scratch_resource(std::pmr::memory_resource *resource);
+// The override, or nullptr when the calling thread uses its arena
+std::pmr::memory_resource *scratch_resource_override();
+
+// Sets the calling thread's override for the life of the scope
+struct c_ScratchResourceScope {
+  c_ScratchResourceScope(std::pmr::memory_resource *resource)
+      : m_previous(scratch_resource_override()) {
+    set_scratch_resource(resource);
+  }
+  ~c_ScratchResourceScope() { set_scratch_resource(m_previous); }
+  c_ScratchResourceScope(const c_ScratchResourceScope &) = delete;
+  c_ScratchResourceScope &operator=(const c_ScratchResourceScope &) = delete;
+
+  std::pmr::memory_resource *const m_previous;
+};
+
+// Scratch buffers made inside a scope must not outlive it.
+struct c_ScratchScope {
+  c_ScratchScope()
+      : m_arena(scratch_arena())
+      , m_mark(m_arena.mark()) {}
+  ~c_ScratchScope() { m_arena.rewind(m_mark); }
+  c_ScratchScope(const c_ScratchScope &) = delete;
+  c_ScratchScope &operator=(const c_ScratchScope &) = delete;
+
+  c_BumpArena &m_arena;
+  const c_BumpArena::c_Mark m_mark;
+};
+
+template <typename ValueType>
+using ScratchVector = std::pmr::vector<ValueType>;
+
+// A RawBytes lookalike that allocates from a memory resource
+using ScratchBytes = ScratchVector<uint8_t>;
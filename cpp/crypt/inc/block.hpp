@@ -5,6 +5,7 @@
 #include <array>
 #include <cstdint>
 #include <iostream>
+#include <vector>
 
 constexpr inline size_t WORD_SIZE_BYTES = 4;
 constexpr inline size_t BLOCK_SIZE_WORDS = 4;
@@ -49,6 +50,7 @@ std::ostream &pretty_print(std::ostream &out, const ByteBlock &input) {
 
 ByteBlock from_raw_bytes_to_byte_block(const RawBytes &,
                                        size_t block_number = 0);
+ByteBlock from_raw_bytes_to_byte_block(ByteSpan, size_t block_number = 0);
 void from_byte_block_to_raw_bytes(const ByteBlock &, RawBytes &,
                                   size_t block_number = 0);
 RawBytes from_byte_block_to_raw_bytes(const ByteBlock &);
@@ -91,6 +93,9 @@ void from_word_array(const WordArray<WordArrayLength> &input,
 void rot_word(Word &);
 void sub_word(Word &);
 
+uint8_t sub_byte(uint8_t);
+uint8_t inv_sub_byte(uint8_t);
+
 void sub_bytes(ByteBlock &);
 void inv_sub_bytes(ByteBlock &);
 
@@ -102,3 +107,18 @@ void inv_mix_columns(ByteBlock &);
 
 Word operator^(const Word &, const Word &);
 ByteBlock operator^(const ByteBlock &, const ByteBlock &);
+
+// Independent chains of different lengths, ciphered a block at a time with
+// block i of every chain still running in one multi-block call, as in
+// CBC_encrypt_streams and CMAC_batch. Longest first, so the chains still
+// running are always a prefix of m_order.
+struct c_ChainSchedule {
+  explicit c_ChainSchedule(std::vector<size_t> num_blocks);
+
+  // Chains with a block at block_index
+  size_t num_running(size_t block_index) const;
+
+  std::vector<size_t> m_num_blocks;
+  // Chain indexes, longest first, ties in input order
+  std::vector<size_t> m_order;
+};
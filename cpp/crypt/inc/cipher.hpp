@@ -0,0 +1,79 @@
+#pragma once
+
+#include <aes.hpp>
+#include <raw_bytes.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// A keyed AES instance from one of the backends. Both directions work on
+// num_blocks contiguous blocks, and input and output may be the same buffer.
+struct c_BlockCipher {
+  virtual ~c_BlockCipher() = default;
+
+  virtual void encrypt_blocks(const uint8_t *input, uint8_t *output,
+                              size_t num_blocks) const = 0;
+  virtual void decrypt_blocks(const uint8_t *input, uint8_t *output,
+                              size_t num_blocks) const = 0;
+};
+
+using BlockCipherFactory =
+    std::unique_ptr<c_BlockCipher> (*)(const RawBytes &key_raw);
+
+struct c_CipherBackend {
+  std::string m_name;
+  BlockCipherFactory m_factory = nullptr;
+  // Without an override, the highest priority backend is the default
+  int m_priority = 0;
+};
+
+// Instantiates CipherType for the key size of key_raw
+template <template <typename, typename> class CipherType>
+std::unique_ptr<c_BlockCipher> make_aes_cipher(const RawBytes &key_raw) {
+  switch (key_raw.size()) {
+  case AES_128_KEY_LENGTH_WORDS * WORD_SIZE_BYTES:
+    return std::make_unique<CipherType<AES128Key, AES128KeySchedule>>(
+        gen_key<AES128Key>(key_raw));
+  case AES_192_KEY_LENGTH_WORDS * WORD_SIZE_BYTES:
+    return std::make_unique<CipherType<AES192Key, AES192KeySchedule>>(
+        gen_key<AES192Key>(key_raw));
+  case AES_256_KEY_LENGTH_WORDS * WORD_SIZE_BYTES:
+    return std::make_unique<CipherType<AES256Key, AES256KeySchedule>>(
+        gen_key<AES256Key>(key_raw));
+  }
+  throw std::invalid_argument("AES keys are 16, 24 or 32 bytes!");
+}
+
+// The built in backends, each taking a 16, 24 or 32 byte key
+std::unique_ptr<c_BlockCipher> make_reference_cipher(const RawBytes &key_raw);
+std::unique_ptr<c_BlockCipher> make_ttable_cipher(const RawBytes &key_raw);
+std::unique_ptr<c_BlockCipher> make_bitsliced_cipher(const RawBytes &key_raw);
+// Throws std::runtime_error when the CPU lacks the AES instructions
+std::unique_ptr<c_BlockCipher> make_aesni_cipher(const RawBytes &key_raw);
+bool aesni_is_supported();
+
+// Names the default backend when set_default_cipher_backend has not
+constexpr inline const char *CIPHER_BACKEND_ENV = "CRYPT_CIPHER_BACKEND";
+
+// Checks the FIPS-197 Appendix C vectors for every key size, over several
+// block counts and in place. Throws std::runtime_error on a mismatch.
+void self_test_cipher_backend(const c_CipherBackend &backend);
+
+// Self tests the backend, then adds it, replacing one with the same name
+void register_cipher_backend(const c_CipherBackend &backend);
+
+std::vector<c_CipherBackend> get_cipher_backends();
+// Throws std::invalid_argument for an unknown name
+c_CipherBackend get_cipher_backend(std::string_view name);
+
+// Takes precedence over CIPHER_BACKEND_ENV. An empty name clears it.
+void set_default_cipher_backend(std::string_view name);
+c_CipherBackend get_default_cipher_backend();
+
+std::unique_ptr<c_BlockCipher> make_block_cipher(const RawBytes &key_raw);
+std::unique_ptr<c_BlockCipher> make_block_cipher(std::string_view backend_name,
+                                                 const RawBytes &key_raw);
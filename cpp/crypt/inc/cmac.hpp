@@ -0,0 +1,165 @@
+#pragma once
+
+#include <aes.hpp>
+#include <block.hpp>
+#include <packed_block.hpp>
+#include <raw_bytes.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <utility>
+#include <vector>
+
+// SP 800-38B / RFC 4493 AES-CMAC with a full 16 byte tag
+
+// Doubling in GF(2^128) on a big-endian block, the subkey step of CMAC
+inline ByteBlock cmac_double(const ByteBlock &input) {
+  const uint8_t *input_bytes = reinterpret_cast<const uint8_t *>(&input);
+  ByteBlock output;
+  uint8_t *output_bytes = reinterpret_cast<uint8_t *>(&output);
+  for (size_t byte_index = 0; byte_index < BLOCK_SIZE_BYTES; ++byte_index) {
+    const uint8_t next_bit = (byte_index + 1 < BLOCK_SIZE_BYTES)
+                                 ? (input_bytes[byte_index + 1] >> 7)
+                                 : 0;
+    output_bytes[byte_index] =
+        uint8_t(input_bytes[byte_index] << 1) | next_bit;
+  }
+  // Reduce by x^128 + x^7 + x^2 + x + 1 when the top bit fell off
+  output_bytes[BLOCK_SIZE_BYTES - 1] ^= 0x87 & (0 - (input_bytes[0] >> 7));
+  return output;
+}
+
+struct c_CMACSubkeys {
+  // For a complete final block
+  ByteBlock m_subkey_1;
+  // For a padded final block
+  ByteBlock m_subkey_2;
+};
+
+template <typename KeyScheduleType>
+c_CMACSubkeys gen_cmac_subkeys(const KeyScheduleType &key_schedule) {
+  ByteBlock cipher_zero;
+  AES_cipher<KeyScheduleType>(ByteBlock{}, cipher_zero, key_schedule);
+  const ByteBlock subkey_1 = cmac_double(cipher_zero);
+  return {subkey_1, cmac_double(subkey_1)};
+}
+
+// The num_last_bytes (1 to 16, or 0 for an empty message) at last_block,
+// padded and masked with the matching subkey
+inline c_PackedBlock cmac_final_block(const uint8_t *last_block,
+                                      const size_t num_last_bytes,
+                                      const c_CMACSubkeys &subkeys) {
+  if (num_last_bytes == BLOCK_SIZE_BYTES) {
+    return load_block(last_block) ^ load_block(subkeys.m_subkey_1);
+  }
+  std::array<uint8_t, BLOCK_SIZE_BYTES> padded{};
+  if (num_last_bytes > 0) {
+    std::memcpy(padded.data(), last_block, num_last_bytes);
+  }
+  padded[num_last_bytes] = 0x80;
+  return load_block(padded.data()) ^ load_block(subkeys.m_subkey_2);
+}
+
+// Streaming CMAC: update any number of times, then finalize, which resets
+// the stream for the next message under the same key
+template <typename KeyScheduleType> struct c_CMAC {
+  c_CMAC(const KeyScheduleType &key_schedule)
+      : m_key_schedule(key_schedule)
+      , m_subkeys(gen_cmac_subkeys(key_schedule)) {}
+
+  void update(ByteSpan input) {
+    while (!input.empty()) {
+      // The last block is held back, since finalize treats it differently
+      if (m_num_buffered_bytes == BLOCK_SIZE_BYTES) {
+        m_chain ^= load_block(m_buffer.data());
+        AES_cipher(m_chain, m_key_schedule);
+        m_num_buffered_bytes = 0;
+      }
+      const size_t num_bytes =
+          std::min(input.size(), BLOCK_SIZE_BYTES - m_num_buffered_bytes);
+      std::memcpy(m_buffer.data() + m_num_buffered_bytes, input.data(),
+                  num_bytes);
+      m_num_buffered_bytes += num_bytes;
+      input = input.subspan(num_bytes);
+    }
+  }
+
+  ByteBlock finalize() {
+    c_PackedBlock tag = m_chain ^ cmac_final_block(m_buffer.data(),
+                                                   m_num_buffered_bytes,
+                                                   m_subkeys);
+    AES_cipher(tag, m_key_schedule);
+    m_chain = c_PackedBlock{};
+    m_num_buffered_bytes = 0;
+    return to_byte_block(tag);
+  }
+
+  const KeyScheduleType m_key_schedule;
+  const c_CMACSubkeys m_subkeys;
+
+private:
+  c_PackedBlock m_chain{};
+  std::array<uint8_t, BLOCK_SIZE_BYTES> m_buffer{};
+  size_t m_num_buffered_bytes = 0;
+};
+
+using c_AES128CMAC = c_CMAC<AES128KeySchedule>;
+using c_AES256CMAC = c_CMAC<AES256KeySchedule>;
+
+template <typename KeyScheduleType>
+ByteBlock CMAC(const KeyScheduleType &key_schedule, const ByteSpan message) {
+  c_CMAC<KeyScheduleType> cmac(key_schedule);
+  cmac.update(message);
+  return cmac.finalize();
+}
+
+// Tags many independent messages under one key, on a c_ChainSchedule
+template <typename KeyScheduleType>
+std::vector<ByteBlock> CMAC_batch(const KeyScheduleType &key_schedule,
+                                  std::span<const ByteSpan> messages) {
+  const c_CMACSubkeys subkeys = gen_cmac_subkeys(key_schedule);
+  const size_t num_messages = messages.size();
+  // An empty message is still one (padded) block
+  std::vector<size_t> num_blocks(num_messages);
+  for (size_t message_index = 0; message_index < num_messages;
+       ++message_index) {
+    num_blocks[message_index] = std::max<size_t>(
+        (messages[message_index].size() + BLOCK_SIZE_BYTES - 1) /
+            BLOCK_SIZE_BYTES,
+        1);
+  }
+  const c_ChainSchedule schedule(std::move(num_blocks));
+  const std::vector<size_t> &order = schedule.m_order;
+
+  RawBytes chains(num_messages * BLOCK_SIZE_BYTES, 0);
+  for (size_t block_index = 0;; ++block_index) {
+    const size_t num_active = schedule.num_running(block_index);
+    if (num_active == 0) {
+      break;
+    }
+    for (size_t slot = 0; slot < num_active; ++slot) {
+      const size_t message_index = order[slot];
+      const ByteSpan message = messages[message_index];
+      const size_t offset = block_index * BLOCK_SIZE_BYTES;
+      uint8_t *chain = chains.data() + (slot * BLOCK_SIZE_BYTES);
+      const c_PackedBlock block =
+          (block_index + 1 == schedule.m_num_blocks[message_index])
+              ? cmac_final_block(message.data() + offset,
+                                 message.size() - offset, subkeys)
+              : load_block(message.data() + offset);
+      store_block(load_block(chain) ^ block, chain);
+    }
+    AES_cipher_bytes<KeyScheduleType>(chains.data(), chains.data(),
+                                      num_active, key_schedule);
+  }
+
+  std::vector<ByteBlock> tags(num_messages);
+  for (size_t slot = 0; slot < num_messages; ++slot) {
+    std::memcpy(&tags[order[slot]], chains.data() + (slot * BLOCK_SIZE_BYTES),
+                BLOCK_SIZE_BYTES);
+  }
+  return tags;
+}
@@ -1,10 +1,56 @@
 #pragma once
 
+#include <block.hpp>
+#include <padding.hpp>
 #include <util.hpp>
 
-#include <sstream>
+#include <atomic>
+#include <cstdint>
+#include <span>
 #include <string>
 #include <string_view>
+#include <vector>
+
+enum class CookieError {
+  ok,
+  missing_equals,
+  unknown_key,
+  bad_uid,
+  buffer_too_small,
+  bad_token,
+};
+
+std::string_view to_string(CookieError error);
+
+// A parsed cookie whose fields point into the parsed text. The email is left
+// encoded.
+struct c_ProfileCookieView {
+  std::string_view m_email;
+  size_t m_uid = 0;
+  std::string_view m_role;
+};
+
+CookieError parse_profile_cookie(std::string_view input,
+                                 c_ProfileCookieView &output);
+
+size_t encoded_length(std::string_view input);
+// Exact number of characters serialize_profile_cookie writes
+size_t serialized_length(const c_ProfileCookieView &cookie);
+// Writes the cookie into the front of buffer, encoding the email, and sets
+// num_written. Writes nothing if buffer is too small.
+CookieError serialize_profile_cookie(const c_ProfileCookieView &cookie,
+                                     std::span<char> buffer,
+                                     size_t &num_written);
+
+// Hands out unique uids from any number of threads
+struct c_UidAllocator {
+  // Reserves count consecutive uids and returns the first
+  size_t allocate(const size_t count = 1) {
+    return m_next_uid.fetch_add(count, std::memory_order_relaxed);
+  }
+
+  std::atomic<size_t> m_next_uid{0};
+};
 
 struct c_ProfileCookie {
 
@@ -18,51 +64,13 @@ struct c_ProfileCookie {
 
   c_ProfileCookie(const std::string &email)
       : m_email(email)
-      , m_uid(m_uid_counter++)
+      , m_uid(m_uid_allocator.allocate())
       , m_role("user") {}
 
-  static c_ProfileCookie from_string(const std::string &input) {
-    size_t str_pos = 0;
-
-    // Be naive for the moment
-    c_ProfileCookie output;
-
-    // FIXME Something is wrong here
-
-    while (str_pos < input.size()) {
-      size_t equal_pos = input.find_first_of('=', str_pos);
-      std::string key_str = input.substr(str_pos, equal_pos - str_pos);
-      size_t and_pos = input.find_first_of('&', equal_pos);
-      if (and_pos == std::string_view::npos) {
-        and_pos = input.size();
-      }
-      std::string value_str =
-          input.substr(equal_pos + 1, and_pos - (equal_pos + 1));
-      if (key_str == "email") {
-        output.m_email = value_str;
-      } else if (key_str == "uid") {
-        output.m_uid = std::stoi(value_str);
-      } else if (key_str == "role") {
-        output.m_role = value_str;
-      } else {
-        throw_invalid_argument(key_str);
-      }
-      str_pos = and_pos + 1;
-    }
-    return output;
-  }
-
-  std::string to_string() const {
-    std::stringstream string_stream;
+  // Throws std::invalid_argument on malformed input
+  static c_ProfileCookie from_string(std::string_view input);
 
-    string_stream << "email=" << c_ProfileCookie::encode_string(m_email);
-    string_stream << "&";
-    string_stream << "uid=" << m_uid;
-    string_stream << "&";
-    string_stream << "role=" << m_role;
-
-    return string_stream.str();
-  }
+  std::string to_string() const;
 
   static std::string encode_string(const std::string &input) {
     std::string output;
@@ -80,10 +88,72 @@ struct c_ProfileCookie {
     return output;
   }
 
-  static size_t m_uid_counter;
+  c_ProfileCookieView view() const { return {m_email, m_uid, m_role}; }
+
+  static c_UidAllocator m_uid_allocator;
   std::string m_email;
-  size_t m_uid;
+  size_t m_uid = 0;
   std::string m_role;
 };
 
+// Cookies laid out back to back in one arena. Each starts on a block
+// boundary and is PKCS#7 padded in place, so the whole arena can be handed to
+// the cipher at once.
+struct c_ProfileBatch {
+  size_t size() const { return m_lengths.size(); }
+
+  // Unpadded cookie text. Only meaningful before the batch is encrypted.
+  std::string_view cookie(const size_t index) const {
+    return {reinterpret_cast<const char *>(&m_blocks[m_block_offsets[index]]),
+            m_lengths[index]};
+  }
+
+  // The padded blocks of one cookie, or its ciphertext once encrypted
+  ByteSpan blocks(const size_t index) const {
+    const size_t block_offset = m_block_offsets[index];
+    return {reinterpret_cast<const uint8_t *>(&m_blocks[block_offset]),
+            (m_block_offsets[index + 1] - block_offset) * BLOCK_SIZE_BYTES};
+  }
+
+  std::vector<ByteBlock> m_blocks;
+  // One entry per cookie plus the end of the arena
+  std::vector<size_t> m_block_offsets;
+  std::vector<size_t> m_lengths;
+};
+
+constexpr inline size_t UID_BLOCK_SIZE = 1024;
+
+// Builds "user" profiles. Uids are reserved from the shared allocator
+// UID_BLOCK_SIZE at a time, so a factory owned by one thread touches the
+// shared counter once per block rather than once per profile.
+struct c_ProfileFactory {
+  c_ProfileFactory(c_UidAllocator &uid_allocator =
+                       c_ProfileCookie::m_uid_allocator,
+                   const size_t uid_block_size = UID_BLOCK_SIZE)
+      : m_uid_allocator(uid_allocator)
+      , m_uid_block_size(uid_block_size) {}
+
+  size_t next_uid();
+
+  c_ProfileCookie make_profile(const std::string &email);
+  std::string profile_for(std::string_view email);
+  c_ProfileBatch profile_for_batch(std::span<const std::string_view> emails);
+
+  // Builds the batch and encrypts it in place, leaving ciphertexts in
+  // the arena
+  template <typename EncrypterType>
+  c_ProfileBatch
+  encrypt_profiles_for(const EncrypterType &encrypter,
+                       std::span<const std::string_view> emails) {
+    c_ProfileBatch batch = profile_for_batch(emails);
+    encrypter.encrypt(batch.m_blocks, batch.m_blocks);
+    return batch;
+  }
+
+  c_UidAllocator &m_uid_allocator;
+  const size_t m_uid_block_size;
+  size_t m_next_uid = 0;
+  size_t m_end_uid = 0;
+};
+
 std::string profile_for(const std::string &email);
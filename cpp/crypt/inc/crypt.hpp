@@ -1,20 +1,28 @@
 #pragma once
 
 #include <aes.hpp>
+#include <analysis.hpp>
+#include <arena.hpp>
 #include <block.hpp>
 #include <cookie.hpp>
 #include <freq_map.hpp>
+#include <oracle.hpp>
+#include <parallel.hpp>
 #include <raw_bytes.hpp>
 #include <util.hpp>
 
 #include <algorithm>
+#include <atomic>
+#include <barrier>
 #include <bit>
 #include <cctype>
 #include <cmath>
+#include <cstddef>
 #include <cstdint>
-#include <functional>
+#include <exception>
 #include <iostream>
 #include <limits>
+#include <memory>
 #include <span>
 #include <sstream>
 #include <stdexcept>
@@ -25,24 +33,634 @@
 
 RawBytes encrypt_repeating_xor(const RawBytes &plain_text, const RawBytes &key);
 
-std::pair<char, double> find_likely_single_xor(const RawBytes &input);
+// Keys up to this rank by byte frequency are rescored on bigrams and
+// trigrams, which settle close calls on short inputs
+constexpr inline size_t SINGLE_XOR_RESCORED_KEYS = 8;
+
+// Scores every key from one histogram of input. The score is lower for more
+// likely plaintext: bits per byte under the model, or chi-squared.
+std::pair<char, double> find_likely_single_xor(
+    const RawBytes &input,
+    const c_LanguageModel &model = english_language_model(),
+    ScoreMethod method = ScoreMethod::log_likelihood);
 
 size_t find_likely_key_length(const RawBytes &input, size_t lower_bound,
                               size_t upper_bound);
 
-RawBytes find_likely_key(const RawBytes &input, size_t key_length);
+// Each key byte from the histogram of the bytes it covers, all counted in
+// one pass over input
+RawBytes find_likely_key(
+    const RawBytes &input, size_t key_length,
+    const c_LanguageModel &model = english_language_model(),
+    ScoreMethod method = ScoreMethod::log_likelihood);
+
+// Index of the first block equal to an earlier one, or the number of blocks
+// if none is. Blocks are hashed in place, so the cost is linear in input.
+size_t find_repeated_block(ByteSpan input, size_t block_size_bytes);
 
 bool detect_ecb(const RawBytes &input);
 
-size_t detect_block_size(std::function<RawBytes(RawBytes)> encrypt_func);
+constexpr inline size_t MAX_DETECTED_BLOCK_SIZE_BYTES = 64;
+constexpr inline size_t DETECT_BLOCK_SIZE_BATCH_SIZE = 8;
+
+// Grows the input until the ciphertext grows; the size of that jump is the
+// block size. Probes are sent in batches to save round trips.
+template <Oracle OracleType> size_t detect_block_size(OracleType &oracle) {
+  c_ScratchScope scope;
+  const ScratchBytes probe_raw(MAX_DETECTED_BLOCK_SIZE_BYTES, 'X',
+                               scratch_resource());
+  const ByteSpan probe{probe_raw};
+  const size_t initial_length = oracle.query(probe.first(0)).size();
+
+  ScratchVector<ByteSpan> inputs(scratch_resource());
+  for (size_t batch_begin = 1; batch_begin <= MAX_DETECTED_BLOCK_SIZE_BYTES;
+       batch_begin += DETECT_BLOCK_SIZE_BATCH_SIZE) {
+    inputs.clear();
+    for (size_t length = batch_begin;
+         length < batch_begin + DETECT_BLOCK_SIZE_BATCH_SIZE &&
+         length <= MAX_DETECTED_BLOCK_SIZE_BYTES;
+         ++length) {
+      inputs.push_back(probe.first(length));
+    }
+    for (const ScratchBytes &output : query_batch_scratch(oracle, inputs)) {
+      if (output.size() > initial_length) {
+        return output.size() - initial_length;
+      }
+    }
+  }
+  throw std::runtime_error("Could not find block size");
+  return 0;
+}
+
+// Finds the length of the oracle's hidden suffix with a single batch.
+template <Oracle OracleType>
+size_t detect_length_bytes(const size_t block_size_bytes, OracleType &oracle) {
+  c_ScratchScope scope;
+  const ScratchBytes probe_raw(block_size_bytes, 'X', scratch_resource());
+  const ByteSpan probe{probe_raw};
+
+  ScratchVector<ByteSpan> inputs(scratch_resource());
+  inputs.reserve(block_size_bytes + 1);
+  for (size_t prefix_length = 0; prefix_length <= block_size_bytes;
+       ++prefix_length) {
+    inputs.push_back(probe.first(prefix_length));
+  }
+  const ScratchVector<ScratchBytes> outputs =
+      query_batch_scratch(oracle, inputs);
+
+  const size_t initial_length = outputs.front().size();
+  for (size_t prefix_length = 1; prefix_length <= block_size_bytes;
+       ++prefix_length) {
+    if (outputs[prefix_length].size() > initial_length) {
+      return initial_length - prefix_length;
+    }
+  }
+  throw std::runtime_error("Could not find target length");
+  return 0;
+}
+
+struct c_ByteAtATimeConfig {
+  bool m_use_candidate_model = true;
+  // Each thread searches its own run of the candidate order for every byte.
+  // 0 means one per core.
+  size_t m_num_threads = 1;
+  // Candidate blocks packed into each oracle query
+  size_t m_batch_size = AES_MULTI_BLOCK_LANES * 4;
+};
+
+struct c_ByteAtATimeStats {
+  double expected_oracle_calls_per_byte() const;
+  double oracle_calls_per_byte() const;
+
+  size_t m_bytes_recovered = 0;
+  // Calls actually issued, including whole waves after a match.
+  size_t m_oracle_calls = 0;
+  // Calls a serial search in candidate order would have needed.
+  size_t m_serial_oracle_calls = 0;
+  // Candidates a serial search in candidate order would have tried.
+  size_t m_candidate_rank_total = 0;
+};
+
+size_t get_byte_at_a_time_prefix_length(size_t block_size_bytes,
+                                        size_t byte_index);
+
+CandidateOrder get_byte_at_a_time_candidate_order(const c_CandidateModel &model,
+                                                  bool use_candidate_model,
+                                                  const RawBytes &decrypted_raw,
+                                                  size_t byte_index);
+
+// Lays out one block per candidate: the block_size_bytes - 1 bytes preceding
+// the target byte, followed by the candidate.
+RawBytes gen_byte_at_a_time_dictionary(size_t block_size_bytes,
+                                       const RawBytes &decrypted_raw,
+                                       size_t byte_index,
+                                       std::span<const uint8_t> candidates);
+
+// As above, into candidates.size() * block_size_bytes bytes of dictionary
+void gen_byte_at_a_time_dictionary(size_t block_size_bytes,
+                                   const RawBytes &decrypted_raw,
+                                   size_t byte_index,
+                                   std::span<const uint8_t> candidates,
+                                   std::span<uint8_t> dictionary);
+
+template <Oracle OracleType>
+size_t find_matching_candidate(OracleType &oracle,
+                               const size_t block_size_bytes,
+                               const ByteSpan dictionary,
+                               const ByteSpan block_of_interest) {
+  c_ScratchScope scope;
+  const ScratchVector<ScratchBytes> ciphertexts_raw =
+      query_batch_scratch(oracle, std::span{&dictionary, 1});
+  const size_t num_candidates = dictionary.size() / block_size_bytes;
+  const ByteSpan ciphertext{ciphertexts_raw.front()};
+  for (size_t index = 0; index < num_candidates; ++index) {
+    const ByteSpan block =
+        ciphertext.subspan(index * block_size_bytes, block_size_bytes);
+    if (std::ranges::equal(block, block_of_interest)) {
+      return index;
+    }
+  }
+  return num_candidates;
+}
+
+// Throws std::runtime_error if no candidate matches a byte, as when the
+// target is shorter than target_plaintext_length_bytes. The stats count the
+// bytes recovered before it.
+template <Oracle OracleType>
+RawBytes break_ecb_byte_at_a_time(const size_t block_size_bytes,
+                                  const size_t target_plaintext_length_bytes,
+                                  OracleType &oracle,
+                                  const c_ByteAtATimeConfig &config,
+                                  c_ByteAtATimeStats &stats,
+                                  const bool display = false) {
+  c_ScratchScope scope;
+  RawBytes decrypted_raw(target_plaintext_length_bytes, 0);
+
+  const ScratchBytes filler_raw(block_size_bytes, 'X', scratch_resource());
+  ScratchVector<ByteSpan> prefixes(scratch_resource());
+  for (size_t prefix_length = 0; prefix_length < block_size_bytes;
+       ++prefix_length) {
+    prefixes.push_back(ByteSpan{filler_raw}.first(prefix_length));
+  }
+  const ScratchVector<ScratchBytes> ciphertexts_raw =
+      query_batch_scratch(oracle, prefixes);
+  stats.m_oracle_calls += prefixes.size();
+
+  const size_t batch_size = std::max<size_t>(config.m_batch_size, 1);
+  const size_t num_batches = (256 + batch_size - 1) / batch_size;
+  const size_t num_workers =
+      get_num_workers(config.m_num_threads, num_batches);
+  // 256 KiB of transition counts is too much for the caller's stack
+  const auto model = std::make_unique<c_CandidateModel>();
+
+  // The byte being searched. Only the barrier's completion step writes it,
+  // while every worker is waiting.
+  size_t byte_index = 0;
+  bool is_done = (target_plaintext_length_bytes == 0);
+  CandidateOrder order{};
+  ByteSpan block_of_interest;
+  std::atomic<size_t> rank{0};
+  std::atomic<bool> is_failed{false};
+  std::exception_ptr error;
+
+  const auto prepare_byte = [&]() noexcept {
+    const size_t prefix_length =
+        get_byte_at_a_time_prefix_length(block_size_bytes, byte_index);
+    const size_t block_number = byte_index / block_size_bytes;
+    block_of_interest = ByteSpan{ciphertexts_raw[prefix_length]}.subspan(
+        block_number * block_size_bytes, block_size_bytes);
+    order = get_byte_at_a_time_candidate_order(
+        *model, config.m_use_candidate_model, decrypted_raw, byte_index);
+    rank = order.size();
+  };
+  const auto finish_byte = [&]() noexcept {
+    const size_t found_rank = rank;
+    const size_t serial_candidates = std::min(found_rank + 1, order.size());
+    stats.m_candidate_rank_total += serial_candidates;
+    stats.m_serial_oracle_calls +=
+        (serial_candidates + batch_size - 1) / batch_size;
+    if (found_rank < order.size()) {
+      const uint8_t recovered_byte = order[found_rank];
+      if (display) {
+        std::cout << char(recovered_byte) << std::flush;
+      }
+      decrypted_raw[byte_index] = recovered_byte;
+      if (byte_index > 0) {
+        model->observe(decrypted_raw[byte_index - 1], recovered_byte);
+      }
+      ++stats.m_bytes_recovered;
+    } else if (!is_failed.exchange(true)) {
+      error = std::make_exception_ptr(
+          std::runtime_error("No candidate matches the target byte"));
+    }
+    ++byte_index;
+    is_done = is_failed || byte_index == target_plaintext_length_bytes;
+    if (!is_done) {
+      prepare_byte();
+    }
+  };
+  if (!is_done) {
+    prepare_byte();
+  }
+
+  // One task per worker for the whole attack, each with a contiguous run of
+  // the candidate order. A worker stops once a match is known further up the
+  // order than its next batch.
+  std::barrier byte_barrier(std::ptrdiff_t(num_workers), finish_byte);
+  std::vector<size_t> worker_oracle_calls(num_workers, 0);
+  for_each_worker(num_workers, [&](const size_t worker_index) {
+    c_ScratchScope worker_scope;
+    ScratchBytes dictionary_raw(batch_size * block_size_bytes,
+                                scratch_resource());
+    const size_t run_begin = (order.size() * worker_index) / num_workers;
+    const size_t run_end = (order.size() * (worker_index + 1)) / num_workers;
+    while (!is_done) {
+      try {
+        for (size_t batch_begin = run_begin;
+             batch_begin < run_end && batch_begin < rank && !is_failed;
+             batch_begin += batch_size) {
+          const auto batch = std::span<const uint8_t>{order}.subspan(
+              batch_begin, std::min(batch_size, run_end - batch_begin));
+          const std::span<uint8_t> dictionary =
+              std::span{dictionary_raw}.first(batch.size() * block_size_bytes);
+          gen_byte_at_a_time_dictionary(block_size_bytes, decrypted_raw,
+                                        byte_index, batch, dictionary);
+          ++worker_oracle_calls[worker_index];
+          const size_t batch_rank = find_matching_candidate(
+              oracle, block_size_bytes, dictionary, block_of_interest);
+          if (batch_rank < batch.size()) {
+            const size_t found_rank = batch_begin + batch_rank;
+            size_t best_rank = rank;
+            while (found_rank < best_rank &&
+                   !rank.compare_exchange_weak(best_rank, found_rank)) {
+            }
+            break;
+          }
+        }
+      } catch (...) {
+        if (!is_failed.exchange(true)) {
+          error = std::current_exception();
+        }
+      }
+      byte_barrier.arrive_and_wait();
+    }
+  });
+  for (const size_t calls : worker_oracle_calls) {
+    stats.m_oracle_calls += calls;
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+  if (display) {
+    std::cout << std::endl;
+  }
+  return decrypted_raw;
+}
+
+// One candidate per query, in numeric order.
+template <Oracle OracleType>
+RawBytes break_ecb_byte_at_a_time(const size_t block_size_bytes,
+                                  const size_t target_plaintext_length_bytes,
+                                  OracleType &oracle,
+                                  const bool display = false) {
+  c_ByteAtATimeConfig config;
+  config.m_use_candidate_model = false;
+  config.m_batch_size = 1;
+  c_ByteAtATimeStats stats;
+  return break_ecb_byte_at_a_time(block_size_bytes,
+                                  target_plaintext_length_bytes, oracle, config,
+                                  stats, display);
+}
+
+// Bytes of the prefix alignment probe; they only need to differ
+constexpr inline uint8_t PREFIX_ALIGNMENT_FILLER = 'F';
+constexpr inline uint8_t PREFIX_ALIGNMENT_MARKER = 'M';
+
+struct c_PrefixAlignment {
+  size_t m_prefix_length_bytes = 0;
+  // Filler that takes the prefix to a block boundary, at least one byte
+  size_t m_filler_length_bytes = 0;
+  // Blocks of prefix and filler ahead of the first block of input
+  size_t m_num_prefix_blocks = 0;
+  size_t m_suffix_length_bytes = 0;
+};
+
+// Measures an oracle's hidden prefix and suffix with one batch of
+// block_size_bytes queries. Query p is p filler bytes, two marker blocks and
+// a filler byte; the only one whose marker blocks encrypt alike is the one
+// where they start on a block boundary. The probes also cover
+// block_size_bytes consecutive lengths, so one of them meets the padding
+// jump that gives the suffix length.
+template <Oracle OracleType>
+c_PrefixAlignment find_prefix_alignment(const size_t block_size_bytes,
+                                        OracleType &oracle) {
+  c_ScratchScope scope;
+  const size_t marker_offset = block_size_bytes;
+  const size_t probe_length = 3 * block_size_bytes + 1;
+  ScratchBytes probe_raw(probe_length, PREFIX_ALIGNMENT_FILLER,
+                         scratch_resource());
+  std::fill_n(std::begin(probe_raw) + marker_offset, 2 * block_size_bytes,
+              PREFIX_ALIGNMENT_MARKER);
+
+  // Query p starts p bytes before the markers
+  ScratchVector<ByteSpan> inputs(scratch_resource());
+  for (size_t filler_length = 1; filler_length <= block_size_bytes;
+       ++filler_length) {
+    inputs.push_back(
+        ByteSpan{probe_raw}.subspan(marker_offset - filler_length));
+  }
+  const ScratchVector<ScratchBytes> outputs =
+      query_batch_scratch(oracle, inputs);
+
+  // A repeat in the hidden suffix comes after the markers, so the aligned
+  // query has the earliest repeated pair
+  size_t aligned_index = inputs.size();
+  size_t marker_block = 0;
+  for (size_t index = 0; index < outputs.size(); ++index) {
+    const ByteSpan output{outputs[index]};
+    const size_t repeated_block = find_repeated_block(output, block_size_bytes);
+    if (repeated_block == 0 ||
+        repeated_block >= output.size() / block_size_bytes ||
+        !std::ranges::equal(
+            output.subspan((repeated_block - 1) * block_size_bytes,
+                           block_size_bytes),
+            output.subspan(repeated_block * block_size_bytes,
+                           block_size_bytes))) {
+      continue;
+    }
+    if (aligned_index == inputs.size() || repeated_block - 1 < marker_block) {
+      aligned_index = index;
+      marker_block = repeated_block - 1;
+    }
+  }
+  if (aligned_index == inputs.size()) {
+    throw std::runtime_error("Could not align with the prefix");
+  }
+
+  c_PrefixAlignment output;
+  output.m_filler_length_bytes = aligned_index + 1;
+  output.m_num_prefix_blocks = marker_block;
+  output.m_prefix_length_bytes =
+      marker_block * block_size_bytes - output.m_filler_length_bytes;
+
+  // Padding adds a whole block at the first length that fills one exactly
+  size_t jump_index = 0;
+  for (size_t index = 1; index < outputs.size(); ++index) {
+    if (outputs[index].size() > outputs[index - 1].size()) {
+      jump_index = index;
+      break;
+    }
+  }
+  const size_t known_length =
+      output.m_prefix_length_bytes + inputs[jump_index].size();
+  if (outputs[jump_index].size() < known_length + block_size_bytes) {
+    throw std::runtime_error("Could not find target length");
+  }
+  output.m_suffix_length_bytes =
+      outputs[jump_index].size() - known_length - block_size_bytes;
+  return output;
+}
+
+// Presents an oracle with a hidden prefix as one without: each input goes in
+// behind the filler that completes the prefix, and the blocks of prefix and
+// filler are cut from each answer.
+template <Oracle OracleType> struct c_PrefixAlignedOracle {
+  c_PrefixAlignedOracle(OracleType &oracle, const c_PrefixAlignment &alignment,
+                        const size_t block_size_bytes)
+      : m_oracle(oracle)
+      , m_alignment(alignment)
+      , m_block_size_bytes(block_size_bytes) {}
+
+  RawBytes query(ByteSpan input) {
+    c_ScratchScope scope;
+    const ScratchVector<ScratchBytes> outputs =
+        query_batch(std::span{&input, 1}, scratch_resource());
+    return RawBytes(std::begin(outputs.front()), std::end(outputs.front()));
+  }
+
+  std::vector<RawBytes> query_batch(std::span<const ByteSpan> inputs) {
+    c_ScratchScope scope;
+    std::vector<RawBytes> outputs;
+    outputs.reserve(inputs.size());
+    for (const ScratchBytes &output : query_batch(inputs, scratch_resource())) {
+      outputs.emplace_back(std::begin(output), std::end(output));
+    }
+    return outputs;
+  }
+
+  // The staging buffer is left in the scratch arena until the caller's scope
+  // closes
+  ScratchVector<ScratchBytes> query_batch(std::span<const ByteSpan> inputs,
+                                          std::pmr::memory_resource *resource) {
+    const size_t filler_length = m_alignment.m_filler_length_bytes;
+    size_t staging_length = 0;
+    for (const ByteSpan &input : inputs) {
+      staging_length += filler_length + input.size();
+    }
+    ScratchBytes staging_raw(staging_length, PREFIX_ALIGNMENT_FILLER,
+                             scratch_resource());
+    ScratchVector<ByteSpan> aligned_inputs(scratch_resource());
+    aligned_inputs.reserve(inputs.size());
+    size_t offset = 0;
+    for (const ByteSpan &input : inputs) {
+      std::ranges::copy(input, std::begin(staging_raw) + offset +
+                                   filler_length);
+      aligned_inputs.push_back(ByteSpan{staging_raw}.subspan(
+          offset, filler_length + input.size()));
+      offset += filler_length + input.size();
+    }
+
+    ScratchVector<ScratchBytes> outputs =
+        query_batch_scratch(m_oracle, aligned_inputs, resource);
+    const size_t skipped_length =
+        m_alignment.m_num_prefix_blocks * m_block_size_bytes;
+    for (ScratchBytes &output : outputs) {
+      output.erase(std::begin(output), std::begin(output) + skipped_length);
+    }
+    return outputs;
+  }
+
+  OracleType &m_oracle;
+  const c_PrefixAlignment m_alignment;
+  const size_t m_block_size_bytes;
+};
+
+struct c_RandomPrefixStats {
+  size_t oracle_calls() const {
+    return m_alignment_oracle_calls + m_byte_at_a_time.m_oracle_calls;
+  }
+
+  // One batch, which also gives the suffix length
+  size_t m_alignment_oracle_calls = 0;
+  c_ByteAtATimeStats m_byte_at_a_time;
+};
+
+// Byte at a time against ECB(unknown prefix || input || secret suffix)
+template <Oracle OracleType>
+RawBytes break_ecb_random_prefix(const size_t block_size_bytes,
+                                 OracleType &oracle,
+                                 const c_ByteAtATimeConfig &config,
+                                 c_RandomPrefixStats &stats,
+                                 const bool display = false) {
+  const c_PrefixAlignment alignment =
+      find_prefix_alignment(block_size_bytes, oracle);
+  stats.m_alignment_oracle_calls += block_size_bytes;
+  c_PrefixAlignedOracle aligned_oracle(oracle, alignment, block_size_bytes);
+  return break_ecb_byte_at_a_time(block_size_bytes,
+                                  alignment.m_suffix_length_bytes,
+                                  aligned_oracle, config,
+                                  stats.m_byte_at_a_time, display);
+}
+
+struct c_PaddingOracleConfig {
+  bool m_use_candidate_model = true;
+  // Ciphertext blocks are independent, so each thread takes its own blocks.
+  // 0 means one thread per core. With more than one thread the oracle is
+  // called concurrently.
+  size_t m_num_threads = 1;
+  // Guesses sent to the oracle in each batch
+  size_t m_batch_size = 16;
+};
+
+struct c_PaddingOracleStats {
+  double oracle_calls_per_byte() const;
+
+  size_t m_bytes_recovered = 0;
+  size_t m_oracle_calls = 0;
+  // Guesses that only looked valid through a longer padding like 0x02 0x02
+  size_t m_longer_paddings_ruled_out = 0;
+};
+
+CandidateOrder get_padding_oracle_plaintext_order(
+    const CandidateOrder &prior_order, const RawBytes &block_plaintext_raw,
+    size_t byte_index, bool is_final_block);
+
+// Recovers one plaintext block from the block before it and the padding
+// oracle, working from the last byte to the first.
+template <Oracle<bool> OracleType>
+RawBytes recover_cbc_block(OracleType &oracle, const ByteSpan previous_block,
+                           const ByteSpan target_block,
+                           const bool is_final_block,
+                           const CandidateOrder &prior_order,
+                           const size_t batch_size,
+                           c_PaddingOracleStats &stats) {
+  const size_t block_size_bytes = target_block.size();
+  const size_t query_size_bytes = 2 * block_size_bytes;
+  RawBytes intermediate_raw(block_size_bytes, 0);
+  RawBytes plaintext_raw(block_size_bytes, 0);
+
+  RawBytes forged_raw(query_size_bytes, 0);
+  std::copy(std::begin(target_block), std::end(target_block),
+            std::begin(forged_raw) + block_size_bytes);
+
+  RawBytes batch_raw;
+  std::vector<ByteSpan> queries;
+  for (size_t pad_value = 1; pad_value <= block_size_bytes; ++pad_value) {
+    const size_t byte_index = block_size_bytes - pad_value;
+    for (size_t known_index = byte_index + 1; known_index < block_size_bytes;
+         ++known_index) {
+      forged_raw[known_index] = intermediate_raw[known_index] ^ pad_value;
+    }
+
+    const CandidateOrder order = get_padding_oracle_plaintext_order(
+        prior_order, plaintext_raw, byte_index, is_final_block);
+
+    bool found = false;
+    for (size_t batch_begin = 0; batch_begin < order.size() && !found;
+         batch_begin += batch_size) {
+      const size_t batch_length =
+          std::min(batch_size, order.size() - batch_begin);
+      batch_raw.resize(batch_length * query_size_bytes);
+      queries.clear();
+      for (size_t index = 0; index < batch_length; ++index) {
+        uint8_t *query = batch_raw.data() + (index * query_size_bytes);
+        std::copy(std::begin(forged_raw), std::end(forged_raw), query);
+        // Guess the plaintext byte, then fix up the forged block to match
+        query[byte_index] = order[batch_begin + index] ^
+                            previous_block[byte_index] ^ uint8_t(pad_value);
+        queries.push_back(ByteSpan{query, query_size_bytes});
+      }
+
+      const std::vector<bool> valid = oracle.query_batch(queries);
+      stats.m_oracle_calls += batch_length;
+
+      for (size_t index = 0; index < batch_length && !found; ++index) {
+        if (!valid[index]) {
+          continue;
+        }
+        if (pad_value == 1 && byte_index > 0) {
+          // Rule out an accidental longer padding such as 0x02 0x02
+          RawBytes confirm_raw(std::begin(queries[index]),
+                               std::end(queries[index]));
+          confirm_raw[byte_index - 1] ^= 1;
+          ++stats.m_oracle_calls;
+          if (!oracle.query(confirm_raw)) {
+            ++stats.m_longer_paddings_ruled_out;
+            continue;
+          }
+        }
+        intermediate_raw[byte_index] =
+            queries[index][byte_index] ^ uint8_t(pad_value);
+        plaintext_raw[byte_index] =
+            intermediate_raw[byte_index] ^ previous_block[byte_index];
+        found = true;
+      }
+    }
+    if (!found) {
+      throw std::runtime_error("Padding oracle accepted no guess");
+    }
+  }
+  stats.m_bytes_recovered += block_size_bytes;
+  return plaintext_raw;
+}
+
+// Returns the recovered plaintext with its padding still attached. Throws
+// std::invalid_argument for a short IV or a partial ciphertext block.
+template <Oracle<bool> OracleType>
+RawBytes break_cbc_padding_oracle(OracleType &oracle, const RawBytes &iv_raw,
+                                  const RawBytes &ciphertext_raw,
+                                  const c_PaddingOracleConfig &config,
+                                  c_PaddingOracleStats &stats) {
+  if (iv_raw.size() < BLOCK_SIZE_BYTES) {
+    throw std::invalid_argument("IV is shorter than a block!");
+  }
+  if (ciphertext_raw.size() % BLOCK_SIZE_BYTES != 0) {
+    throw std::invalid_argument("Ciphertext is not a whole number of "
+                                "blocks!");
+  }
+  const size_t num_blocks = ciphertext_raw.size() / BLOCK_SIZE_BYTES;
+  RawBytes plaintext_raw(num_blocks * BLOCK_SIZE_BYTES, 0);
 
-size_t
-detect_length_bytes(size_t block_size_bytes,
-                    const RawBytes &target_plaintext_raw,
-                    std::function<RawBytes(RawBytes, RawBytes)> encrypt_func);
+  const auto prior_model = std::make_unique<c_CandidateModel>();
+  const CandidateOrder prior_order = get_byte_at_a_time_candidate_order(
+      *prior_model, config.m_use_candidate_model, plaintext_raw, 0);
+  const size_t batch_size = std::max<size_t>(config.m_batch_size, 1);
+  const size_t num_workers =
+      get_num_workers(config.m_num_threads, num_blocks);
+  const ByteSpan ciphertext{ciphertext_raw};
 
-RawBytes break_ecb_byte_at_a_time(size_t block_size_bytes,
-                                  size_t target_plaintext_length_bytes,
-                                  const c_AES128SecretKeyEncrypter &encrypter,
-                                  const RawBytes &target_plaintext_raw,
-                                  bool display = false);
+  std::vector<c_PaddingOracleStats> worker_stats(num_workers);
+  for_each_worker(num_workers, [&](const size_t worker_index) {
+    for (size_t block_index = worker_index; block_index < num_blocks;
+         block_index += num_workers) {
+      const ByteSpan previous_block =
+          (block_index == 0) ? ByteSpan{iv_raw}
+                             : ciphertext.subspan(
+                                   (block_index - 1) * BLOCK_SIZE_BYTES,
+                                   BLOCK_SIZE_BYTES);
+      const ByteSpan target_block = ciphertext.subspan(
+          block_index * BLOCK_SIZE_BYTES, BLOCK_SIZE_BYTES);
+      const RawBytes block_plaintext_raw = recover_cbc_block(
+          oracle, previous_block, target_block, block_index + 1 == num_blocks,
+          prior_order, batch_size, worker_stats[worker_index]);
+      std::copy(std::begin(block_plaintext_raw), std::end(block_plaintext_raw),
+                std::begin(plaintext_raw) + (block_index * BLOCK_SIZE_BYTES));
+    }
+  });
+  for (const c_PaddingOracleStats &worker : worker_stats) {
+    stats.m_bytes_recovered += worker.m_bytes_recovered;
+    stats.m_oracle_calls += worker.m_oracle_calls;
+    stats.m_longer_paddings_ruled_out += worker.m_longer_paddings_ruled_out;
+  }
+  return plaintext_raw;
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <arena.hpp>
+#include <oracle.hpp>
+#include <padding.hpp>
+#include <raw_bytes.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Where one block of a forged ciphertext is cut from
+struct c_BlockSource {
+  size_t m_probe_index = 0;
+  size_t m_block_index = 0;
+};
+
+// Inputs to send in one batch, and the block of an answer that goes in each
+// place of the forgery
+struct c_CutAndPastePlan {
+  std::vector<std::string> m_probes;
+  // One per block of the padded target
+  std::vector<c_BlockSource> m_sources;
+};
+
+constexpr inline char CUT_AND_PASTE_FILLER = 'A';
+
+// Finds every block of the padded target on a block boundary of some padded
+// probe plaintext, and keeps as few probes as cover them all. Throws
+// std::invalid_argument if a block is in none of them.
+c_CutAndPastePlan select_block_sources(std::span<const std::string> probes,
+                                       std::span<const std::string> plaintexts,
+                                       std::string_view target,
+                                       size_t block_size_bytes);
+
+// Index of the first plaintext byte that depends on the input
+template <typename TemplateType>
+size_t find_template_input_offset(TemplateType &&plaintext_template) {
+  const std::string lhs = plaintext_template(std::string_view("A"));
+  const std::string rhs = plaintext_template(std::string_view("B"));
+  const auto [lhs_position, rhs_position] = std::ranges::mismatch(lhs, rhs);
+  if (lhs_position == std::end(lhs) && rhs_position == std::end(rhs)) {
+    throw std::invalid_argument("Template does not depend on its input!");
+  }
+  return size_t(lhs_position - std::begin(lhs));
+}
+
+// Plans a forgery of target from answers to ECB(plaintext_template(input)).
+// The template must give the same plaintext for the same input, as
+// profile_for does with a fixed uid. Two kinds of probe are tried, all
+// locally: the target's own text from the input offset on, cut at every
+// length, which reproduces the target's leading blocks; and each target block
+// behind the filler that puts it on a block boundary.
+template <typename TemplateType>
+c_CutAndPastePlan plan_cut_and_paste(TemplateType &&plaintext_template,
+                                     const std::string_view target,
+                                     const size_t block_size_bytes) {
+  const size_t input_offset = find_template_input_offset(plaintext_template);
+
+  std::vector<std::string> probes;
+  if (input_offset <= target.size()) {
+    for (size_t length = 0; length <= target.size() - input_offset;
+         ++length) {
+      probes.emplace_back(target.substr(input_offset, length));
+    }
+  }
+  const RawBytes padded_target =
+      add_pkcs7_padding(RawBytes(std::begin(target), std::end(target)),
+                        block_size_bytes);
+  const size_t filler_length =
+      (block_size_bytes - input_offset % block_size_bytes) % block_size_bytes;
+  for (size_t offset = 0; offset < padded_target.size();
+       offset += block_size_bytes) {
+    std::string probe(filler_length, CUT_AND_PASTE_FILLER);
+    probe.append(std::begin(padded_target) + offset,
+                 std::begin(padded_target) + offset + block_size_bytes);
+    probes.push_back(std::move(probe));
+  }
+
+  std::vector<std::string> plaintexts;
+  plaintexts.reserve(probes.size());
+  for (const std::string &probe : probes) {
+    plaintexts.push_back(plaintext_template(std::string_view(probe)));
+  }
+  return select_block_sources(probes, plaintexts, target, block_size_bytes);
+}
+
+// Each source block copied once, straight out of the answer it is in. Throws
+// std::out_of_range if an answer is too short to hold its block.
+RawBytes splice_blocks(std::span<const ByteSpan> ciphertexts,
+                       std::span<const c_BlockSource> sources,
+                       size_t block_size_bytes);
+
+// Sends every probe of the plan in one batch and splices the answers
+template <Oracle OracleType>
+RawBytes forge_cut_and_paste(const c_CutAndPastePlan &plan,
+                             const size_t block_size_bytes,
+                             OracleType &oracle) {
+  c_ScratchScope scope;
+  ScratchVector<ByteSpan> inputs(scratch_resource());
+  inputs.reserve(plan.m_probes.size());
+  for (const std::string &probe : plan.m_probes) {
+    inputs.emplace_back(reinterpret_cast<const uint8_t *>(probe.data()),
+                        probe.size());
+  }
+  const ScratchVector<ScratchBytes> answers =
+      query_batch_scratch(oracle, inputs);
+  ScratchVector<ByteSpan> ciphertexts(std::begin(answers), std::end(answers),
+                                      scratch_resource());
+  return splice_blocks(ciphertexts, plan.m_sources, block_size_bytes);
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <aes.hpp>
+#include <block.hpp>
+
+#include <array>
+#include <cstdint>
+#include <span>
+
+// CTR_DRBG from NIST SP 800-90A using AES-128 without a derivation function.
+// The seed is one key plus one counter block.
+constexpr inline size_t CTR_DRBG_SEED_LENGTH_BYTES =
+    (AES_128_KEY_LENGTH_WORDS * WORD_SIZE_BYTES) + BLOCK_SIZE_BYTES;
+// Longest output of a single generate step before the state is updated
+constexpr inline size_t CTR_DRBG_MAX_REQUEST_BYTES = size_t(1) << 16;
+// Generate steps between reseeds from the OS. The standard allows 2^48.
+constexpr inline uint64_t CTR_DRBG_RESEED_INTERVAL = uint64_t(1) << 20;
+// Counter blocks handed to the multi-block kernel at once
+constexpr inline size_t CTR_DRBG_BATCH_BLOCKS = AES_MULTI_BLOCK_LANES * 4;
+
+using DrbgSeed = std::array<uint8_t, CTR_DRBG_SEED_LENGTH_BYTES>;
+
+// Fills output from getrandom. Throws std::runtime_error on failure.
+void get_os_entropy(std::span<uint8_t> output);
+
+struct c_CtrDrbg {
+  // Seeded from the OS, and reseeded from the OS every
+  // CTR_DRBG_RESEED_INTERVAL generate steps
+  c_CtrDrbg();
+  // Deterministic: the same seed always produces the same stream, and the
+  // generator never touches OS entropy
+  explicit c_CtrDrbg(uint64_t seed);
+  explicit c_CtrDrbg(const DrbgSeed &seed_material, bool is_deterministic);
+
+  void generate(std::span<uint8_t> output);
+  void reseed(const DrbgSeed &entropy);
+
+  bool is_deterministic() const { return m_is_deterministic; }
+
+private:
+  void generate_step(std::span<uint8_t> output);
+  void update(const DrbgSeed &provided_data);
+  void increment_counter();
+
+  AES128KeySchedule m_key_schedule;
+  ByteBlock m_counter;
+  uint64_t m_reseed_counter;
+  bool m_is_deterministic;
+};
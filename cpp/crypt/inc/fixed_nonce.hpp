@@ -0,0 +1,82 @@
+#pragma once
+
+#include <analysis.hpp>
+#include <raw_bytes.hpp>
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+// Ciphertexts that share one keystream, as under CTR with a reused nonce,
+// stored a column at a time. Rows are ordered longest first, so column i is
+// byte i of the first column_depth(i) rows of m_row_order and each keystream
+// byte is solved from one contiguous run.
+struct c_KeystreamMatrix {
+  explicit c_KeystreamMatrix(std::span<const RawBytes> ciphertexts);
+
+  size_t num_rows() const { return m_row_order.size(); }
+  size_t num_columns() const { return m_column_offsets.size() - 1; }
+  // Number of ciphertexts long enough to reach column_index
+  size_t column_depth(size_t column_index) const;
+  ByteSpan column(size_t column_index) const;
+  uint8_t at(size_t row, size_t column_index) const;
+  size_t row_length(size_t row) const;
+
+  // Ciphertext indexes, longest first, ties in input order
+  std::vector<size_t> m_row_order;
+  // Where each ciphertext sits in m_row_order
+  std::vector<size_t> m_row_ranks;
+  std::vector<size_t> m_column_offsets;
+  RawBytes m_bytes;
+};
+
+// Keys per column rescored on bigrams with the neighbouring columns
+constexpr inline size_t FIXED_NONCE_RESCORED_KEYS = 4;
+
+struct c_FixedNonceConfig {
+  // Columns are independent, so each thread takes a contiguous run of them.
+  // 0 means one per core.
+  size_t m_num_threads = 0;
+  ScoreMethod m_score_method = ScoreMethod::log_likelihood;
+  // Each pass picks every column's key again from its best few, adding the
+  // bigrams it makes with the columns either side under the last pass' keys.
+  // Fixes spread a column per pass into the shallow columns at the end.
+  size_t m_num_refinement_passes = 2;
+};
+
+// One keystream byte per column. The n-grams fold case, so a column of
+// capitals, such as the first, is likely to come out in lower case; a crib
+// settles it.
+RawBytes recover_fixed_nonce_keystream(
+    const c_KeystreamMatrix &matrix,
+    const c_LanguageModel &model = english_language_model(),
+    const c_FixedNonceConfig &config = c_FixedNonceConfig());
+
+struct c_CribPlacement {
+  // Index into the ciphertexts the matrix was built from
+  size_t m_row = 0;
+  size_t m_column = 0;
+  // Bits of log likelihood the keystream the crib implies loses, over every
+  // row in the covered columns, against the best key of each column. Lower
+  // is better; 0 agrees with the statistics everywhere.
+  double m_score = 0.0;
+};
+
+// Slides crib along every ciphertext and ranks each placement by the
+// keystream bytes it implies, best first, scored on log likelihood whatever
+// the configured method. Placements implying the same bytes at the same
+// column are reported once.
+std::vector<c_CribPlacement>
+drag_crib(const c_KeystreamMatrix &matrix, ByteSpan crib,
+          size_t max_placements,
+          const c_LanguageModel &model = english_language_model(),
+          const c_FixedNonceConfig &config = c_FixedNonceConfig());
+
+// Overwrites the keystream bytes implied by crib at placement
+void apply_crib(const c_KeystreamMatrix &matrix,
+                const c_CribPlacement &placement, ByteSpan crib,
+                RawBytes &keystream);
+
+// Each ciphertext XOR keystream, cut to the length of the keystream
+std::vector<RawBytes> decrypt_fixed_nonce(std::span<const RawBytes> ciphertexts,
+                                          ByteSpan keystream);
@@ -2,6 +2,8 @@
 
 #include <raw_bytes.hpp>
 
+#include <array>
+#include <cstdint>
 #include <unordered_map>
 
 using FreqMap = std::unordered_map<char, double>;
@@ -16,6 +18,24 @@ const FreqMap english_freq_map = {
     {'j', 0.0015},    {'x', 0.0015}, {'q', 0.00095}, {'z', 0.00074},
 };
 
-FreqMap gen_frequency(const RawBytes &input);
+FreqMap gen_frequency(ByteSpan input);
 
 double score_freq(const FreqMap &input);
+
+using CandidateOrder = std::array<uint8_t, 256>;
+
+// Ranks the 256 possible values of the next plaintext byte, most likely first.
+// The prior comes from english_freq_map; it is refined by the byte transitions
+// observed so far in the recovered plaintext.
+struct c_CandidateModel {
+  c_CandidateModel(const FreqMap &freq_map = english_freq_map);
+
+  CandidateOrder order(uint8_t previous_byte) const;
+  CandidateOrder order() const;
+
+  void observe(uint8_t previous_byte, uint8_t next_byte);
+
+  std::array<double, 256> m_prior;
+  std::array<std::array<uint32_t, 256>, 256> m_transition_counts{};
+  std::array<uint32_t, 256> m_transition_totals{};
+};
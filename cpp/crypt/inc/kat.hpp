@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cipher.hpp>
+#include <raw_bytes.hpp>
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+enum class KATMode { ecb, cbc, ctr, key_expansion };
+
+enum class KATDirection { encrypt, decrypt };
+
+struct c_KATVector {
+  KATDirection m_direction = KATDirection::encrypt;
+  size_t m_count = 0;
+  RawBytes m_key;
+  // The CBC IV or the initial CTR counter block
+  RawBytes m_iv;
+  RawBytes m_plaintext;
+  RawBytes m_ciphertext;
+  // Key expansion only, every word of the key schedule in order
+  RawBytes m_expanded_key;
+};
+
+struct c_KATFile {
+  std::string m_name;
+  KATMode m_mode = KATMode::ecb;
+  std::vector<c_KATVector> m_vectors;
+};
+
+// Reads the NIST CAVS response layout of the AESAVS .rsp files: # comments,
+// [ENCRYPT] and [DECRYPT] sections, and vectors of NAME = value lines that
+// each start with COUNT. The mode comes from the start of the file name, as
+// NIST names them (ECBGFSbox128.rsp, CBCMMT256.rsp), with CTR for SP 800-38A
+// counter mode and KEYEXPANSION for key schedule tables that give each KEY
+// an EXPANDED schedule. Monte Carlo files are not supported. Throws
+// std::invalid_argument for a malformed or unsupported file.
+c_KATFile parse_kat_file(std::istream &input, const std::string &name);
+c_KATFile load_kat_file(const std::string &path);
+
+struct c_KATFailure {
+  std::string m_file_name;
+  KATDirection m_direction = KATDirection::encrypt;
+  size_t m_count = 0;
+};
+
+struct c_KATResult {
+  size_t m_num_passed = 0;
+  std::vector<c_KATFailure> m_failures;
+};
+
+// Runs every vector in file through backend, one call per vector so that the
+// multi-block paths see whole messages. Key expansion files are skipped.
+void run_kat_file(const c_CipherBackend &backend, const c_KATFile &file,
+                  c_KATResult &result);
+
+// Checks gen_key_schedule, which every built in backend starts from, against
+// a key expansion file, so it only needs to run once. Other files are
+// skipped.
+void run_kat_key_expansion_file(const c_KATFile &file, c_KATResult &result);
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <block.hpp>
+#include <cipher.hpp>
+#include <raw_bytes.hpp>
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Modes of operation over any c_BlockCipher, so that every backend gets
+// every mode. ECB and CBC add and strip PKCS#7 padding.
+RawBytes ECB_encrypt(const c_BlockCipher &cipher,
+                     const RawBytes &plaintext_raw);
+RawBytes ECB_decrypt(const c_BlockCipher &cipher,
+                     const RawBytes &ciphertext_raw);
+
+RawBytes CBC_encrypt(const c_BlockCipher &cipher, const RawBytes &plaintext_raw,
+                     const ByteBlock &iv);
+RawBytes CBC_decrypt(const c_BlockCipher &cipher,
+                     const RawBytes &ciphertext_raw, const ByteBlock &iv);
+
+// CBC over whole blocks, without padding. chain holds the IV on entry and the
+// last ciphertext block on return, so a long message can go through in
+// pieces. Encryption may run in place; decryption reads the ciphertext after
+// deciphering it, so its input and output must not overlap. Throws
+// std::invalid_argument for a partial block or a short output.
+void CBC_encrypt_blocks(const c_BlockCipher &cipher, ByteBlock &chain,
+                        ByteSpan input, std::span<uint8_t> output);
+void CBC_decrypt_blocks(const c_BlockCipher &cipher, ByteBlock &chain,
+                        ByteSpan input, std::span<uint8_t> output);
+
+// CBC encrypts many independent messages, one IV each, on a c_ChainSchedule
+std::vector<RawBytes> CBC_encrypt_streams(const c_BlockCipher &cipher,
+                                          std::span<const RawBytes> plaintexts,
+                                          std::span<const ByteBlock> ivs);
+
+// Keystream blocks generated per call to the cipher in CTR and GCM
+constexpr inline size_t CTR_BATCH_BLOCKS = 32;
+
+// SP 800-38A counter mode, with the counter block incremented as a 128 bit
+// big-endian integer. Encryption and decryption are the same operation, and
+// input and output may be the same buffer.
+void CTR_crypt(const c_BlockCipher &cipher, const ByteBlock &initial_counter,
+               ByteSpan input, std::span<uint8_t> output);
+RawBytes CTR_crypt(const c_BlockCipher &cipher,
+                   const ByteBlock &initial_counter, const RawBytes &input);
+
+constexpr inline size_t GCM_IV_LENGTH_BYTES = 12;
+constexpr inline size_t GCM_TAG_LENGTH_BYTES = BLOCK_SIZE_BYTES;
+
+// SP 800-38D Galois/Counter Mode with a full length tag. Any IV length is
+// accepted, 12 bytes is the fast path.
+RawBytes GCM_encrypt(const c_BlockCipher &cipher, ByteSpan iv, ByteSpan aad,
+                     ByteSpan plaintext, ByteBlock &tag);
+// Leaves plaintext empty and returns false when the tag does not match
+bool GCM_decrypt(const c_BlockCipher &cipher, ByteSpan iv, ByteSpan aad,
+                 ByteSpan ciphertext, const ByteBlock &tag,
+                 RawBytes &plaintext);
@@ -0,0 +1,290 @@
+#pragma once
+
+#include <aes.hpp>
+#include <arena.hpp>
+#include <raw_bytes.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <concepts>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <memory_resource>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// An oracle answers attacker queries. query_batch lets an attack submit many
+// independent queries in one round trip.
+template <typename OracleType, typename ResponseType = RawBytes>
+concept Oracle = requires(OracleType &oracle, ByteSpan input,
+                          std::span<const ByteSpan> inputs) {
+  { oracle.query(input) } -> std::convertible_to<ResponseType>;
+  {
+    oracle.query_batch(inputs)
+  } -> std::convertible_to<std::vector<ResponseType>>;
+};
+
+// An oracle that can also answer into buffers from a memory resource, so an
+// attack can keep the responses in its scratch arena.
+template <typename OracleType>
+concept ScratchOracle =
+    Oracle<OracleType> && requires(OracleType &oracle,
+                                   std::span<const ByteSpan> inputs,
+                                   std::pmr::memory_resource *resource) {
+      {
+        oracle.query_batch(inputs, resource)
+      } -> std::convertible_to<ScratchVector<ScratchBytes>>;
+    };
+
+// Answers are copied over when the oracle can only return RawBytes.
+template <Oracle OracleType>
+ScratchVector<ScratchBytes> query_batch_scratch(
+    OracleType &oracle, std::span<const ByteSpan> inputs,
+    std::pmr::memory_resource *resource = scratch_resource()) {
+  if constexpr (ScratchOracle<OracleType>) {
+    return oracle.query_batch(inputs, resource);
+  } else {
+    ScratchVector<ScratchBytes> outputs(resource);
+    outputs.reserve(inputs.size());
+    for (const RawBytes &output : oracle.query_batch(inputs)) {
+      outputs.emplace_back(std::begin(output), std::end(output));
+    }
+    return outputs;
+  }
+}
+
+constexpr inline size_t LATENCY_HISTOGRAM_NUM_BUCKETS = 64;
+
+// Bucket n counts latencies in [2^(n-1), 2^n) nanoseconds.
+struct c_LatencyHistogram {
+  void record(std::chrono::nanoseconds latency);
+  uint64_t count() const;
+  std::chrono::nanoseconds percentile(double fraction) const;
+  void reset();
+
+  std::array<std::atomic<uint64_t>, LATENCY_HISTOGRAM_NUM_BUCKETS> m_buckets{};
+};
+
+std::ostream &operator<<(std::ostream &out,
+                         const c_LatencyHistogram &histogram);
+
+struct c_OracleStats {
+  void record(size_t num_calls, size_t bytes_in, size_t bytes_out,
+              std::chrono::nanoseconds latency);
+  void reset();
+
+  // Individual queries, whether or not they arrived in a batch.
+  std::atomic<size_t> m_num_calls{0};
+  // Invocations of query or query_batch.
+  std::atomic<size_t> m_num_round_trips{0};
+  std::atomic<size_t> m_bytes_in{0};
+  std::atomic<size_t> m_bytes_out{0};
+  // Latency of each round trip.
+  c_LatencyHistogram m_latency;
+};
+
+std::ostream &operator<<(std::ostream &out, const c_OracleStats &stats);
+
+// Wraps any callable taking a ByteSpan. Batches are answered one query at a
+// time.
+template <typename QueryFuncType> struct c_CountingOracle {
+  using ResponseType = std::invoke_result_t<QueryFuncType &, ByteSpan>;
+
+  c_CountingOracle(QueryFuncType query_func)
+      : m_query_func(std::move(query_func)) {}
+
+  ResponseType query(ByteSpan input) {
+    const auto begin = std::chrono::steady_clock::now();
+    ResponseType output = m_query_func(input);
+    m_stats.record(1, input.size(), response_size(output),
+                   std::chrono::steady_clock::now() - begin);
+    return output;
+  }
+
+  std::vector<ResponseType> query_batch(std::span<const ByteSpan> inputs) {
+    const auto begin = std::chrono::steady_clock::now();
+    std::vector<ResponseType> outputs;
+    outputs.reserve(inputs.size());
+    size_t bytes_in = 0;
+    size_t bytes_out = 0;
+    for (const ByteSpan &input : inputs) {
+      outputs.push_back(m_query_func(input));
+      bytes_in += input.size();
+      bytes_out += response_size(outputs.back());
+    }
+    m_stats.record(inputs.size(), bytes_in, bytes_out,
+                   std::chrono::steady_clock::now() - begin);
+    return outputs;
+  }
+
+  static size_t response_size(const ResponseType &output) {
+    if constexpr (std::is_same_v<ResponseType, RawBytes>) {
+      return output.size();
+    } else {
+      return sizeof(ResponseType);
+    }
+  }
+
+  QueryFuncType m_query_func;
+  c_OracleStats m_stats;
+};
+
+// Answers ECB(secret prefix || input || secret suffix), where the prefix is
+// empty unless given. A batch is padded into one contiguous run of blocks and
+// pushed through the multi-block kernel in a single call.
+template <typename EncrypterType> struct c_ECBSuffixOracle {
+  c_ECBSuffixOracle(const EncrypterType &encrypter,
+                    const RawBytes &secret_suffix_raw)
+      : c_ECBSuffixOracle(encrypter, RawBytes(), secret_suffix_raw) {}
+
+  c_ECBSuffixOracle(const EncrypterType &encrypter,
+                    const RawBytes &secret_prefix_raw,
+                    const RawBytes &secret_suffix_raw)
+      : m_encrypter(encrypter)
+      , m_secret_prefix_raw(secret_prefix_raw)
+      , m_secret_suffix_raw(secret_suffix_raw) {}
+
+  RawBytes query(ByteSpan input) {
+    return std::move(query_batch(std::span{&input, 1}).front());
+  }
+
+  std::vector<RawBytes> query_batch(std::span<const ByteSpan> inputs) {
+    c_ScratchScope scope;
+    std::vector<RawBytes> outputs;
+    answer_batch(inputs, outputs);
+    return outputs;
+  }
+
+  // The staging blocks are left in the scratch arena until the caller's
+  // scope closes
+  ScratchVector<ScratchBytes> query_batch(std::span<const ByteSpan> inputs,
+                                          std::pmr::memory_resource *resource) {
+    ScratchVector<ScratchBytes> outputs(resource);
+    answer_batch(inputs, outputs);
+    return outputs;
+  }
+
+  const EncrypterType &m_encrypter;
+  const RawBytes m_secret_prefix_raw;
+  const RawBytes m_secret_suffix_raw;
+  c_OracleStats m_stats;
+
+private:
+  template <typename OutputsType>
+  void answer_batch(std::span<const ByteSpan> inputs, OutputsType &outputs) {
+    const auto begin = std::chrono::steady_clock::now();
+
+    ScratchVector<size_t> block_offsets(scratch_resource());
+    block_offsets.reserve(inputs.size() + 1);
+    size_t num_blocks = 0;
+    size_t bytes_in = 0;
+    const size_t secret_length =
+        m_secret_prefix_raw.size() + m_secret_suffix_raw.size();
+    for (const ByteSpan &input : inputs) {
+      block_offsets.push_back(num_blocks);
+      num_blocks +=
+          pkcs7_padded_length(input.size() + secret_length) / BLOCK_SIZE_BYTES;
+      bytes_in += input.size();
+    }
+    block_offsets.push_back(num_blocks);
+
+    ScratchVector<ByteBlock> plaintexts(num_blocks, scratch_resource());
+    ScratchVector<ByteBlock> ciphertexts(num_blocks, scratch_resource());
+    for (size_t input_index = 0; input_index < inputs.size(); ++input_index) {
+      const ByteSpan input = inputs[input_index];
+      uint8_t *plaintext =
+          reinterpret_cast<uint8_t *>(&plaintexts[block_offsets[input_index]]);
+      const size_t padded_length =
+          (block_offsets[input_index + 1] - block_offsets[input_index]) *
+          BLOCK_SIZE_BYTES;
+      const size_t length = input.size() + secret_length;
+      std::memcpy(plaintext, m_secret_prefix_raw.data(),
+                  m_secret_prefix_raw.size());
+      std::memcpy(plaintext + m_secret_prefix_raw.size(), input.data(),
+                  input.size());
+      std::memcpy(plaintext + m_secret_prefix_raw.size() + input.size(),
+                  m_secret_suffix_raw.data(), m_secret_suffix_raw.size());
+      pad_pkcs7_in_place(std::span{plaintext, padded_length}, length);
+    }
+
+    m_encrypter.encrypt(plaintexts, ciphertexts);
+
+    outputs.reserve(inputs.size());
+    size_t bytes_out = 0;
+    for (size_t input_index = 0; input_index < inputs.size(); ++input_index) {
+      const uint8_t *ciphertext = reinterpret_cast<const uint8_t *>(
+          &ciphertexts[block_offsets[input_index]]);
+      const size_t length =
+          (block_offsets[input_index + 1] - block_offsets[input_index]) *
+          BLOCK_SIZE_BYTES;
+      outputs.emplace_back(ciphertext, ciphertext + length);
+      bytes_out += length;
+    }
+    m_stats.record(inputs.size(), bytes_in, bytes_out,
+                   std::chrono::steady_clock::now() - begin);
+  }
+};
+
+constexpr inline size_t MAX_RANDOM_PREFIX_LENGTH_BYTES = 64;
+
+// Random bytes, as many as generate_in_range picks from [0, max_length_bytes]
+RawBytes gen_random_prefix(size_t max_length_bytes);
+
+// As c_ECBSuffixOracle, behind a random prefix drawn once at construction
+template <typename EncrypterType>
+struct c_ECBRandomPrefixOracle : public c_ECBSuffixOracle<EncrypterType> {
+  c_ECBRandomPrefixOracle(
+      const EncrypterType &encrypter, const RawBytes &secret_suffix_raw,
+      const size_t max_prefix_length_bytes = MAX_RANDOM_PREFIX_LENGTH_BYTES)
+      : c_ECBSuffixOracle<EncrypterType>(
+            encrypter, gen_random_prefix(max_prefix_length_bytes),
+            secret_suffix_raw) {}
+};
+
+// Answers whether IV || ciphertext decrypts under CBC to a plaintext with
+// valid PKCS#7 padding.
+template <typename EncrypterType> struct c_CBCPaddingOracle {
+  c_CBCPaddingOracle(const EncrypterType &encrypter)
+      : m_encrypter(encrypter) {}
+
+  bool query(ByteSpan input) {
+    const auto begin = std::chrono::steady_clock::now();
+    const bool output = is_valid(input);
+    m_stats.record(1, input.size(), sizeof(bool),
+                   std::chrono::steady_clock::now() - begin);
+    return output;
+  }
+
+  std::vector<bool> query_batch(std::span<const ByteSpan> inputs) {
+    const auto begin = std::chrono::steady_clock::now();
+    std::vector<bool> outputs;
+    outputs.reserve(inputs.size());
+    size_t bytes_in = 0;
+    for (const ByteSpan &input : inputs) {
+      outputs.push_back(is_valid(input));
+      bytes_in += input.size();
+    }
+    m_stats.record(inputs.size(), bytes_in, inputs.size() * sizeof(bool),
+                   std::chrono::steady_clock::now() - begin);
+    return outputs;
+  }
+
+  bool is_valid(ByteSpan input) const {
+    if (input.size() < 2 * BLOCK_SIZE_BYTES ||
+        input.size() % BLOCK_SIZE_BYTES != 0) {
+      return false;
+    }
+    const ByteBlock iv = from_raw_bytes_to_byte_block(input, 0);
+    const RawBytes plaintext_raw =
+        AES_CBC_decrypt_padded(input.subspan(BLOCK_SIZE_BYTES),
+                               m_encrypter.m_decryption_key_schedule, iv);
+    return validate_pkcs7_padding(plaintext_raw);
+  }
+
+  const EncrypterType &m_encrypter;
+  c_OracleStats m_stats;
+};
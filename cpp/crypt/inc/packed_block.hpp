@@ -0,0 +1,185 @@
+#pragma once
+
+#include <block.hpp>
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+
+static_assert(sizeof(ByteBlock) == BLOCK_SIZE_BYTES,
+              "ByteBlock must be 16 contiguous bytes");
+
+// A block held in one SSE register where available, otherwise as two 64 bit
+// halves. Byte i of the block is byte i in memory, the same order as
+// ByteBlock and raw bytes, so conversion is a single 16 byte load or store.
+struct alignas(BLOCK_SIZE_BYTES) c_PackedBlock {
+#if defined(__SSE2__)
+  __m128i m_data;
+#else
+  std::array<uint64_t, 2> m_data;
+#endif
+};
+
+inline c_PackedBlock load_block(const uint8_t *input) {
+#if defined(__SSE2__)
+  return {_mm_loadu_si128(reinterpret_cast<const __m128i *>(input))};
+#else
+  c_PackedBlock output;
+  std::memcpy(output.m_data.data(), input, BLOCK_SIZE_BYTES);
+  return output;
+#endif
+}
+
+inline void store_block(const c_PackedBlock &input, uint8_t *output) {
+#if defined(__SSE2__)
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(output), input.m_data);
+#else
+  std::memcpy(output, input.m_data.data(), BLOCK_SIZE_BYTES);
+#endif
+}
+
+inline c_PackedBlock load_block(const ByteBlock &input) {
+  return load_block(reinterpret_cast<const uint8_t *>(&input));
+}
+
+inline ByteBlock to_byte_block(const c_PackedBlock &input) {
+  ByteBlock output;
+  store_block(input, reinterpret_cast<uint8_t *>(&output));
+  return output;
+}
+
+inline c_PackedBlock &operator^=(c_PackedBlock &input_a,
+                                 const c_PackedBlock &input_b) {
+#if defined(__SSE2__)
+  input_a.m_data = _mm_xor_si128(input_a.m_data, input_b.m_data);
+#else
+  input_a.m_data[0] ^= input_b.m_data[0];
+  input_a.m_data[1] ^= input_b.m_data[1];
+#endif
+  return input_a;
+}
+
+inline c_PackedBlock operator^(c_PackedBlock input_a,
+                               const c_PackedBlock &input_b) {
+  return input_a ^= input_b;
+}
+
+// Byte j of the output is byte PERMUTATION[j] of the input
+using BlockPermutation = std::array<uint8_t, BLOCK_SIZE_BYTES>;
+
+// Row r of column c moves to column c - r
+constexpr inline BlockPermutation SHIFT_ROWS_PERMUTATION = {
+    0, 5, 10, 15, 4, 9, 14, 3, 8, 13, 2, 7, 12, 1, 6, 11};
+constexpr inline BlockPermutation INV_SHIFT_ROWS_PERMUTATION = {
+    0, 13, 10, 7, 4, 1, 14, 11, 8, 5, 2, 15, 12, 9, 6, 3};
+
+inline void permute_bytes(c_PackedBlock &input,
+                          const BlockPermutation &permutation) {
+#if defined(__SSSE3__)
+  const __m128i mask =
+      _mm_loadu_si128(reinterpret_cast<const __m128i *>(permutation.data()));
+  input.m_data = _mm_shuffle_epi8(input.m_data, mask);
+#else
+  std::array<uint8_t, BLOCK_SIZE_BYTES> bytes;
+  std::array<uint8_t, BLOCK_SIZE_BYTES> output;
+  store_block(input, bytes.data());
+  for (size_t byte_index = 0; byte_index < BLOCK_SIZE_BYTES; ++byte_index) {
+    output[byte_index] = bytes[permutation[byte_index]];
+  }
+  input = load_block(output.data());
+#endif
+}
+
+inline void shift_rows(c_PackedBlock &input) {
+  permute_bytes(input, SHIFT_ROWS_PERMUTATION);
+}
+
+inline void inv_shift_rows(c_PackedBlock &input) {
+  permute_bytes(input, INV_SHIFT_ROWS_PERMUTATION);
+}
+
+void sub_bytes(c_PackedBlock &);
+void inv_sub_bytes(c_PackedBlock &);
+
+// Multiplies every byte by x (0x02) in GF(2^8)
+inline c_PackedBlock xtime(const c_PackedBlock &input) {
+#if defined(__SSE2__)
+  // Bytes with the top bit set compare less than zero and get 0x1b
+  const __m128i reduce = _mm_and_si128(
+      _mm_cmplt_epi8(input.m_data, _mm_setzero_si128()), _mm_set1_epi8(0x1b));
+  return {_mm_xor_si128(_mm_add_epi8(input.m_data, input.m_data), reduce)};
+#else
+  c_PackedBlock output;
+  for (size_t half = 0; half < input.m_data.size(); ++half) {
+    const uint64_t value = input.m_data[half];
+    const uint64_t high_bits = (value >> 7) & 0x0101010101010101;
+    output.m_data[half] =
+        ((value & 0x7f7f7f7f7f7f7f7f) << 1) ^ (high_bits * 0x1b);
+  }
+  return output;
+#endif
+}
+
+// Byte r of every column takes byte r + NumBytes of the same column
+template <size_t NumBytes>
+c_PackedBlock rotate_columns(const c_PackedBlock &input) {
+  constexpr int SHIFT_BITS = 8 * NumBytes;
+#if defined(__SSE2__)
+  return {_mm_or_si128(_mm_srli_epi32(input.m_data, SHIFT_BITS),
+                       _mm_slli_epi32(input.m_data, 32 - SHIFT_BITS))};
+#else
+  constexpr uint64_t LOW_MASK = (uint64_t(0xffffffff) >> SHIFT_BITS) *
+                                uint64_t(0x0000000100000001);
+  c_PackedBlock output;
+  for (size_t half = 0; half < input.m_data.size(); ++half) {
+    const uint64_t value = input.m_data[half];
+    output.m_data[half] = ((value >> SHIFT_BITS) & LOW_MASK) |
+                          ((value << (32 - SHIFT_BITS)) & ~LOW_MASK);
+  }
+  return output;
+#endif
+}
+
+// MixColumns on all four columns at once, with no tables. For each column,
+// b_r = a_r ^ t ^ xtime(a_r ^ a_r+1), where t is the XOR of the column.
+inline void mix_columns_xtime(c_PackedBlock &input) {
+  const c_PackedBlock rotated_1 = rotate_columns<1>(input);
+  const c_PackedBlock column_sum =
+      input ^ rotated_1 ^ rotate_columns<2>(input) ^ rotate_columns<3>(input);
+  input ^= column_sum ^ xtime(input ^ rotated_1);
+}
+
+// InvMixColumns is MixColumns after multiplying each column by
+// {04 00 05 00}, which only needs a_r ^= xtime(xtime(a_r ^ a_r+2))
+inline void inv_mix_columns_xtime(c_PackedBlock &input) {
+  input ^= xtime(xtime(input ^ rotate_columns<2>(input)));
+  mix_columns_xtime(input);
+}
+
+// The GF(2^8) multiplication table versions
+void mix_columns_tables(c_PackedBlock &);
+void inv_mix_columns_tables(c_PackedBlock &);
+
+// Build with CRYPT_MIX_COLUMNS_TABLES to use the tables in the cipher
+inline void mix_columns(c_PackedBlock &input) {
+#if defined(CRYPT_MIX_COLUMNS_TABLES)
+  mix_columns_tables(input);
+#else
+  mix_columns_xtime(input);
+#endif
+}
+
+inline void inv_mix_columns(c_PackedBlock &input) {
+#if defined(CRYPT_MIX_COLUMNS_TABLES)
+  inv_mix_columns_tables(input);
+#else
+  inv_mix_columns_xtime(input);
+#endif
+}
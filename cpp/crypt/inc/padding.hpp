@@ -0,0 +1,35 @@
+#pragma once
+
+#include <block.hpp>
+#include <raw_bytes.hpp>
+
+#include <cstdint>
+#include <span>
+
+size_t pkcs7_padded_length(size_t length,
+                           size_t block_size_bytes = BLOCK_SIZE_BYTES);
+
+// Writes the padding for the first length bytes of buffer in place and
+// returns the padded length. buffer must hold pkcs7_padded_length(length).
+size_t pad_pkcs7_in_place(std::span<uint8_t> buffer, size_t length,
+                          size_t block_size_bytes = BLOCK_SIZE_BYTES);
+
+RawBytes add_pkcs7_padding(const RawBytes &input,
+                           size_t block_size_bytes = BLOCK_SIZE_BYTES);
+
+// Checks every byte of the final block without branching on their values, so
+// the time taken does not depend on the padding.
+bool validate_pkcs7_padding(ByteSpan input, size_t block_size_bytes,
+                            size_t &unpadded_length);
+
+bool validate_pkcs7_padding(ByteSpan input,
+                            size_t block_size_bytes = BLOCK_SIZE_BYTES);
+
+// Returns a view of input without its padding. Throws std::invalid_argument
+// if the padding does not validate.
+ByteSpan strip_pkcs7_padding(ByteSpan input,
+                             size_t block_size_bytes = BLOCK_SIZE_BYTES);
+
+// As strip_pkcs7_padding, but returns a copy.
+RawBytes remove_pkcs7_padding(const RawBytes &input,
+                              size_t block_size_bytes = BLOCK_SIZE_BYTES);
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <arena.hpp>
+
+#include <cstddef>
+#include <future>
+#include <memory_resource>
+#include <vector>
+
+// Workers for num_items independent items when num_threads are asked for,
+// where 0 means one per core. Never more workers than items, never fewer
+// than one.
+size_t get_num_workers(size_t num_threads, size_t num_items);
+
+// Calls function(worker_index) once per worker and waits for them all. A
+// single worker runs on the calling thread. Workers use the caller's scratch
+// resource override, if it has one. Rethrows the first exception in worker
+// order.
+template <typename Function>
+void for_each_worker(const size_t num_workers, Function &&function) {
+  const auto launch_policy =
+      (num_workers > 1) ? std::launch::async : std::launch::deferred;
+  std::pmr::memory_resource *const resource = scratch_resource_override();
+  std::vector<std::future<void>> workers;
+  workers.reserve(num_workers);
+  for (size_t worker_index = 0; worker_index < num_workers; ++worker_index) {
+    workers.push_back(
+        std::async(launch_policy, [&function, resource, worker_index]() {
+          const c_ScratchResourceScope scope(resource);
+          function(worker_index);
+        }));
+  }
+  for (auto &worker : workers) {
+    worker.get();
+  }
+}
+
+// Splits [0, num_items) into contiguous runs, one per worker, and calls
+// function(begin, end) for each
+template <typename Function>
+void for_each_run(const size_t num_items, const size_t num_threads,
+                  Function &&function) {
+  const size_t num_workers = get_num_workers(num_threads, num_items);
+  for_each_worker(num_workers, [&function, num_items,
+                                num_workers](const size_t worker_index) {
+    function((num_items * worker_index) / num_workers,
+             (num_items * (worker_index + 1)) / num_workers);
+  });
+}
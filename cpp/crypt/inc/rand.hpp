@@ -4,31 +4,51 @@
 #include <raw_bytes.hpp>
 
 #include <cstdint>
-#include <random>
+#include <memory>
+#include <span>
+
+struct c_CtrDrbg;
+
+// Small requests are served from a per-thread buffer of generator output
+constexpr inline size_t RANDOM_BUFFER_SIZE_BYTES = 512;
+
+// Fills output from the calling thread's CSPRNG. Each thread owns its own
+// generator, so concurrent callers never share state.
+void fill_random_bytes(std::span<uint8_t> output);
+
+// Makes the calling thread's stream deterministic, for reproducible runs
+void seed_thread_random(uint64_t seed);
+// Returns the calling thread's stream to OS entropy
+void reseed_thread_random();
 
 struct c_RandomByteGenerator {
+  // Draws from the calling thread's generator
+  c_RandomByteGenerator();
+  // Owns a deterministic generator with the given seed
+  explicit c_RandomByteGenerator(uint64_t seed);
+  c_RandomByteGenerator(c_RandomByteGenerator &&);
+  c_RandomByteGenerator &operator=(c_RandomByteGenerator &&);
+  ~c_RandomByteGenerator();
+
+  void fill(std::span<uint8_t> output);
+
   RawBytes generate_n_random_bytes(const size_t num_bytes) {
-    RawBytes output(num_bytes, 0);
-    for (auto &nth_byte : output) {
-      nth_byte = generate_random_byte();
-    }
+    RawBytes output(num_bytes);
+    fill(output);
     return output;
   }
 
   Word generate_random_word() {
     Word output;
-    for (auto &nth_byte : output) {
-      nth_byte = generate_random_byte();
-    }
+    fill(output);
     return output;
   }
 
   template <size_t WordArrayLength>
   WordArray<WordArrayLength> generate_random_word_array() {
     WordArray<WordArrayLength> output;
-    for (auto &word : output) {
-      word = generate_random_word();
-    }
+    fill(std::span{reinterpret_cast<uint8_t *>(output.data()),
+                   WordArrayLength * WORD_SIZE_BYTES});
     return output;
   }
 
@@ -36,14 +56,15 @@ struct c_RandomByteGenerator {
     return generate_random_word_array<BLOCK_SIZE_WORDS>();
   }
 
-  uint8_t generate_random_byte() { return m_ByteGenerator(m_RandomEngine); }
-
-  size_t generate_in_range(const size_t begin, const size_t end_inclusive) {
-    std::uniform_int_distribution<size_t> dist(begin, end_inclusive);
-    return dist(m_RandomEngine);
+  uint8_t generate_random_byte() {
+    uint8_t output;
+    fill(std::span{&output, 1});
+    return output;
   }
 
+  // Uniform, without modulo bias
+  size_t generate_in_range(size_t begin, size_t end_inclusive);
+
 private:
-  std::mt19937 m_RandomEngine;
-  std::uniform_int_distribution<uint8_t> m_ByteGenerator;
+  std::unique_ptr<c_CtrDrbg> m_drbg;
 };
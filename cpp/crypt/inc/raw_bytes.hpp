@@ -4,10 +4,12 @@
 
 #include <cstdint>
 #include <iosfwd>
+#include <span>
 #include <string>
 #include <vector>
 
 using RawBytes = std::vector<uint8_t>;
+using ByteSpan = std::span<const uint8_t>;
 
 RawBytes from_hex_string(const std::string &input);
 
@@ -40,6 +42,25 @@ RawBytes from_base64_string(const std::string &input);
 
 RawBytes prepend_bytes(const RawBytes &original, const RawBytes &prefix);
 
+// Keys shorter than this are unrolled into a pattern a whole number of
+// vector registers long; longer ones are XORed straight from the key.
+constexpr inline size_t REPEATING_XOR_MAX_PATTERN_KEY_BYTES = 256;
+
+// output ^= input. Throws std::length_error unless the lengths match.
+void xor_in_place(std::span<uint8_t> output, ByteSpan input);
+
+void xor_in_place(std::span<uint8_t> output, uint8_t key);
+
+// Cycles key over output, starting key_offset bytes into the key, so a long
+// buffer can be XORed in pieces. Throws std::length_error on an empty key.
+void xor_repeating_in_place(std::span<uint8_t> output, ByteSpan key,
+                            size_t key_offset = 0);
+
+RawBytes &operator^=(RawBytes &output, ByteSpan input);
+
+RawBytes &operator^=(RawBytes &output, uint8_t key);
+
+// Throws std::length_error unless the lengths match
 RawBytes operator^(const RawBytes &input_1, const RawBytes &input_2);
 
 RawBytes operator^(const RawBytes &input, uint8_t key);
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <aes.hpp>
+#include <cookie.hpp>
+#include <raw_bytes.hpp>
+
+#include <string_view>
+
+// Issues and checks profile tokens, the ECB encryption of a "user" profile
+// cookie. The key schedule is expanded once, tokens are written straight into
+// the caller's buffer and decrypted into per-thread scratch, so steady state
+// calls only allocate for the strings they return.
+struct c_TokenService {
+  c_TokenService()
+      : m_encrypter(gen_rand_key<AES128Key>()) {}
+
+  c_TokenService(const RawBytes &key_raw)
+      : m_encrypter(key_raw) {}
+
+  // Reuses the capacity of token
+  void issue_token(std::string_view email, RawBytes &token) const;
+  RawBytes issue_token(std::string_view email) const;
+
+  CookieError verify_token(ByteSpan token, c_ProfileCookie &output) const;
+
+  const c_AES128Encrypter m_encrypter;
+};
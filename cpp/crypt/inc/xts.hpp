@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cipher.hpp>
+#include <raw_bytes.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string_view>
+
+constexpr inline size_t XTS_AES_128_KEY_LENGTH_BYTES = 32;
+constexpr inline size_t XTS_AES_256_KEY_LENGTH_BYTES = 64;
+
+// Tweaks computed and blocks ciphered per call to the backend
+constexpr inline size_t XTS_BATCH_BLOCKS = 32;
+
+// IEEE 1619 XTS-AES for sector addressed storage. The key is the data key
+// followed by the tweak key, so 32 bytes for XTS-AES-128 and 64 for
+// XTS-AES-256. Sector i is tweaked by i as a 128 bit little-endian integer.
+// A sector is at least one block, and one that is not a whole number of
+// blocks is handled with ciphertext stealing.
+struct c_XTSCipher {
+  // Uses the default cipher backend
+  c_XTSCipher(const RawBytes &key_raw);
+  c_XTSCipher(std::string_view backend_name, const RawBytes &key_raw);
+
+  void encrypt_sector(uint64_t sector_number, ByteSpan input,
+                      std::span<uint8_t> output) const;
+  void decrypt_sector(uint64_t sector_number, ByteSpan input,
+                      std::span<uint8_t> output) const;
+
+  // Consecutive sectors of sector_size bytes from first_sector on, split
+  // across num_threads, where 0 means one per core. input must be a whole
+  // number of sectors and may be the same buffer as output.
+  void encrypt_sectors(uint64_t first_sector, size_t sector_size,
+                       ByteSpan input, std::span<uint8_t> output,
+                       size_t num_threads = 0) const;
+  void decrypt_sectors(uint64_t first_sector, size_t sector_size,
+                       ByteSpan input, std::span<uint8_t> output,
+                       size_t num_threads = 0) const;
+
+  std::unique_ptr<c_BlockCipher> m_data_cipher;
+  std::unique_ptr<c_BlockCipher> m_tweak_cipher;
+
+private:
+  void crypt_sector(bool is_encrypt, uint64_t sector_number, ByteSpan input,
+                    std::span<uint8_t> output) const;
+  void crypt_sectors(bool is_encrypt, uint64_t first_sector,
+                     size_t sector_size, ByteSpan input,
+                     std::span<uint8_t> output, size_t num_threads) const;
+};
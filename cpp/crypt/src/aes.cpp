@@ -181,65 +181,6 @@ RawBytes AES_256_ECB_decrypt(const RawBytes &ciphertext_raw,
                                             aes_256_key_schedule);
 }
 
-RawBytes add_pkcs7_padding(const RawBytes &input,
-                           const size_t block_size_bytes) {
-  const size_t length = input.size();
-  const size_t additional_bytes =
-      block_size_bytes - (length % block_size_bytes);
-  uint8_t padding_byte = uint8_t(additional_bytes);
-  if (additional_bytes == block_size_bytes) {
-    padding_byte = 0;
-  }
-  RawBytes output(length + additional_bytes, padding_byte);
-  std::copy(std::begin(input), std::end(input), std::begin(output));
-  return output;
-}
-
-RawBytes remove_pkcs7_padding(const RawBytes &input,
-                              const size_t block_size_bytes) {
-  const size_t length = input.size();
-  const size_t last_byte = size_t(input.back());
-  const size_t bytes_to_remove = last_byte == 0 ? block_size_bytes : last_byte;
-
-  RawBytes output(input);
-  output.resize(length - bytes_to_remove);
-  return output;
-}
-
-template <typename KeyScheduleType>
-RawBytes AES_CBC_encrypt(const RawBytes &plaintext_raw,
-                         const KeyScheduleType &key_schedule,
-                         const ByteBlock &iv) {
-  RawBytes plaintext_padded_raw =
-      add_pkcs7_padding(plaintext_raw, BLOCK_SIZE_BYTES);
-  RawBytes ciphertext_raw(plaintext_padded_raw.size());
-
-  const size_t num_blocks =
-      std::ceil<size_t>(double(plaintext_padded_raw.size()) / BLOCK_SIZE_BYTES);
-  ByteBlock last_ciphertext = iv;
-  ;
-  for (size_t block_index = 0; block_index < num_blocks; ++block_index) {
-    ByteBlock plaintext =
-        from_raw_bytes_to_byte_block(plaintext_padded_raw, block_index);
-    plaintext = plaintext ^ last_ciphertext;
-    ByteBlock ciphertext;
-    AES_cipher(plaintext, ciphertext, key_schedule);
-
-    last_ciphertext = ciphertext;
-
-    from_byte_block_to_raw_bytes(ciphertext, ciphertext_raw, block_index);
-  }
-  return ciphertext_raw;
-}
-
-template <typename KeyScheduleType>
-RawBytes AES_CBC_encrypt(const RawBytes &plaintext_raw,
-                         const KeyScheduleType &key_schedule,
-                         const RawBytes &iv_raw) {
-  const ByteBlock iv = from_raw_bytes_to_byte_block(iv_raw);
-  return AES_CBC_encrypt<KeyScheduleType>(plaintext_raw, key_schedule, iv);
-}
-
 RawBytes AES_128_CBC_encrypt(const RawBytes &plaintext_raw,
                              const RawBytes &key_raw, const RawBytes &iv_raw) {
   const auto aes_128_key = gen_aes128_key(key_raw);
@@ -264,29 +205,6 @@ RawBytes AES_256_CBC_encrypt(const RawBytes &plaintext_raw,
                                             iv_raw);
 }
 
-template <typename KeyScheduleType>
-RawBytes AES_CBC_decrypt(const RawBytes &ciphertext_raw,
-                         const KeyScheduleType &key_schedule,
-                         const RawBytes &iv_raw) {
-  RawBytes plaintext_raw(ciphertext_raw.size());
-
-  const size_t num_blocks =
-      std::ceil<size_t>(double(ciphertext_raw.size()) / BLOCK_SIZE_BYTES);
-  ByteBlock last_ciphertext = from_raw_bytes_to_byte_block(iv_raw);
-  for (size_t block_index = 0; block_index < num_blocks; ++block_index) {
-    ByteBlock ciphertext =
-        from_raw_bytes_to_byte_block(ciphertext_raw, block_index);
-    ByteBlock plaintext;
-    AES_inv_cipher(ciphertext, plaintext, key_schedule);
-
-    plaintext = plaintext ^ last_ciphertext;
-    last_ciphertext = ciphertext;
-
-    from_byte_block_to_raw_bytes(plaintext, plaintext_raw, block_index);
-  }
-  return remove_pkcs7_padding(plaintext_raw, BLOCK_SIZE_BYTES);
-}
-
 RawBytes AES_128_CBC_decrypt(const RawBytes &ciphertext_raw,
                              const RawBytes &key_raw, const RawBytes &iv_raw) {
   const auto aes_128_key = gen_aes128_key(key_raw);
@@ -312,12 +230,7 @@ RawBytes AES_256_CBC_decrypt(const RawBytes &ciphertext_raw,
 }
 
 ByteBlock gen_rand_block() {
-  static c_RandomByteGenerator generator;
-  ByteBlock output;
-  for (auto &word : output) {
-    word = generator.generate_random_word();
-  }
-  return output;
+  return c_RandomByteGenerator().generate_random_byte_block();
 }
 
 AES128Key gen_rand_aes128_key() { return gen_rand_key<AES128Key>(); }
@@ -407,7 +320,7 @@ RawBytes AES_256_rand_CBC_encrypt(const RawBytes &plaintext_raw) {
 }
 
 RawBytes AES_128_rand_encrypt(const RawBytes &plaintext_raw) {
-  static c_RandomByteGenerator generator;
+  c_RandomByteGenerator generator;
 
   const size_t num_random_bytes = generator.generate_in_range(5, 10);
   const RawBytes prefix = generator.generate_n_random_bytes(num_random_bytes);
@@ -0,0 +1,139 @@
+#include <cipher.hpp>
+
+#include <aes.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define CRYPT_HAS_AESNI 1
+#include <wmmintrin.h>
+// Compiled for AES-NI regardless of the build flags, and only called once
+// aesni_is_supported has checked the CPU
+#define CRYPT_AESNI_TARGET __attribute__((target("aes,sse2")))
+#endif
+
+#if defined(CRYPT_HAS_AESNI)
+
+bool aesni_is_supported() { return __builtin_cpu_supports("aes"); }
+
+// The instructions take the FIPS-197 round keys as they are laid out in the
+// schedule, and aesdec expects the equivalent inverse cipher's round keys
+template <typename KeyType, typename KeyScheduleType>
+struct c_AESNICipher : public c_BlockCipher {
+  static constexpr size_t NUM_ROUNDS =
+      (std::tuple_size<KeyScheduleType>{} / BLOCK_SIZE_WORDS) - 1;
+
+  c_AESNICipher(const KeyType &key)
+      : m_key_schedule(gen_key_schedule(key))
+      , m_decryption_key_schedule(
+            gen_decryption_key_schedule(m_key_schedule)) {}
+
+  CRYPT_AESNI_TARGET
+  void encrypt_blocks(const uint8_t *input, uint8_t *output,
+                      const size_t num_blocks) const override {
+    __m128i round_keys[NUM_ROUNDS + 1];
+    for (size_t round_index = 0; round_index <= NUM_ROUNDS; ++round_index) {
+      round_keys[round_index] = load_round_key(m_key_schedule, round_index);
+    }
+    for (size_t block_index = 0; block_index < num_blocks;
+         block_index += AES_MULTI_BLOCK_LANES) {
+      const size_t num_lanes =
+          std::min(AES_MULTI_BLOCK_LANES, num_blocks - block_index);
+      const size_t offset = block_index * BLOCK_SIZE_BYTES;
+      __m128i states[AES_MULTI_BLOCK_LANES];
+
+      for (size_t lane = 0; lane < num_lanes; ++lane) {
+        states[lane] =
+            _mm_xor_si128(load_lane(input, offset, lane), round_keys[0]);
+      }
+      for (size_t round_index = 1; round_index < NUM_ROUNDS; ++round_index) {
+        for (size_t lane = 0; lane < num_lanes; ++lane) {
+          states[lane] =
+              _mm_aesenc_si128(states[lane], round_keys[round_index]);
+        }
+      }
+      for (size_t lane = 0; lane < num_lanes; ++lane) {
+        store_lane(_mm_aesenclast_si128(states[lane], round_keys[NUM_ROUNDS]),
+                   output, offset, lane);
+      }
+    }
+  }
+
+  CRYPT_AESNI_TARGET
+  void decrypt_blocks(const uint8_t *input, uint8_t *output,
+                      const size_t num_blocks) const override {
+    __m128i round_keys[NUM_ROUNDS + 1];
+    for (size_t round_index = 0; round_index <= NUM_ROUNDS; ++round_index) {
+      round_keys[round_index] = load_round_key(
+          m_decryption_key_schedule.m_round_keys, round_index);
+    }
+    for (size_t block_index = 0; block_index < num_blocks;
+         block_index += AES_MULTI_BLOCK_LANES) {
+      const size_t num_lanes =
+          std::min(AES_MULTI_BLOCK_LANES, num_blocks - block_index);
+      const size_t offset = block_index * BLOCK_SIZE_BYTES;
+      __m128i states[AES_MULTI_BLOCK_LANES];
+
+      for (size_t lane = 0; lane < num_lanes; ++lane) {
+        states[lane] = _mm_xor_si128(load_lane(input, offset, lane),
+                                     round_keys[NUM_ROUNDS]);
+      }
+      for (size_t round_index = NUM_ROUNDS - 1; round_index > 0;
+           --round_index) {
+        for (size_t lane = 0; lane < num_lanes; ++lane) {
+          states[lane] =
+              _mm_aesdec_si128(states[lane], round_keys[round_index]);
+        }
+      }
+      for (size_t lane = 0; lane < num_lanes; ++lane) {
+        store_lane(_mm_aesdeclast_si128(states[lane], round_keys[0]), output,
+                   offset, lane);
+      }
+    }
+  }
+
+  CRYPT_AESNI_TARGET
+  static __m128i load_round_key(const KeyScheduleType &key_schedule,
+                                const size_t round_index) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i *>(
+        &key_schedule[round_index * BLOCK_SIZE_WORDS]));
+  }
+
+  CRYPT_AESNI_TARGET
+  static __m128i load_lane(const uint8_t *input, const size_t offset,
+                           const size_t lane) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i *>(
+        input + offset + (lane * BLOCK_SIZE_BYTES)));
+  }
+
+  CRYPT_AESNI_TARGET
+  static void store_lane(const __m128i state, uint8_t *output,
+                         const size_t offset, const size_t lane) {
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(
+                         output + offset + (lane * BLOCK_SIZE_BYTES)),
+                     state);
+  }
+
+  const KeyScheduleType m_key_schedule;
+  const c_DecryptionKeySchedule<KeyScheduleType> m_decryption_key_schedule;
+};
+
+std::unique_ptr<c_BlockCipher> make_aesni_cipher(const RawBytes &key_raw) {
+  if (!aesni_is_supported()) {
+    throw std::runtime_error("This CPU does not support AES-NI!");
+  }
+  return make_aes_cipher<c_AESNICipher>(key_raw);
+}
+
+#else
+
+bool aesni_is_supported() { return false; }
+
+std::unique_ptr<c_BlockCipher> make_aesni_cipher(const RawBytes &) {
+  throw std::runtime_error("AES-NI is only available on x86!");
+}
+
+#endif
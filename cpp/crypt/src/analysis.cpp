@@ -0,0 +1,334 @@
+#include <analysis.hpp>
+
+#include <freq_map.hpp>
+#include <raw_bytes.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+constexpr size_t HISTOGRAM_LANES = 4;
+constexpr size_t HISTOGRAM_CHUNK_BYTES = size_t(1) << 30;
+// Bytes the frequency map gives no weight, such as control characters
+constexpr double BYTE_PROBABILITY_FLOOR = 1e-6;
+// Add-alpha smoothing for counts trained on a corpus
+constexpr double CORPUS_SMOOTHING = 0.5;
+
+// Public domain prose, enough to give the n-gram tables the shape of English
+static constexpr std::string_view ENGLISH_CORPUS =
+    "It was the best of times, it was the worst of times, it was the age of "
+    "wisdom, it was the age of foolishness, it was the epoch of belief, it "
+    "was the epoch of incredulity, it was the season of Light, it was the "
+    "season of Darkness, it was the spring of hope, it was the winter of "
+    "despair, we had everything before us, we had nothing before us, we were "
+    "all going direct to Heaven, we were all going direct the other way. "
+    "It is a truth universally acknowledged, that a single man in possession "
+    "of a good fortune, must be in want of a wife. However little known the "
+    "feelings or views of such a man may be on his first entering a "
+    "neighbourhood, this truth is so well fixed in the minds of the "
+    "surrounding families, that he is considered the rightful property of "
+    "some one or other of their daughters.\n"
+    "Four score and seven years ago our fathers brought forth on this "
+    "continent, a new nation, conceived in Liberty, and dedicated to the "
+    "proposition that all men are created equal. Now we are engaged in a "
+    "great civil war, testing whether that nation, or any nation so "
+    "conceived and so dedicated, can long endure. We are met on a great "
+    "battle-field of that war. We have come to dedicate a portion of that "
+    "field, as a final resting place for those who here gave their lives "
+    "that that nation might live. It is altogether fitting and proper that "
+    "we should do this.\n"
+    "Call me Ishmael. Some years ago, never mind how long precisely, having "
+    "little or no money in my purse, and nothing particular to interest me "
+    "on shore, I thought I would sail about a little and see the watery part "
+    "of the world. It is a way I have of driving off the spleen and "
+    "regulating the circulation. Whenever I find myself growing grim about "
+    "the mouth; whenever it is a damp, drizzly November in my soul; then, I "
+    "account it high time to get to sea as soon as I can.\n"
+    "Alice was beginning to get very tired of sitting by her sister on the "
+    "bank, and of having nothing to do: once or twice she had peeped into "
+    "the book her sister was reading, but it had no pictures or "
+    "conversations in it, \"and what is the use of a book,\" thought Alice "
+    "\"without pictures or conversations?\" So she was considering in her "
+    "own mind (as well as she could, for the hot day made her feel very "
+    "sleepy and stupid), whether the pleasure of making a daisy-chain would "
+    "be worth the trouble of getting up and picking the daisies, when "
+    "suddenly a White Rabbit with pink eyes ran close by her. There was "
+    "nothing so very remarkable in that; nor did Alice think it so very much "
+    "out of the way to hear the Rabbit say to itself, \"Oh dear! Oh dear! I "
+    "shall be late!\"\n";
+
+static std::array<uint8_t, 256> gen_ngram_symbols() {
+  std::array<uint8_t, 256> output{};
+  for (size_t byte = 0; byte < 256; ++byte) {
+    const char character = char(byte);
+    if (byte >= 0x80) {
+      output[byte] = 31;
+    } else if (std::isalpha(byte)) {
+      output[byte] = uint8_t(std::tolower(byte) - 'a');
+    } else if (character == ' ' || character == '\n' || character == '\t' ||
+               character == '\r') {
+      output[byte] = 26;
+    } else if (std::isdigit(byte)) {
+      output[byte] = 27;
+    } else if (std::string_view(".,;:!?").find(character) !=
+               std::string_view::npos) {
+      output[byte] = 28;
+    } else if (character == '\'' || character == '"') {
+      output[byte] = 29;
+    } else if (std::isprint(byte)) {
+      output[byte] = 30;
+    } else {
+      output[byte] = 31;
+    }
+  }
+  return output;
+}
+
+static const std::array<uint8_t, 256> NGRAM_SYMBOLS = gen_ngram_symbols();
+
+c_ByteHistogram gen_histogram(const ByteSpan input) {
+  c_ByteHistogram output;
+  output.m_total = input.size();
+  size_t index = 0;
+  while (index < input.size()) {
+    // Flushed often enough that the 32 bit lanes cannot overflow
+    const size_t chunk_end =
+        index + std::min(input.size() - index, HISTOGRAM_CHUNK_BYTES);
+    std::array<std::array<uint32_t, 256>, HISTOGRAM_LANES> lanes{};
+    for (; index + HISTOGRAM_LANES <= chunk_end; index += HISTOGRAM_LANES) {
+      ++lanes[0][input[index]];
+      ++lanes[1][input[index + 1]];
+      ++lanes[2][input[index + 2]];
+      ++lanes[3][input[index + 3]];
+    }
+    for (; index < chunk_end; ++index) {
+      ++lanes[0][input[index]];
+    }
+    for (size_t byte = 0; byte < 256; ++byte) {
+      output.m_counts[byte] += uint64_t(lanes[0][byte]) + lanes[1][byte] +
+                               lanes[2][byte] + lanes[3][byte];
+    }
+  }
+  return output;
+}
+
+std::vector<c_ByteHistogram> gen_column_histograms(const ByteSpan input,
+                                                   const size_t num_columns) {
+  if (num_columns == 0) {
+    throw std::invalid_argument("Need at least one column!");
+  }
+  std::vector<c_ByteHistogram> output(num_columns);
+  size_t column = 0;
+  for (const uint8_t byte : input) {
+    ++output[column].m_counts[byte];
+    if (++column == num_columns) {
+      column = 0;
+    }
+  }
+  // The first input.size() % num_columns columns get one byte more
+  for (size_t column_index = 0; column_index < num_columns; ++column_index) {
+    output[column_index].m_total = input.size() / num_columns +
+                                   (column_index < input.size() % num_columns);
+  }
+  return output;
+}
+
+double index_of_coincidence(const c_ByteHistogram &histogram) {
+  if (histogram.m_total < 2) {
+    return 0.0;
+  }
+  double matches = 0.0;
+  for (const uint64_t count : histogram.m_counts) {
+    matches += double(count) * double(count - (count > 0));
+  }
+  return matches / (double(histogram.m_total) * double(histogram.m_total - 1));
+}
+
+double mean_column_index_of_coincidence(const ByteSpan input,
+                                        const size_t num_columns) {
+  double total = 0.0;
+  for (const auto &histogram : gen_column_histograms(input, num_columns)) {
+    total += index_of_coincidence(histogram);
+  }
+  return total / double(num_columns);
+}
+
+c_LanguageModel::c_LanguageModel(const FreqMap &freq_map,
+                                 const ByteSpan corpus) {
+  const c_CandidateModel candidate_model(freq_map);
+  double total = 0.0;
+  for (size_t byte = 0; byte < 256; ++byte) {
+    m_probabilities[byte] =
+        std::max(candidate_model.m_prior[byte], BYTE_PROBABILITY_FLOOR);
+    total += m_probabilities[byte];
+  }
+  for (double &probability : m_probabilities) {
+    probability /= total;
+  }
+  cache_byte_tables();
+  train_ngrams(corpus);
+}
+
+c_LanguageModel::c_LanguageModel(const ByteSpan corpus) {
+  const c_ByteHistogram histogram = gen_histogram(corpus);
+  const double total = double(histogram.m_total) + 256 * CORPUS_SMOOTHING;
+  for (size_t byte = 0; byte < 256; ++byte) {
+    m_probabilities[byte] =
+        (double(histogram.m_counts[byte]) + CORPUS_SMOOTHING) / total;
+  }
+  cache_byte_tables();
+  train_ngrams(corpus);
+}
+
+void c_LanguageModel::cache_byte_tables() {
+  for (size_t byte = 0; byte < 256; ++byte) {
+    m_log_probabilities[byte] = std::log2(m_probabilities[byte]);
+    m_inverse_probabilities[byte] = 1.0 / m_probabilities[byte];
+  }
+}
+
+// log2 of smoothed conditional probabilities, one row of
+// NGRAM_ALPHABET_SIZE per context
+static std::vector<double>
+gen_conditional_log_probabilities(const std::vector<uint32_t> &counts) {
+  std::vector<double> output(counts.size());
+  for (size_t row = 0; row < counts.size(); row += NGRAM_ALPHABET_SIZE) {
+    double row_total = NGRAM_ALPHABET_SIZE * CORPUS_SMOOTHING;
+    for (size_t symbol = 0; symbol < NGRAM_ALPHABET_SIZE; ++symbol) {
+      row_total += counts[row + symbol];
+    }
+    for (size_t symbol = 0; symbol < NGRAM_ALPHABET_SIZE; ++symbol) {
+      output[row + symbol] = std::log2(
+          (counts[row + symbol] + CORPUS_SMOOTHING) / row_total);
+    }
+  }
+  return output;
+}
+
+void c_LanguageModel::train_ngrams(const ByteSpan corpus) {
+  std::vector<uint32_t> bigram_counts(NGRAM_ALPHABET_SIZE *
+                                      NGRAM_ALPHABET_SIZE);
+  std::vector<uint32_t> trigram_counts(
+      NGRAM_ALPHABET_SIZE * NGRAM_ALPHABET_SIZE * NGRAM_ALPHABET_SIZE);
+  for (size_t index = 1; index < corpus.size(); ++index) {
+    const size_t bigram = NGRAM_SYMBOLS[corpus[index - 1]] *
+                              NGRAM_ALPHABET_SIZE +
+                          NGRAM_SYMBOLS[corpus[index]];
+    ++bigram_counts[bigram];
+    if (index >= 2) {
+      ++trigram_counts[NGRAM_SYMBOLS[corpus[index - 2]] * NGRAM_ALPHABET_SIZE *
+                           NGRAM_ALPHABET_SIZE +
+                       bigram];
+    }
+  }
+  m_bigram_log_probabilities = gen_conditional_log_probabilities(bigram_counts);
+  m_trigram_log_probabilities =
+      gen_conditional_log_probabilities(trigram_counts);
+}
+
+const c_LanguageModel &english_language_model() {
+  static const c_LanguageModel model(
+      english_freq_map,
+      ByteSpan(reinterpret_cast<const uint8_t *>(ENGLISH_CORPUS.data()),
+               ENGLISH_CORPUS.size()));
+  return model;
+}
+
+double chi_squared(const c_ByteHistogram &histogram,
+                   const c_LanguageModel &model) {
+  return score_single_xor_keys(histogram, model, ScoreMethod::chi_squared)[0];
+}
+
+double log_likelihood(const c_ByteHistogram &histogram,
+                      const c_LanguageModel &model) {
+  double output = 0.0;
+  for (size_t byte = 0; byte < 256; ++byte) {
+    output += double(histogram.m_counts[byte]) *
+              model.m_log_probabilities[byte];
+  }
+  return output;
+}
+
+double ngram_log_likelihood(const ByteSpan text, const c_LanguageModel &model,
+                            const size_t order) {
+  double output = 0.0;
+  if (order == 2) {
+    for (size_t index = 1; index < text.size(); ++index) {
+      output += model.m_bigram_log_probabilities
+                    [NGRAM_SYMBOLS[text[index - 1]] * NGRAM_ALPHABET_SIZE +
+                     NGRAM_SYMBOLS[text[index]]];
+    }
+  } else if (order == 3) {
+    for (size_t index = 2; index < text.size(); ++index) {
+      output += model.m_trigram_log_probabilities
+                    [(NGRAM_SYMBOLS[text[index - 2]] * NGRAM_ALPHABET_SIZE +
+                      NGRAM_SYMBOLS[text[index - 1]]) *
+                         NGRAM_ALPHABET_SIZE +
+                     NGRAM_SYMBOLS[text[index]]];
+    }
+  } else {
+    throw std::invalid_argument("n-gram order must be 2 or 3!");
+  }
+  return output;
+}
+
+double pairwise_bigram_log_likelihood(const ByteSpan previous,
+                                      const ByteSpan next,
+                                      const c_LanguageModel &model) {
+  const size_t length = std::min(previous.size(), next.size());
+  double output = 0.0;
+  for (size_t index = 0; index < length; ++index) {
+    output += model.m_bigram_log_probabilities
+                  [NGRAM_SYMBOLS[previous[index]] * NGRAM_ALPHABET_SIZE +
+                   NGRAM_SYMBOLS[next[index]]];
+  }
+  return output;
+}
+
+double score_text(const ByteSpan text, const c_LanguageModel &model) {
+  if (text.empty()) {
+    return 0.0;
+  }
+  const double total = log_likelihood(gen_histogram(text), model) +
+                       ngram_log_likelihood(text, model, 2) +
+                       ngram_log_likelihood(text, model, 3);
+  return -total / double(text.size());
+}
+
+std::array<double, 256>
+score_single_xor_keys(const c_ByteHistogram &histogram,
+                      const c_LanguageModel &model, const ScoreMethod method) {
+  std::array<double, 256> output{};
+  if (histogram.m_total == 0) {
+    return output;
+  }
+  const double total = double(histogram.m_total);
+  // Plaintext byte byte ^ key occurs count times, for each ciphertext byte
+  for (size_t byte = 0; byte < 256; ++byte) {
+    const double count = double(histogram.m_counts[byte]);
+    if (count == 0.0) {
+      continue;
+    }
+    if (method == ScoreMethod::log_likelihood) {
+      for (size_t key = 0; key < 256; ++key) {
+        output[key] -= count * model.m_log_probabilities[byte ^ key];
+      }
+    } else {
+      // sum (observed - expected)^2 / expected, less the constant total
+      for (size_t key = 0; key < 256; ++key) {
+        output[key] +=
+            count * count * model.m_inverse_probabilities[byte ^ key];
+      }
+    }
+  }
+  for (double &score : output) {
+    score = (method == ScoreMethod::log_likelihood) ? score / total
+                                                    : score / total - total;
+  }
+  return output;
+}
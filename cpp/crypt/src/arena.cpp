@@ -0,0 +1,75 @@
+#include <arena.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+
+c_BumpArena::c_BumpArena(const size_t initial_chunk_bytes)
+    : m_initial_chunk_bytes(std::max<size_t>(initial_chunk_bytes, 1)) {}
+
+c_BumpArena::c_Mark c_BumpArena::mark() const {
+  return {m_chunk_index, m_offset};
+}
+
+void c_BumpArena::rewind(const c_Mark &mark) {
+  m_chunk_index = mark.m_chunk_index;
+  m_offset = mark.m_offset;
+}
+
+size_t c_BumpArena::bytes_in_use() const {
+  size_t output = m_offset;
+  for (size_t chunk_index = 0; chunk_index < m_chunk_index; ++chunk_index) {
+    output += m_chunks[chunk_index].m_size;
+  }
+  return output;
+}
+
+void *c_BumpArena::do_allocate(const size_t num_bytes,
+                               const size_t alignment) {
+  ++m_stats.m_num_allocations;
+  for (;; ++m_chunk_index, m_offset = 0) {
+    if (m_chunk_index == m_chunks.size()) {
+      // Each chunk at least doubles the arena
+      const size_t chunk_bytes =
+          std::max({m_initial_chunk_bytes, m_stats.m_bytes_reserved,
+                    num_bytes + alignment});
+      m_chunks.push_back(
+          {std::make_unique_for_overwrite<std::byte[]>(chunk_bytes),
+           chunk_bytes});
+      ++m_stats.m_num_chunk_allocations;
+      m_stats.m_bytes_reserved += chunk_bytes;
+    }
+    // Anything left at the end of a chunk is skipped until the next rewind
+    c_Chunk &chunk = m_chunks[m_chunk_index];
+    const uintptr_t base = reinterpret_cast<uintptr_t>(chunk.m_data.get());
+    const size_t offset =
+        ((base + m_offset + alignment - 1) & ~(alignment - 1)) - base;
+    if (offset + num_bytes <= chunk.m_size) {
+      m_offset = offset + num_bytes;
+      m_stats.m_high_water_bytes =
+          std::max(m_stats.m_high_water_bytes, bytes_in_use());
+      return chunk.m_data.get() + offset;
+    }
+  }
+}
+
+static thread_local c_BumpArena thread_arena;
+static thread_local std::pmr::memory_resource *thread_scratch_resource =
+    nullptr;
+
+c_BumpArena &scratch_arena() { return thread_arena; }
+
+std::pmr::memory_resource *scratch_resource() {
+  return (thread_scratch_resource == nullptr) ? &thread_arena
+                                              : thread_scratch_resource;
+}
+
+void set_scratch_resource(std::pmr::memory_resource *resource) {
+  thread_scratch_resource = resource;
+}
+
+std::pmr::memory_resource *scratch_resource_override() {
+  return thread_scratch_resource;
+}
@@ -0,0 +1,263 @@
+#include <cipher.hpp>
+
+#include <aes.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+// Four blocks are processed at once as eight 64 bit slices, where bit p of
+// slice i is bit i of byte p of the 64 input bytes. Every step is fixed
+// logic on whole slices, with no table lookups or data dependent branches,
+// so the timing does not depend on the key or data.
+constexpr size_t BITSLICE_NUM_BLOCKS = 4;
+constexpr size_t BITSLICE_NUM_BYTES = BITSLICE_NUM_BLOCKS * BLOCK_SIZE_BYTES;
+constexpr size_t NUM_BITSLICES = 8;
+
+using BitSlices = std::array<uint64_t, NUM_BITSLICES>;
+
+static BitSlices to_bitslices(const uint8_t *input) {
+  BitSlices output{};
+  for (size_t byte_index = 0; byte_index < BITSLICE_NUM_BYTES; ++byte_index) {
+    for (size_t bit_index = 0; bit_index < NUM_BITSLICES; ++bit_index) {
+      output[bit_index] |= uint64_t((input[byte_index] >> bit_index) & 1)
+                           << byte_index;
+    }
+  }
+  return output;
+}
+
+static void from_bitslices(const BitSlices &input, uint8_t *output) {
+  for (size_t byte_index = 0; byte_index < BITSLICE_NUM_BYTES; ++byte_index) {
+    uint8_t byte = 0;
+    for (size_t bit_index = 0; bit_index < NUM_BITSLICES; ++bit_index) {
+      byte |= uint8_t(((input[bit_index] >> byte_index) & 1) << bit_index);
+    }
+    output[byte_index] = byte;
+  }
+}
+
+static BitSlices operator^(BitSlices input_a, const BitSlices &input_b) {
+  for (size_t bit_index = 0; bit_index < NUM_BITSLICES; ++bit_index) {
+    input_a[bit_index] ^= input_b[bit_index];
+  }
+  return input_a;
+}
+
+// Multiplication in GF(2^8) modulo x^8 + x^4 + x^3 + x + 1
+static BitSlices gf_multiply(const BitSlices &input_a,
+                             const BitSlices &input_b) {
+  std::array<uint64_t, (2 * NUM_BITSLICES) - 1> product{};
+  for (size_t index_a = 0; index_a < NUM_BITSLICES; ++index_a) {
+    for (size_t index_b = 0; index_b < NUM_BITSLICES; ++index_b) {
+      product[index_a + index_b] ^= input_a[index_a] & input_b[index_b];
+    }
+  }
+  for (size_t bit_index = product.size() - 1; bit_index >= NUM_BITSLICES;
+       --bit_index) {
+    product[bit_index - 8] ^= product[bit_index];
+    product[bit_index - 7] ^= product[bit_index];
+    product[bit_index - 5] ^= product[bit_index];
+    product[bit_index - 4] ^= product[bit_index];
+  }
+  BitSlices output;
+  std::copy_n(product.begin(), NUM_BITSLICES, output.begin());
+  return output;
+}
+
+static BitSlices gf_square(const BitSlices &input) {
+  return gf_multiply(input, input);
+}
+
+// x^254, which is the inverse of x and maps 0 to 0
+static BitSlices gf_inverse(const BitSlices &input) {
+  const BitSlices power_2 = gf_square(input);
+  const BitSlices power_3 = gf_multiply(power_2, input);
+  const BitSlices power_12 = gf_square(gf_square(power_3));
+  const BitSlices power_15 = gf_multiply(power_12, power_3);
+  BitSlices power_240 = power_15;
+  for (size_t iter = 0; iter < 4; ++iter) {
+    power_240 = gf_square(power_240);
+  }
+  return gf_multiply(gf_multiply(power_240, power_12), power_2);
+}
+
+// b_i ^ b_i+4 ^ b_i+5 ^ b_i+6 ^ b_i+7 ^ c_i, with indices mod 8
+static BitSlices affine_transform(const BitSlices &input) {
+  constexpr uint8_t AFFINE_CONSTANT = 0x63;
+  BitSlices output;
+  for (size_t bit_index = 0; bit_index < NUM_BITSLICES; ++bit_index) {
+    output[bit_index] = input[bit_index] ^ input[(bit_index + 4) % 8] ^
+                        input[(bit_index + 5) % 8] ^
+                        input[(bit_index + 6) % 8] ^ input[(bit_index + 7) % 8];
+    if ((AFFINE_CONSTANT >> bit_index) & 1) {
+      output[bit_index] = ~output[bit_index];
+    }
+  }
+  return output;
+}
+
+// b_i+2 ^ b_i+5 ^ b_i+7 ^ d_i
+static BitSlices inv_affine_transform(const BitSlices &input) {
+  constexpr uint8_t INV_AFFINE_CONSTANT = 0x05;
+  BitSlices output;
+  for (size_t bit_index = 0; bit_index < NUM_BITSLICES; ++bit_index) {
+    output[bit_index] = input[(bit_index + 2) % 8] ^
+                        input[(bit_index + 5) % 8] ^ input[(bit_index + 7) % 8];
+    if ((INV_AFFINE_CONSTANT >> bit_index) & 1) {
+      output[bit_index] = ~output[bit_index];
+    }
+  }
+  return output;
+}
+
+static void sub_bytes(BitSlices &state) {
+  state = affine_transform(gf_inverse(state));
+}
+
+static void inv_sub_bytes(BitSlices &state) {
+  state = gf_inverse(inv_affine_transform(state));
+}
+
+// Masks selecting bits of every 16 bit block and 4 bit column
+constexpr uint64_t replicate_16(const uint64_t pattern) {
+  return pattern * 0x0001000100010001;
+}
+constexpr uint64_t replicate_4(const uint64_t pattern) {
+  return replicate_16(pattern * 0x1111);
+}
+
+// Byte r of column c sits at bit 4c + r of its block, so ShiftRows rotates
+// row r of each block right by 4r bits
+template <size_t RowIndex>
+uint64_t shift_row(const uint64_t slice, const size_t shift) {
+  constexpr uint64_t ROW_MASK = replicate_4(uint64_t(1) << RowIndex);
+  const uint64_t low_mask = replicate_16(0xffff >> shift);
+  const uint64_t row = slice & ROW_MASK;
+  return ((row >> shift) & low_mask) | ((row << (16 - shift)) & ~low_mask);
+}
+
+static void shift_rows(BitSlices &state, const bool is_inverse) {
+  for (auto &slice : state) {
+    const size_t row_1_shift = is_inverse ? 12 : 4;
+    const size_t row_3_shift = is_inverse ? 4 : 12;
+    slice = (slice & replicate_4(1)) | shift_row<1>(slice, row_1_shift) |
+            shift_row<2>(slice, 8) | shift_row<3>(slice, row_3_shift);
+  }
+}
+
+// Byte r of every column takes byte r + NumBytes of the same column
+template <size_t NumBytes> BitSlices rotate_columns(BitSlices state) {
+  constexpr uint64_t LOW_MASK = replicate_4(0xf >> NumBytes);
+  for (auto &slice : state) {
+    slice = ((slice >> NumBytes) & LOW_MASK) |
+            ((slice << (4 - NumBytes)) & ~LOW_MASK);
+  }
+  return state;
+}
+
+static BitSlices xtime(const BitSlices &input) {
+  return {input[7],
+          input[0] ^ input[7],
+          input[1],
+          input[2] ^ input[7],
+          input[3] ^ input[7],
+          input[4],
+          input[5],
+          input[6]};
+}
+
+// The same column formulas as mix_columns_xtime in packed_block.hpp
+static void mix_columns(BitSlices &state) {
+  const BitSlices rotated_1 = rotate_columns<1>(state);
+  const BitSlices column_sum = state ^ rotated_1 ^ rotate_columns<2>(state) ^
+                               rotate_columns<3>(state);
+  state = state ^ column_sum ^ xtime(state ^ rotated_1);
+}
+
+static void inv_mix_columns(BitSlices &state) {
+  state = state ^ xtime(xtime(state ^ rotate_columns<2>(state)));
+  mix_columns(state);
+}
+
+template <typename KeyType, typename KeyScheduleType>
+struct c_BitslicedCipher : public c_BlockCipher {
+  static constexpr size_t NUM_ROUNDS =
+      (std::tuple_size<KeyScheduleType>{} / BLOCK_SIZE_WORDS) - 1;
+
+  // Each round key is repeated for all four blocks before slicing
+  c_BitslicedCipher(const KeyType &key) {
+    const KeyScheduleType key_schedule = gen_key_schedule(key);
+    for (size_t round_index = 0; round_index <= NUM_ROUNDS; ++round_index) {
+      std::array<uint8_t, BITSLICE_NUM_BYTES> round_keys;
+      for (size_t block_index = 0; block_index < BITSLICE_NUM_BLOCKS;
+           ++block_index) {
+        std::memcpy(round_keys.data() + (block_index * BLOCK_SIZE_BYTES),
+                    &key_schedule[round_index * BLOCK_SIZE_WORDS],
+                    BLOCK_SIZE_BYTES);
+      }
+      m_round_keys[round_index] = to_bitslices(round_keys.data());
+    }
+  }
+
+  void encrypt_blocks(const uint8_t *input, uint8_t *output,
+                      const size_t num_blocks) const override {
+    for_each_batch(input, output, num_blocks, [this](BitSlices &state) {
+      state = state ^ m_round_keys[0];
+      for (size_t round_index = 1; round_index < NUM_ROUNDS; ++round_index) {
+        sub_bytes(state);
+        shift_rows(state, false);
+        mix_columns(state);
+        state = state ^ m_round_keys[round_index];
+      }
+      sub_bytes(state);
+      shift_rows(state, false);
+      state = state ^ m_round_keys[NUM_ROUNDS];
+    });
+  }
+
+  void decrypt_blocks(const uint8_t *input, uint8_t *output,
+                      const size_t num_blocks) const override {
+    for_each_batch(input, output, num_blocks, [this](BitSlices &state) {
+      state = state ^ m_round_keys[NUM_ROUNDS];
+      for (size_t round_index = NUM_ROUNDS - 1; round_index > 0;
+           --round_index) {
+        shift_rows(state, true);
+        inv_sub_bytes(state);
+        state = state ^ m_round_keys[round_index];
+        inv_mix_columns(state);
+      }
+      shift_rows(state, true);
+      inv_sub_bytes(state);
+      state = state ^ m_round_keys[0];
+    });
+  }
+
+  // A short final batch is zero filled
+  template <typename FuncType>
+  static void for_each_batch(const uint8_t *input, uint8_t *output,
+                             const size_t num_blocks, FuncType &&func) {
+    for (size_t block_index = 0; block_index < num_blocks;
+         block_index += BITSLICE_NUM_BLOCKS) {
+      const size_t num_bytes =
+          std::min(BITSLICE_NUM_BLOCKS, num_blocks - block_index) *
+          BLOCK_SIZE_BYTES;
+      const size_t offset = block_index * BLOCK_SIZE_BYTES;
+      std::array<uint8_t, BITSLICE_NUM_BYTES> batch{};
+      std::memcpy(batch.data(), input + offset, num_bytes);
+
+      BitSlices state = to_bitslices(batch.data());
+      func(state);
+      from_bitslices(state, batch.data());
+      std::memcpy(output + offset, batch.data(), num_bytes);
+    }
+  }
+
+  std::array<BitSlices, NUM_ROUNDS + 1> m_round_keys;
+};
+
+std::unique_ptr<c_BlockCipher> make_bitsliced_cipher(const RawBytes &key_raw) {
+  return make_aes_cipher<c_BitslicedCipher>(key_raw);
+}
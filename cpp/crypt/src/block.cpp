@@ -1,4 +1,13 @@
 #include <block.hpp>
+#include <packed_block.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <numeric>
+#include <utility>
+#include <vector>
 
 // Constants
 
@@ -248,16 +257,22 @@ void set_row(ByteBlock &block, const Word &row, const size_t row_index) {
 
 ByteBlock from_raw_bytes_to_byte_block(const RawBytes &input,
                                        const size_t block_number) {
+  return from_raw_bytes_to_byte_block(ByteSpan{input}, block_number);
+}
+
+ByteBlock from_raw_bytes_to_byte_block(const ByteSpan input,
+                                       const size_t block_number) {
+  // ByteBlock is column major, which is exactly the raw byte order
   ByteBlock output;
-  to_word_array<RawBytes, BLOCK_SIZE_WORDS>(input, output,
-                                            block_number * BLOCK_SIZE_BYTES);
+  std::memcpy(&output, input.data() + (block_number * BLOCK_SIZE_BYTES),
+              BLOCK_SIZE_BYTES);
   return output;
 }
 
 void from_byte_block_to_raw_bytes(const ByteBlock &input, RawBytes &output,
                                   const size_t block_number) {
-  from_word_array<RawBytes, BLOCK_SIZE_WORDS>(input, output,
-                                              block_number * BLOCK_SIZE_BYTES);
+  std::memcpy(output.data() + (block_number * BLOCK_SIZE_BYTES), &input,
+              BLOCK_SIZE_BYTES);
 }
 
 RawBytes from_byte_block_to_raw_bytes(const ByteBlock &input) {
@@ -297,6 +312,12 @@ void base_sub_word(const SquareLookupTable &lookup_table, Word &input) {
 
 void sub_word(Word &input) { base_sub_word(S_BOX, input); }
 
+uint8_t sub_byte(const uint8_t input) { return do_lookup(S_BOX, input); }
+
+uint8_t inv_sub_byte(const uint8_t input) {
+  return do_lookup(INV_S_BOX, input);
+}
+
 void sub_word(ByteBlock &input, const size_t column_index) {
   ByteColumn column = get_column(input, column_index);
   sub_word(column);
@@ -331,47 +352,34 @@ Word operator^(const Word &input_a, const Word &input_b) {
 }
 
 ByteBlock operator^(const ByteBlock &input_a, const ByteBlock &input_b) {
-  ByteBlock output;
-  for (size_t column_index = 0; column_index < WORD_SIZE_BYTES;
-       ++column_index) {
-    ByteColumn column_a = get_column(input_a, column_index);
-    ByteColumn column_b = get_column(input_b, column_index);
-    set_column(output, (column_a ^ column_b), column_index);
-  }
-  return output;
+  return to_byte_block(load_block(input_a) ^ load_block(input_b));
 }
 
-void shift_word(Word &input, const size_t shift_amount) {
-  Word output;
-  for (size_t byte_index = 0; byte_index < WORD_SIZE_BYTES; ++byte_index) {
-    output[byte_index] = input[(byte_index + shift_amount) % WORD_SIZE_BYTES];
-  }
-  input = output;
+void shift_rows(ByteBlock &input) {
+  c_PackedBlock state = load_block(input);
+  shift_rows(state);
+  input = to_byte_block(state);
 }
 
-void shift_row(ByteBlock &input, const size_t row_index,
-               const size_t shift_amount) {
-  Word output_row = get_row(input, row_index);
-  shift_word(output_row, shift_amount);
-  set_row(input, output_row, row_index);
+void inv_shift_rows(ByteBlock &input) {
+  c_PackedBlock state = load_block(input);
+  inv_shift_rows(state);
+  input = to_byte_block(state);
 }
 
-void shift_rows(ByteBlock &input) {
-  shift_row(input, 1, 1);
-  shift_row(input, 2, 2);
-  shift_row(input, 3, 3);
+void base_sub_bytes(const SquareLookupTable &lookup_table,
+                    c_PackedBlock &input) {
+  std::array<uint8_t, BLOCK_SIZE_BYTES> bytes;
+  store_block(input, bytes.data());
+  for (auto &byte : bytes) {
+    byte = do_lookup(lookup_table, byte);
+  }
+  input = load_block(bytes.data());
 }
 
-void inv_shift_row(ByteBlock &input, const size_t row_index,
-                   const size_t shift_amount) {
-  shift_row(input, row_index, (BLOCK_SIZE_WORDS - shift_amount));
-}
+void sub_bytes(c_PackedBlock &input) { base_sub_bytes(S_BOX, input); }
 
-void inv_shift_rows(ByteBlock &input) {
-  inv_shift_row(input, 1, 1);
-  inv_shift_row(input, 2, 2);
-  inv_shift_row(input, 3, 3);
-}
+void inv_sub_bytes(c_PackedBlock &input) { base_sub_bytes(INV_S_BOX, input); }
 
 void mix_column(ByteColumn &input) {
   ByteColumn input_copy(input);
@@ -424,3 +432,33 @@ void inv_mix_columns(ByteBlock &input) {
   inv_mix_column(input[2]);
   inv_mix_column(input[3]);
 }
+
+void mix_columns_tables(c_PackedBlock &input) {
+  ByteBlock block = to_byte_block(input);
+  mix_columns(block);
+  input = load_block(block);
+}
+
+void inv_mix_columns_tables(c_PackedBlock &input) {
+  ByteBlock block = to_byte_block(input);
+  inv_mix_columns(block);
+  input = load_block(block);
+}
+
+c_ChainSchedule::c_ChainSchedule(std::vector<size_t> num_blocks)
+    : m_num_blocks(std::move(num_blocks))
+    , m_order(m_num_blocks.size()) {
+  std::iota(std::begin(m_order), std::end(m_order), 0);
+  std::stable_sort(std::begin(m_order), std::end(m_order),
+                   [this](const size_t lhs, const size_t rhs) {
+                     return m_num_blocks[lhs] > m_num_blocks[rhs];
+                   });
+}
+
+size_t c_ChainSchedule::num_running(const size_t block_index) const {
+  return size_t(std::partition_point(std::begin(m_order), std::end(m_order),
+                                     [this, block_index](const size_t chain) {
+                                       return m_num_blocks[chain] > block_index;
+                                     }) -
+                std::begin(m_order));
+}
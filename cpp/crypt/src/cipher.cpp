@@ -0,0 +1,184 @@
+#include <cipher.hpp>
+
+#include <aes.hpp>
+#include <raw_bytes.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// The multi-block kernels from aes.hpp
+template <typename KeyType, typename KeyScheduleType>
+struct c_ReferenceCipher : public c_BlockCipher {
+  c_ReferenceCipher(const KeyType &key)
+      : m_encrypter(key) {}
+
+  void encrypt_blocks(const uint8_t *input, uint8_t *output,
+                      const size_t num_blocks) const override {
+    AES_cipher_bytes<KeyScheduleType>(input, output, num_blocks,
+                                      m_encrypter.m_key_schedule);
+  }
+
+  void decrypt_blocks(const uint8_t *input, uint8_t *output,
+                      const size_t num_blocks) const override {
+    AES_inv_cipher_bytes<KeyScheduleType>(
+        input, output, num_blocks, m_encrypter.m_decryption_key_schedule);
+  }
+
+  const c_Encrypter<KeyType, KeyScheduleType> m_encrypter;
+};
+
+std::unique_ptr<c_BlockCipher> make_reference_cipher(const RawBytes &key_raw) {
+  return make_aes_cipher<c_ReferenceCipher>(key_raw);
+}
+
+struct c_CipherTestVector {
+  const char *m_key_hex;
+  const char *m_ciphertext_hex;
+};
+
+// FIPS-197 Appendix C, all with plaintext 00112233445566778899aabbccddeeff
+static const std::array<c_CipherTestVector, 3> CIPHER_TEST_VECTORS = {{
+    {"000102030405060708090a0b0c0d0e0f", "69c4e0d86a7b0430d8cdb78070b4c55a"},
+    {"000102030405060708090a0b0c0d0e0f1011121314151617",
+     "dda97ca4864cdfe06eaf70a0ec0d7191"},
+    {"000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f",
+     "8ea2b7ca516745bfeafc49904b496089"},
+}};
+
+// Covers a single block and partial and full multi-block batches
+static const std::array<size_t, 4> SELF_TEST_NUM_BLOCKS = {1, 3, 4, 9};
+
+void self_test_cipher_backend(const c_CipherBackend &backend) {
+  const RawBytes plaintext_block =
+      from_hex_string("00112233445566778899aabbccddeeff");
+  for (const auto &vector : CIPHER_TEST_VECTORS) {
+    const auto cipher = backend.m_factory(from_hex_string(vector.m_key_hex));
+    const RawBytes ciphertext_block = from_hex_string(vector.m_ciphertext_hex);
+
+    for (const size_t num_blocks : SELF_TEST_NUM_BLOCKS) {
+      RawBytes plaintext_raw;
+      RawBytes expected_raw;
+      for (size_t block_index = 0; block_index < num_blocks; ++block_index) {
+        plaintext_raw.insert(plaintext_raw.end(), plaintext_block.begin(),
+                             plaintext_block.end());
+        expected_raw.insert(expected_raw.end(), ciphertext_block.begin(),
+                            ciphertext_block.end());
+      }
+
+      RawBytes buffer_raw(plaintext_raw.size());
+      cipher->encrypt_blocks(plaintext_raw.data(), buffer_raw.data(),
+                             num_blocks);
+      const bool encrypt_ok = buffer_raw == expected_raw;
+      cipher->decrypt_blocks(buffer_raw.data(), buffer_raw.data(),
+                             num_blocks);
+      if (!encrypt_ok || buffer_raw != plaintext_raw) {
+        throw std::runtime_error("Cipher backend " + backend.m_name +
+                                 " failed its self test!");
+      }
+    }
+  }
+}
+
+struct c_CipherRegistry {
+  c_CipherRegistry() {
+    add({"reference", make_reference_cipher, 20});
+    add({"ttable", make_ttable_cipher, 30});
+    add({"bitsliced", make_bitsliced_cipher, 10});
+    if (aesni_is_supported()) {
+      add({"aesni", make_aesni_cipher, 40});
+    }
+  }
+
+  void add(const c_CipherBackend &backend) {
+    self_test_cipher_backend(backend);
+    std::erase_if(m_backends, [&backend](const c_CipherBackend &existing) {
+      return existing.m_name == backend.m_name;
+    });
+    m_backends.push_back(backend);
+  }
+
+  const c_CipherBackend &find(const std::string_view name) const {
+    for (const auto &backend : m_backends) {
+      if (backend.m_name == name) {
+        return backend;
+      }
+    }
+    throw std::invalid_argument("Unknown cipher backend " + std::string(name));
+  }
+
+  std::mutex m_mutex;
+  std::vector<c_CipherBackend> m_backends;
+  std::string m_default_name;
+};
+
+static c_CipherRegistry &get_cipher_registry() {
+  static c_CipherRegistry registry;
+  return registry;
+}
+
+void register_cipher_backend(const c_CipherBackend &backend) {
+  c_CipherRegistry &registry = get_cipher_registry();
+  const std::lock_guard<std::mutex> lock(registry.m_mutex);
+  registry.add(backend);
+}
+
+std::vector<c_CipherBackend> get_cipher_backends() {
+  c_CipherRegistry &registry = get_cipher_registry();
+  const std::lock_guard<std::mutex> lock(registry.m_mutex);
+  std::vector<c_CipherBackend> backends = registry.m_backends;
+  std::sort(backends.begin(), backends.end(),
+            [](const c_CipherBackend &lhs, const c_CipherBackend &rhs) {
+              return lhs.m_priority > rhs.m_priority;
+            });
+  return backends;
+}
+
+c_CipherBackend get_cipher_backend(const std::string_view name) {
+  c_CipherRegistry &registry = get_cipher_registry();
+  const std::lock_guard<std::mutex> lock(registry.m_mutex);
+  return registry.find(name);
+}
+
+void set_default_cipher_backend(const std::string_view name) {
+  c_CipherRegistry &registry = get_cipher_registry();
+  const std::lock_guard<std::mutex> lock(registry.m_mutex);
+  if (!name.empty()) {
+    // Fail at the call rather than on the next lookup
+    registry.find(name);
+  }
+  registry.m_default_name = name;
+}
+
+c_CipherBackend get_default_cipher_backend() {
+  c_CipherRegistry &registry = get_cipher_registry();
+  const std::lock_guard<std::mutex> lock(registry.m_mutex);
+  if (!registry.m_default_name.empty()) {
+    return registry.find(registry.m_default_name);
+  }
+  const char *env_name = std::getenv(CIPHER_BACKEND_ENV);
+  if (env_name != nullptr && *env_name != '\0') {
+    return registry.find(env_name);
+  }
+  return *std::max_element(
+      registry.m_backends.begin(), registry.m_backends.end(),
+      [](const c_CipherBackend &lhs, const c_CipherBackend &rhs) {
+        return lhs.m_priority < rhs.m_priority;
+      });
+}
+
+std::unique_ptr<c_BlockCipher> make_block_cipher(const RawBytes &key_raw) {
+  return get_default_cipher_backend().m_factory(key_raw);
+}
+
+std::unique_ptr<c_BlockCipher> make_block_cipher(std::string_view backend_name,
+                                                 const RawBytes &key_raw) {
+  return get_cipher_backend(backend_name).m_factory(key_raw);
+}
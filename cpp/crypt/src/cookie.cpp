@@ -1,8 +1,210 @@
 #include <cookie.hpp>
 
-size_t c_ProfileCookie::m_uid_counter = 0;
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+c_UidAllocator c_ProfileCookie::m_uid_allocator;
+
+std::string_view to_string(const CookieError error) {
+  switch (error) {
+  case CookieError::ok:
+    return "ok";
+  case CookieError::missing_equals:
+    return "field without '='";
+  case CookieError::unknown_key:
+    return "unknown key";
+  case CookieError::bad_uid:
+    return "uid is not a number";
+  case CookieError::buffer_too_small:
+    return "buffer too small";
+  case CookieError::bad_token:
+    return "token does not decrypt to a padded cookie";
+  }
+  return "unknown error";
+}
+
+CookieError parse_profile_cookie(std::string_view input,
+                                 c_ProfileCookieView &output) {
+  while (!input.empty()) {
+    const size_t and_pos = input.find('&');
+    const std::string_view field = input.substr(0, and_pos);
+    input.remove_prefix(and_pos == std::string_view::npos ? input.size()
+                                                          : and_pos + 1);
+
+    const size_t equal_pos = field.find('=');
+    if (equal_pos == std::string_view::npos) {
+      return CookieError::missing_equals;
+    }
+    const std::string_view key = field.substr(0, equal_pos);
+    const std::string_view value = field.substr(equal_pos + 1);
+
+    if (key == "email") {
+      output.m_email = value;
+    } else if (key == "uid") {
+      const char *value_end = value.data() + value.size();
+      const auto [parse_end, parse_error] =
+          std::from_chars(value.data(), value_end, output.m_uid);
+      if (value.empty() || parse_error != std::errc() ||
+          parse_end != value_end) {
+        return CookieError::bad_uid;
+      }
+    } else if (key == "role") {
+      output.m_role = value;
+    } else {
+      return CookieError::unknown_key;
+    }
+  }
+  return CookieError::ok;
+}
+
+size_t encoded_length(const std::string_view input) {
+  size_t length = input.size();
+  for (const char character : input) {
+    if (character == '&' || character == '=') {
+      // One character becomes three
+      length += 2;
+    }
+  }
+  return length;
+}
+
+static size_t num_decimal_digits(size_t value) {
+  size_t num_digits = 1;
+  while (value >= 10) {
+    value /= 10;
+    ++num_digits;
+  }
+  return num_digits;
+}
+
+constexpr std::string_view EMAIL_PREFIX = "email=";
+constexpr std::string_view UID_PREFIX = "&uid=";
+constexpr std::string_view ROLE_PREFIX = "&role=";
+
+size_t serialized_length(const c_ProfileCookieView &cookie) {
+  return EMAIL_PREFIX.size() + encoded_length(cookie.m_email) +
+         UID_PREFIX.size() + num_decimal_digits(cookie.m_uid) +
+         ROLE_PREFIX.size() + cookie.m_role.size();
+}
+
+static char *append(char *output, const std::string_view input) {
+  std::memcpy(output, input.data(), input.size());
+  return output + input.size();
+}
+
+CookieError serialize_profile_cookie(const c_ProfileCookieView &cookie,
+                                     const std::span<char> buffer,
+                                     size_t &num_written) {
+  const size_t length = serialized_length(cookie);
+  if (buffer.size() < length) {
+    num_written = 0;
+    return CookieError::buffer_too_small;
+  }
+
+  char *output = append(buffer.data(), EMAIL_PREFIX);
+  for (const char character : cookie.m_email) {
+    if (character == '&') {
+      output = append(output, "%26");
+    } else if (character == '=') {
+      output = append(output, "%3D");
+    } else {
+      *output++ = character;
+    }
+  }
+  output = append(output, UID_PREFIX);
+  output = std::to_chars(output, buffer.data() + length, cookie.m_uid).ptr;
+  output = append(output, ROLE_PREFIX);
+  append(output, cookie.m_role);
+
+  num_written = length;
+  return CookieError::ok;
+}
+
+static std::string serialize_to_string(const c_ProfileCookieView &cookie) {
+  std::string output(serialized_length(cookie), '\0');
+  size_t num_written = 0;
+  serialize_profile_cookie(cookie, output, num_written);
+  return output;
+}
+
+c_ProfileCookie c_ProfileCookie::from_string(const std::string_view input) {
+  c_ProfileCookieView view;
+  const CookieError error = parse_profile_cookie(input, view);
+  if (error != CookieError::ok) {
+    throw std::invalid_argument(std::string(::to_string(error)) +
+                                " in cookie: \"" + std::string(input) + "\"");
+  }
+  return c_ProfileCookie(std::string(view.m_email), view.m_uid,
+                         std::string(view.m_role));
+}
+
+std::string c_ProfileCookie::to_string() const {
+  return serialize_to_string(view());
+}
+
+size_t c_ProfileFactory::next_uid() {
+  if (m_next_uid == m_end_uid) {
+    m_next_uid = m_uid_allocator.allocate(m_uid_block_size);
+    m_end_uid = m_next_uid + m_uid_block_size;
+  }
+  return m_next_uid++;
+}
+
+c_ProfileCookie c_ProfileFactory::make_profile(const std::string &email) {
+  return c_ProfileCookie(email, next_uid(), "user");
+}
+
+std::string c_ProfileFactory::profile_for(const std::string_view email) {
+  return serialize_to_string({email, next_uid(), "user"});
+}
+
+c_ProfileBatch
+c_ProfileFactory::profile_for_batch(std::span<const std::string_view> emails) {
+  c_ProfileBatch batch;
+  batch.m_block_offsets.reserve(emails.size() + 1);
+  batch.m_lengths.reserve(emails.size());
+
+  // Size the arena exactly before writing anything
+  std::vector<c_ProfileCookieView> cookies;
+  cookies.reserve(emails.size());
+  size_t num_blocks = 0;
+  for (const std::string_view email : emails) {
+    cookies.push_back({email, next_uid(), "user"});
+    const size_t length = serialized_length(cookies.back());
+    batch.m_block_offsets.push_back(num_blocks);
+    batch.m_lengths.push_back(length);
+    num_blocks += pkcs7_padded_length(length) / BLOCK_SIZE_BYTES;
+  }
+  batch.m_block_offsets.push_back(num_blocks);
+  batch.m_blocks.resize(num_blocks);
+
+  for (size_t cookie_index = 0; cookie_index < cookies.size();
+       ++cookie_index) {
+    const size_t block_offset = batch.m_block_offsets[cookie_index];
+    const size_t padded_length =
+        (batch.m_block_offsets[cookie_index + 1] - block_offset) *
+        BLOCK_SIZE_BYTES;
+    uint8_t *cookie_bytes =
+        reinterpret_cast<uint8_t *>(&batch.m_blocks[block_offset]);
+    size_t num_written = 0;
+    serialize_profile_cookie(
+        cookies[cookie_index],
+        std::span{reinterpret_cast<char *>(cookie_bytes), padded_length},
+        num_written);
+    pad_pkcs7_in_place(std::span{cookie_bytes, padded_length}, num_written);
+  }
+  return batch;
+}
 
 std::string profile_for(const std::string &email) {
-  std::string encoded_email = c_ProfileCookie::encode_string(email);
-  return c_ProfileCookie(encoded_email).to_string();
+  // The serializer encodes the email, so it is only encoded once
+  return serialize_to_string(
+      {email, c_ProfileCookie::m_uid_allocator.allocate(), "user"});
 }
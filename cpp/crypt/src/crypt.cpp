@@ -1,7 +1,10 @@
 #include <crypt.hpp>
 
+#include <arena.hpp>
+
 #include <algorithm>
-#include <set>
+#include <array>
+#include <memory_resource>
 
 #include <algorithm>
 #include <bit>
@@ -14,35 +17,64 @@
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
 RawBytes encrypt_repeating_xor(const RawBytes &plain_text,
                                const RawBytes &key) {
   RawBytes output(plain_text);
+  xor_repeating_in_place(output, key);
+  return output;
+}
 
-  size_t key_pointer = 0;
-  for (auto &character : output) {
-    character ^= key[key_pointer];
-    ++key_pointer;
-    if (key_pointer == key.size()) {
-      key_pointer = 0;
-    }
+// Keys ordered best first by score, lowest key first on a tie
+static std::array<uint8_t, 256>
+rank_single_xor_keys(const std::array<double, 256> &scores,
+                     const size_t num_ranked) {
+  std::array<uint8_t, 256> output;
+  for (size_t key = 0; key < 256; ++key) {
+    output[key] = uint8_t(key);
   }
+  std::partial_sort(std::begin(output), std::begin(output) + num_ranked,
+                    std::end(output),
+                    [&scores](const uint8_t lhs, const uint8_t rhs) {
+                      return (scores[lhs] != scores[rhs])
+                                 ? scores[lhs] < scores[rhs]
+                                 : lhs < rhs;
+                    });
   return output;
 }
 
-std::pair<char, double> find_likely_single_xor(const RawBytes &input) {
+std::pair<char, double> find_likely_single_xor(const RawBytes &input,
+                                               const c_LanguageModel &model,
+                                               const ScoreMethod method) {
+  const std::array<double, 256> scores =
+      score_single_xor_keys(gen_histogram(input), model, method);
+  if (method != ScoreMethod::log_likelihood) {
+    const uint8_t winner = rank_single_xor_keys(scores, 1)[0];
+    return std::make_pair(char(winner), scores[winner]);
+  }
+
+  const std::array<uint8_t, 256> ranked_keys =
+      rank_single_xor_keys(scores, SINGLE_XOR_RESCORED_KEYS);
+  c_ScratchScope scope;
+  ScratchBytes xord_output(std::begin(input), std::end(input),
+                           scratch_resource());
+  uint8_t applied_key = 0;
   double score = std::numeric_limits<double>::max();
   char winner = 0;
-  for (size_t iter = 0; iter < 256; ++iter) {
-    RawBytes xord_output = input ^ char(iter);
-    FreqMap freq_map = gen_frequency(xord_output);
-    double test_score = score_freq(freq_map);
+  for (size_t rank = 0; rank < SINGLE_XOR_RESCORED_KEYS; ++rank) {
+    // Step from the previous key to this one, in place
+    const uint8_t key = ranked_keys[rank];
+    xor_in_place(xord_output, uint8_t(key ^ applied_key));
+    applied_key = key;
+    const double test_score = score_text(xord_output, model);
     if (test_score < score) {
       score = test_score;
-      winner = char(iter);
+      winner = char(key);
     }
   }
   return std::make_pair(winner, score);
@@ -105,135 +137,149 @@ size_t find_likely_key_length(const RawBytes &input, const size_t lower_bound,
   return best_key_length;
 }
 
-RawBytes find_likely_key(const RawBytes &input, const size_t key_length) {
+RawBytes find_likely_key(const RawBytes &input, const size_t key_length,
+                         const c_LanguageModel &model,
+                         const ScoreMethod method) {
   RawBytes key;
   key.reserve(key_length);
+  for (const auto &histogram : gen_column_histograms(input, key_length)) {
+    const std::array<double, 256> scores =
+        score_single_xor_keys(histogram, model, method);
+    key.push_back(rank_single_xor_keys(scores, 1)[0]);
+  }
+  return key;
+}
 
-  const size_t longest_striping =
-      std::ceil<size_t>(double(input.size()) / key_length);
+size_t find_repeated_block(const ByteSpan input,
+                           const size_t block_size_bytes) {
+  c_ScratchScope scope;
+  const size_t num_blocks = input.size() / block_size_bytes;
+  // Views of the blocks in place, hashed as strings
+  std::pmr::unordered_set<std::string_view> already_seen(scratch_resource());
+  already_seen.reserve(num_blocks);
+  for (size_t block_index = 0; block_index < num_blocks; ++block_index) {
+    const std::string_view block(
+        reinterpret_cast<const char *>(input.data()) +
+            block_index * block_size_bytes,
+        block_size_bytes);
+    if (!already_seen.insert(block).second) {
+      return block_index;
+    }
+  }
+  return num_blocks;
+}
 
-  RawBytes scratch_space;
-  scratch_space.reserve(longest_striping);
+bool detect_ecb(const RawBytes &input) {
+  return find_repeated_block(input, BLOCK_SIZE_BYTES) <
+         input.size() / BLOCK_SIZE_BYTES;
+}
 
-  for (size_t iter = 0; iter < key_length; ++iter) {
+size_t get_byte_at_a_time_prefix_length(const size_t block_size_bytes,
+                                        const size_t byte_index) {
+  return (int(block_size_bytes) - 1 - int(byte_index)) % block_size_bytes;
+}
 
-    for (size_t input_ptr = 0; input_ptr < input.size(); ++input_ptr) {
-      if ((input_ptr % key_length) == iter) {
-        scratch_space.push_back(input[input_ptr]);
-      }
+CandidateOrder get_byte_at_a_time_candidate_order(
+    const c_CandidateModel &model, const bool use_candidate_model,
+    const RawBytes &decrypted_raw, const size_t byte_index) {
+  if (!use_candidate_model) {
+    CandidateOrder numeric_order;
+    for (size_t byte = 0; byte < 256; ++byte) {
+      numeric_order[byte] = uint8_t(byte);
     }
-
-    const auto [character, _] = find_likely_single_xor(scratch_space);
-
-    key.push_back(character);
-    scratch_space.clear();
+    return numeric_order;
   }
-
-  return key;
+  if (byte_index == 0) {
+    return model.order();
+  }
+  return model.order(decrypted_raw[byte_index - 1]);
 }
 
-bool detect_ecb(const RawBytes &input) {
-  const size_t num_blocks = input.size() / BLOCK_SIZE_BYTES;
+RawBytes gen_byte_at_a_time_dictionary(const size_t block_size_bytes,
+                                       const RawBytes &decrypted_raw,
+                                       const size_t byte_index,
+                                       std::span<const uint8_t> candidates) {
+  RawBytes dictionary_raw(candidates.size() * block_size_bytes);
+  gen_byte_at_a_time_dictionary(block_size_bytes, decrypted_raw, byte_index,
+                                candidates, dictionary_raw);
+  return dictionary_raw;
+}
 
-  std::set<RawBytes> already_seen;
+void gen_byte_at_a_time_dictionary(const size_t block_size_bytes,
+                                   const RawBytes &decrypted_raw,
+                                   const size_t byte_index,
+                                   std::span<const uint8_t> candidates,
+                                   std::span<uint8_t> dictionary) {
+  if (dictionary.size() < candidates.size() * block_size_bytes) {
+    throw std::invalid_argument("Dictionary is too small!");
+  }
+  if (candidates.empty()) {
+    return;
+  }
+  // The known bytes, left padded with the same filler the prefixes use
+  const auto window = dictionary.first(block_size_bytes - 1);
+  const size_t num_known = std::min(byte_index, block_size_bytes - 1);
+  std::fill(std::begin(window), std::end(window) - num_known, 'X');
+  std::copy(std::begin(decrypted_raw) + (byte_index - num_known),
+            std::begin(decrypted_raw) + byte_index,
+            std::end(window) - num_known);
+
+  for (size_t index = 0; index < candidates.size(); ++index) {
+    uint8_t *block = dictionary.data() + (index * block_size_bytes);
+    if (index > 0) {
+      std::copy(std::begin(window), std::end(window), block);
+    }
+    block[block_size_bytes - 1] = candidates[index];
+  }
+}
 
-  for (size_t block_index = 0; block_index < num_blocks; ++block_index) {
-    const auto block_begin = input.begin() + (block_index * BLOCK_SIZE_BYTES);
-    const auto block_end =
-        input.begin() + ((block_index + 1) * BLOCK_SIZE_BYTES);
-    const RawBytes block(block_begin, block_end);
+double c_ByteAtATimeStats::expected_oracle_calls_per_byte() const {
+  if (m_bytes_recovered == 0) {
+    return 0.0;
+  }
+  return double(m_serial_oracle_calls) / m_bytes_recovered;
+}
 
-    if (already_seen.count(block) == 1) {
-      return true;
-    }
-    already_seen.insert(block);
+double c_ByteAtATimeStats::oracle_calls_per_byte() const {
+  if (m_bytes_recovered == 0) {
+    return 0.0;
   }
-  return false;
+  return double(m_oracle_calls) / m_bytes_recovered;
 }
 
-size_t detect_block_size(std::function<RawBytes(RawBytes)> encrypt_func) {
-  size_t block_size = 1;
-  size_t last_length = encrypt_func(RawBytes(block_size, 'X')).size();
-  ++block_size;
-  while (true) {
-    const RawBytes test_raw(block_size, 'X');
+double c_PaddingOracleStats::oracle_calls_per_byte() const {
+  if (m_bytes_recovered == 0) {
+    return 0.0;
+  }
+  return double(m_oracle_calls) / m_bytes_recovered;
+}
 
-    size_t new_length = encrypt_func(test_raw).size();
-    if (new_length > last_length) {
-      return block_size;
+CandidateOrder get_padding_oracle_plaintext_order(
+    const CandidateOrder &prior_order, const RawBytes &block_plaintext_raw,
+    const size_t byte_index, const bool is_final_block) {
+  const size_t block_size_bytes = block_plaintext_raw.size();
+  std::vector<uint8_t> promoted;
+  if (is_final_block && byte_index + 1 == block_size_bytes) {
+    // The last byte of the message is a padding length
+    for (size_t pad_value = 1; pad_value <= block_size_bytes; ++pad_value) {
+      promoted.push_back(uint8_t(pad_value));
     }
-    ++block_size;
-  }
-}
-
-size_t
-detect_length_bytes(const size_t block_size_bytes,
-                    const RawBytes &target_plaintext_raw,
-                    std::function<RawBytes(RawBytes, RawBytes)> encrypt_func) {
-  size_t initial_length =
-      encrypt_func(target_plaintext_raw, RawBytes(0)).size();
-  for (size_t prefix_length = 1; prefix_length < block_size_bytes;
-       ++prefix_length) {
-    size_t new_length =
-        encrypt_func(target_plaintext_raw, RawBytes(prefix_length, 'X')).size();
-    if (new_length > initial_length) {
-      return initial_length - prefix_length;
+  } else if (is_final_block) {
+    const size_t pad_value = block_plaintext_raw.back();
+    if (pad_value <= block_size_bytes &&
+        byte_index >= block_size_bytes - pad_value) {
+      promoted.push_back(uint8_t(pad_value));
     }
   }
-  throw std::runtime_error("Could not find target length");
-  return 0;
-}
-
-RawBytes break_ecb_byte_at_a_time(const size_t block_size_bytes,
-                                  const size_t target_plaintext_length_bytes,
-                                  const c_AES128SecretKeyEncrypter &encrypter,
-                                  const RawBytes &target_plaintext_raw,
-                                  const bool display) {
-  RawBytes decrypted_raw(target_plaintext_length_bytes, 0);
-
-  std::vector<RawBytes> ciphertexts_raw;
-  ciphertexts_raw.reserve(block_size_bytes);
-  for (size_t prefix_length_bytes = 0; prefix_length_bytes < block_size_bytes;
-       ++prefix_length_bytes) {
-    const RawBytes test_prefix_raw = RawBytes(prefix_length_bytes, 'X');
-    ciphertexts_raw.push_back(
-        encrypter.encrypt(target_plaintext_raw, test_prefix_raw));
-  }
-
-  for (size_t byte_index = 0; byte_index < target_plaintext_length_bytes;
-       ++byte_index) {
-    const size_t prefix_length =
-        (int(block_size_bytes) - 1 - int(byte_index)) % block_size_bytes;
-    const size_t block_number = byte_index / block_size_bytes;
-
-    const RawBytes ciphertext_raw = ciphertexts_raw[prefix_length];
-
-    const ByteBlock block_of_interest =
-        from_raw_bytes_to_byte_block(ciphertext_raw, block_number);
-
-    RawBytes test_prefix_raw = RawBytes(prefix_length, 'X');
-    test_prefix_raw =
-        prepend_bytes(RawBytes(std::begin(decrypted_raw),
-                               std::begin(decrypted_raw) + byte_index),
-                      test_prefix_raw);
-    test_prefix_raw.push_back(0);
-    for (size_t test_byte = 0; test_byte < 256; ++test_byte) {
-      // Select which bytes to encrypt
-      test_prefix_raw.back() = test_byte;
-      const ByteBlock test_plaintext =
-          from_raw_bytes_to_byte_block(test_prefix_raw, block_number);
-      const ByteBlock test_block = encrypter.encrypt(test_plaintext);
-      if (block_of_interest == test_block) {
-        if (display) {
-          std::cout << char(test_byte) << std::flush;
-        }
-        decrypted_raw[byte_index] = test_byte;
-        break;
-      }
+
+  CandidateOrder output;
+  auto output_it = std::copy(std::begin(promoted), std::end(promoted),
+                             std::begin(output));
+  for (const uint8_t candidate : prior_order) {
+    if (std::find(std::begin(promoted), std::end(promoted), candidate) ==
+        std::end(promoted)) {
+      *output_it++ = candidate;
     }
   }
-  if (display) {
-    std::cout << std::endl;
-  }
-  return decrypted_raw;
+  return output;
 }
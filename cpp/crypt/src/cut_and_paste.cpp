@@ -0,0 +1,147 @@
+#include <cut_and_paste.hpp>
+
+#include <padding.hpp>
+#include <raw_bytes.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+static std::string_view block_view(const RawBytes &input,
+                                   const size_t block_index,
+                                   const size_t block_size_bytes) {
+  return {reinterpret_cast<const char *>(input.data()) +
+              block_index * block_size_bytes,
+          block_size_bytes};
+}
+
+static RawBytes pad_text(const std::string_view text,
+                         const size_t block_size_bytes) {
+  return add_pkcs7_padding(RawBytes(std::begin(text), std::end(text)),
+                           block_size_bytes);
+}
+
+c_CutAndPastePlan
+select_block_sources(const std::span<const std::string> probes,
+                     const std::span<const std::string> plaintexts,
+                     const std::string_view target,
+                     const size_t block_size_bytes) {
+  const RawBytes padded_target = pad_text(target, block_size_bytes);
+  const size_t num_target_blocks = padded_target.size() / block_size_bytes;
+
+  // Every place each wanted block can be cut from
+  std::unordered_map<std::string_view, std::vector<c_BlockSource>> sources;
+  for (size_t block_index = 0; block_index < num_target_blocks;
+       ++block_index) {
+    sources.try_emplace(
+        block_view(padded_target, block_index, block_size_bytes));
+  }
+  // Probe blocks are only looked up, so whole blocks are viewed in place and
+  // just the padded final block is built, in one reused buffer
+  std::string final_block;
+  for (size_t probe_index = 0; probe_index < plaintexts.size();
+       ++probe_index) {
+    const std::string_view plaintext = plaintexts[probe_index];
+    const size_t num_whole_blocks = plaintext.size() / block_size_bytes;
+    for (size_t block_index = 0; block_index <= num_whole_blocks;
+         ++block_index) {
+      std::string_view block;
+      if (block_index < num_whole_blocks) {
+        block = plaintext.substr(block_index * block_size_bytes,
+                                 block_size_bytes);
+      } else {
+        const size_t remainder = plaintext.size() % block_size_bytes;
+        final_block.assign(plaintext.substr(plaintext.size() - remainder));
+        final_block.resize(block_size_bytes,
+                           char(block_size_bytes - remainder));
+        block = final_block;
+      }
+      const auto found = sources.find(block);
+      if (found != std::end(sources)) {
+        found->second.push_back({probe_index, block_index});
+      }
+    }
+  }
+
+  // Greedy cover: take the probe supplying the most blocks still wanted
+  std::vector<c_BlockSource> chosen(num_target_blocks);
+  std::vector<bool> is_covered(num_target_blocks, false);
+  std::vector<size_t> probe_order;
+  size_t num_covered = 0;
+  while (num_covered < num_target_blocks) {
+    std::vector<size_t> counts(probes.size(), 0);
+    for (size_t block_index = 0; block_index < num_target_blocks;
+         ++block_index) {
+      if (is_covered[block_index]) {
+        continue;
+      }
+      const auto &block_sources = sources.at(
+          block_view(padded_target, block_index, block_size_bytes));
+      if (block_sources.empty()) {
+        throw std::invalid_argument(
+            "No probe puts target block " + std::to_string(block_index) +
+            " on a block boundary!");
+      }
+      // A probe counts once per wanted block however often it holds it
+      size_t last_probe = probes.size();
+      for (const c_BlockSource &source : block_sources) {
+        if (source.m_probe_index != last_probe) {
+          ++counts[source.m_probe_index];
+          last_probe = source.m_probe_index;
+        }
+      }
+    }
+    const size_t best_probe = size_t(
+        std::max_element(std::begin(counts), std::end(counts)) -
+        std::begin(counts));
+    for (size_t block_index = 0; block_index < num_target_blocks;
+         ++block_index) {
+      if (is_covered[block_index]) {
+        continue;
+      }
+      for (const c_BlockSource &source : sources.at(
+               block_view(padded_target, block_index, block_size_bytes))) {
+        if (source.m_probe_index == best_probe) {
+          chosen[block_index] = {probe_order.size(), source.m_block_index};
+          is_covered[block_index] = true;
+          ++num_covered;
+          break;
+        }
+      }
+    }
+    probe_order.push_back(best_probe);
+  }
+
+  c_CutAndPastePlan output;
+  for (const size_t probe_index : probe_order) {
+    output.m_probes.push_back(probes[probe_index]);
+  }
+  output.m_sources = std::move(chosen);
+  return output;
+}
+
+RawBytes splice_blocks(const std::span<const ByteSpan> ciphertexts,
+                       const std::span<const c_BlockSource> sources,
+                       const size_t block_size_bytes) {
+  RawBytes output(sources.size() * block_size_bytes);
+  auto output_position = std::begin(output);
+  for (const c_BlockSource &source : sources) {
+    const ByteSpan ciphertext = ciphertexts[source.m_probe_index];
+    if ((source.m_block_index + 1) * block_size_bytes > ciphertext.size()) {
+      throw std::out_of_range("Answer is too short for its block!");
+    }
+    output_position = std::ranges::copy(
+                          ciphertext.subspan(source.m_block_index *
+                                                 block_size_bytes,
+                                             block_size_bytes),
+                          output_position)
+                          .out;
+  }
+  return output;
+}
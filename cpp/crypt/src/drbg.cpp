@@ -0,0 +1,130 @@
+#include <drbg.hpp>
+
+#include <sys/random.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+
+void get_os_entropy(std::span<uint8_t> output) {
+  while (!output.empty()) {
+    const ssize_t num_read = getrandom(output.data(), output.size(), 0);
+    if (num_read < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      throw std::runtime_error("getrandom failed!");
+    }
+    output = output.subspan(size_t(num_read));
+  }
+}
+
+static DrbgSeed gen_os_seed() {
+  DrbgSeed seed_material;
+  get_os_entropy(seed_material);
+  return seed_material;
+}
+
+static DrbgSeed gen_deterministic_seed(const uint64_t seed) {
+  DrbgSeed seed_material{};
+  for (size_t byte_index = 0; byte_index < sizeof(seed); ++byte_index) {
+    seed_material[byte_index] = uint8_t(seed >> (8 * byte_index));
+  }
+  return seed_material;
+}
+
+c_CtrDrbg::c_CtrDrbg() : c_CtrDrbg(gen_os_seed(), false) {}
+
+c_CtrDrbg::c_CtrDrbg(const uint64_t seed)
+    : c_CtrDrbg(gen_deterministic_seed(seed), true) {}
+
+c_CtrDrbg::c_CtrDrbg(const DrbgSeed &seed_material,
+                     const bool is_deterministic)
+    : m_key_schedule(gen_key_schedule(AES128Key{}))
+    , m_counter{}
+    , m_reseed_counter(1)
+    , m_is_deterministic(is_deterministic) {
+  update(seed_material);
+}
+
+void c_CtrDrbg::generate(std::span<uint8_t> output) {
+  while (!output.empty()) {
+    // A deterministic stream has to stay reproducible, so it never reseeds
+    if (!m_is_deterministic && m_reseed_counter > CTR_DRBG_RESEED_INTERVAL) {
+      reseed(gen_os_seed());
+    }
+    const size_t num_bytes =
+        std::min(output.size(), CTR_DRBG_MAX_REQUEST_BYTES);
+    generate_step(output.first(num_bytes));
+    output = output.subspan(num_bytes);
+  }
+}
+
+void c_CtrDrbg::reseed(const DrbgSeed &entropy) {
+  update(entropy);
+  m_reseed_counter = 1;
+}
+
+void c_CtrDrbg::generate_step(std::span<uint8_t> output) {
+  std::array<ByteBlock, CTR_DRBG_BATCH_BLOCKS> counters;
+  std::array<ByteBlock, CTR_DRBG_BATCH_BLOCKS> keystream;
+
+  while (!output.empty()) {
+    const size_t num_blocks =
+        std::min(CTR_DRBG_BATCH_BLOCKS,
+                 (output.size() + BLOCK_SIZE_BYTES - 1) / BLOCK_SIZE_BYTES);
+    for (size_t block_index = 0; block_index < num_blocks; ++block_index) {
+      increment_counter();
+      counters[block_index] = m_counter;
+    }
+    AES_cipher_blocks<AES128KeySchedule>(
+        std::span{counters}.first(num_blocks),
+        std::span{keystream}.first(num_blocks), m_key_schedule);
+
+    const size_t num_bytes =
+        std::min(output.size(), num_blocks * BLOCK_SIZE_BYTES);
+    std::memcpy(output.data(), keystream.data(), num_bytes);
+    output = output.subspan(num_bytes);
+  }
+
+  update(DrbgSeed{});
+  ++m_reseed_counter;
+}
+
+void c_CtrDrbg::update(const DrbgSeed &provided_data) {
+  constexpr size_t SEED_LENGTH_BLOCKS =
+      CTR_DRBG_SEED_LENGTH_BYTES / BLOCK_SIZE_BYTES;
+  std::array<ByteBlock, SEED_LENGTH_BLOCKS> counters;
+  std::array<ByteBlock, SEED_LENGTH_BLOCKS> temp;
+  for (auto &counter : counters) {
+    increment_counter();
+    counter = m_counter;
+  }
+  AES_cipher_blocks<AES128KeySchedule>(counters, temp, m_key_schedule);
+
+  uint8_t *temp_bytes = reinterpret_cast<uint8_t *>(temp.data());
+  for (size_t byte_index = 0; byte_index < CTR_DRBG_SEED_LENGTH_BYTES;
+       ++byte_index) {
+    temp_bytes[byte_index] ^= provided_data[byte_index];
+  }
+
+  // The leftmost bytes become the new key, the rest the new counter
+  AES128Key key;
+  to_word_array<ByteSpan, AES_128_KEY_LENGTH_WORDS>(
+      ByteSpan{temp_bytes, CTR_DRBG_SEED_LENGTH_BYTES}, key, 0);
+  m_key_schedule = gen_key_schedule(key);
+  m_counter = temp.back();
+}
+
+void c_CtrDrbg::increment_counter() {
+  // The counter is a big-endian 128 bit integer
+  uint8_t *counter_bytes = reinterpret_cast<uint8_t *>(&m_counter);
+  for (size_t byte_index = BLOCK_SIZE_BYTES; byte_index-- > 0;) {
+    if (++counter_bytes[byte_index] != 0) {
+      break;
+    }
+  }
+}
@@ -0,0 +1,305 @@
+#include <fixed_nonce.hpp>
+
+#include <analysis.hpp>
+#include <arena.hpp>
+#include <parallel.hpp>
+#include <raw_bytes.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <numeric>
+#include <set>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+c_KeystreamMatrix::c_KeystreamMatrix(
+    const std::span<const RawBytes> ciphertexts)
+    : m_row_order(ciphertexts.size())
+    , m_row_ranks(ciphertexts.size()) {
+  std::iota(std::begin(m_row_order), std::end(m_row_order), size_t(0));
+  std::stable_sort(std::begin(m_row_order), std::end(m_row_order),
+                   [&ciphertexts](const size_t lhs, const size_t rhs) {
+                     return ciphertexts[lhs].size() > ciphertexts[rhs].size();
+                   });
+  for (size_t rank = 0; rank < m_row_order.size(); ++rank) {
+    m_row_ranks[m_row_order[rank]] = rank;
+  }
+
+  // Rows are longest first, so the depth of each column is found by walking
+  // the order backwards as the columns get longer
+  const size_t num_columns =
+      m_row_order.empty() ? 0 : ciphertexts[m_row_order.front()].size();
+  m_column_offsets.assign(num_columns + 1, 0);
+  size_t depth = m_row_order.size();
+  for (size_t column_index = 0; column_index < num_columns; ++column_index) {
+    while (ciphertexts[m_row_order[depth - 1]].size() <= column_index) {
+      --depth;
+    }
+    m_column_offsets[column_index + 1] = m_column_offsets[column_index] + depth;
+  }
+
+  m_bytes.resize(m_column_offsets.back());
+  for (size_t column_index = 0; column_index < num_columns; ++column_index) {
+    uint8_t *output = m_bytes.data() + m_column_offsets[column_index];
+    const size_t column_depth = this->column_depth(column_index);
+    for (size_t rank = 0; rank < column_depth; ++rank) {
+      output[rank] = ciphertexts[m_row_order[rank]][column_index];
+    }
+  }
+}
+
+size_t c_KeystreamMatrix::column_depth(const size_t column_index) const {
+  return m_column_offsets[column_index + 1] - m_column_offsets[column_index];
+}
+
+ByteSpan c_KeystreamMatrix::column(const size_t column_index) const {
+  return ByteSpan(m_bytes).subspan(m_column_offsets[column_index],
+                                   column_depth(column_index));
+}
+
+uint8_t c_KeystreamMatrix::at(const size_t row,
+                              const size_t column_index) const {
+  if (column_index >= row_length(row)) {
+    throw std::out_of_range("Column is past the end of the ciphertext!");
+  }
+  return m_bytes[m_column_offsets[column_index] + m_row_ranks[row]];
+}
+
+size_t c_KeystreamMatrix::row_length(const size_t row) const {
+  // The row reaches every column deeper than its rank
+  const size_t rank = m_row_ranks.at(row);
+  size_t low = 0;
+  size_t high = num_columns();
+  while (low < high) {
+    const size_t middle = (low + high) / 2;
+    if (column_depth(middle) > rank) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+  return low;
+}
+
+static std::array<uint8_t, 256>
+rank_column_keys(const std::array<double, 256> &scores,
+                 const size_t num_ranked) {
+  std::array<uint8_t, 256> output;
+  for (size_t key = 0; key < 256; ++key) {
+    output[key] = uint8_t(key);
+  }
+  std::partial_sort(std::begin(output), std::begin(output) + num_ranked,
+                    std::end(output),
+                    [&scores](const uint8_t lhs, const uint8_t rhs) {
+                      return (scores[lhs] != scores[rhs])
+                                 ? scores[lhs] < scores[rhs]
+                                 : lhs < rhs;
+                    });
+  return output;
+}
+
+static void decrypt_column(const ByteSpan column, const uint8_t key,
+                           ScratchBytes &output) {
+  output.assign(std::begin(column), std::end(column));
+  xor_in_place(output, key);
+}
+
+RawBytes recover_fixed_nonce_keystream(const c_KeystreamMatrix &matrix,
+                                       const c_LanguageModel &model,
+                                       const c_FixedNonceConfig &config) {
+  const size_t num_columns = matrix.num_columns();
+  RawBytes keystream(num_columns);
+  std::vector<std::array<uint8_t, FIXED_NONCE_RESCORED_KEYS>> candidates(
+      num_columns);
+
+  for_each_run(num_columns, config.m_num_threads,
+               [&](const size_t begin, const size_t end) {
+                 for (size_t column_index = begin; column_index < end;
+                      ++column_index) {
+                   const std::array<uint8_t, 256> ranked_keys =
+                       rank_column_keys(
+                           score_single_xor_keys(
+                               gen_histogram(matrix.column(column_index)),
+                               model, config.m_score_method),
+                           FIXED_NONCE_RESCORED_KEYS);
+                   std::copy_n(std::begin(ranked_keys),
+                               FIXED_NONCE_RESCORED_KEYS,
+                               std::begin(candidates[column_index]));
+                   keystream[column_index] = ranked_keys[0];
+                 }
+               });
+
+  // Every column reads the previous pass' keystream, so the columns stay
+  // independent and the result does not depend on the thread count
+  for (size_t pass = 0; pass < config.m_num_refinement_passes; ++pass) {
+    RawBytes refined_keystream(num_columns);
+    for_each_run(
+        num_columns, config.m_num_threads,
+        [&](const size_t begin, const size_t end) {
+          c_ScratchScope scope;
+          ScratchBytes previous(scratch_resource());
+          ScratchBytes current(scratch_resource());
+          ScratchBytes next(scratch_resource());
+          for (size_t column_index = begin; column_index < end;
+               ++column_index) {
+            if (column_index > 0) {
+              decrypt_column(matrix.column(column_index - 1),
+                             keystream[column_index - 1], previous);
+            }
+            if (column_index + 1 < num_columns) {
+              decrypt_column(matrix.column(column_index + 1),
+                             keystream[column_index + 1], next);
+            }
+            double best_score = 0.0;
+            for (size_t candidate_index = 0;
+                 candidate_index < FIXED_NONCE_RESCORED_KEYS;
+                 ++candidate_index) {
+              const uint8_t key = candidates[column_index][candidate_index];
+              decrypt_column(matrix.column(column_index), key, current);
+              double score = 0.0;
+              for (const uint8_t byte : current) {
+                score += model.m_log_probabilities[byte];
+              }
+              if (column_index > 0) {
+                score +=
+                    pairwise_bigram_log_likelihood(previous, current, model);
+              }
+              if (column_index + 1 < num_columns) {
+                score += pairwise_bigram_log_likelihood(current, next, model);
+              }
+              if (candidate_index == 0 || score > best_score) {
+                best_score = score;
+                refined_keystream[column_index] = key;
+              }
+            }
+          }
+        });
+    keystream = std::move(refined_keystream);
+  }
+  return keystream;
+}
+
+std::vector<c_CribPlacement> drag_crib(const c_KeystreamMatrix &matrix,
+                                       const ByteSpan crib,
+                                       const size_t max_placements,
+                                       const c_LanguageModel &model,
+                                       const c_FixedNonceConfig &config) {
+  if (crib.empty()) {
+    throw std::invalid_argument("Crib is empty!");
+  }
+  const size_t num_columns = matrix.num_columns();
+  if (crib.size() > num_columns) {
+    return {};
+  }
+
+  // Bits each key costs a column over its best key, for every byte in it, so
+  // that a placement is charged for the rows it makes less like the model.
+  // Deep columns carry the most weight; they have the most rows to disagree.
+  std::vector<std::array<double, 256>> column_costs(num_columns);
+  for_each_run(num_columns, config.m_num_threads,
+               [&](const size_t begin, const size_t end) {
+                 for (size_t column_index = begin; column_index < end;
+                      ++column_index) {
+                   auto &costs = column_costs[column_index];
+                   costs = score_single_xor_keys(
+                       gen_histogram(matrix.column(column_index)), model);
+                   const double best_score =
+                       *std::min_element(std::begin(costs), std::end(costs));
+                   const double depth =
+                       double(matrix.column_depth(column_index));
+                   for (double &cost : costs) {
+                     cost = (cost - best_score) * depth;
+                   }
+                 }
+               });
+
+  // Each worker scores every placement in its run of rows
+  const size_t num_rows = matrix.num_rows();
+  std::vector<std::vector<c_CribPlacement>> row_placements(num_rows);
+  for_each_run(num_rows, config.m_num_threads,
+               [&](const size_t begin, const size_t end) {
+                 for (size_t row = begin; row < end; ++row) {
+                   const size_t rank = matrix.m_row_ranks[row];
+                   const size_t row_length = matrix.row_length(row);
+                   for (size_t column_index = 0;
+                        column_index + crib.size() <= row_length;
+                        ++column_index) {
+                     double score = 0.0;
+                     for (size_t index = 0; index < crib.size(); ++index) {
+                       const size_t crib_column = column_index + index;
+                       const uint8_t key =
+                           matrix.m_bytes[matrix.m_column_offsets[crib_column] +
+                                          rank] ^
+                           crib[index];
+                       score += column_costs[crib_column][key];
+                     }
+                     row_placements[row].push_back(
+                         {row, column_index, score});
+                   }
+                 }
+               });
+
+  std::vector<c_CribPlacement> placements;
+  for (auto &placements_in_row : row_placements) {
+    placements.insert(std::end(placements), std::begin(placements_in_row),
+                      std::end(placements_in_row));
+    placements_in_row = {};
+  }
+  std::stable_sort(std::begin(placements), std::end(placements),
+                   [](const c_CribPlacement &lhs, const c_CribPlacement &rhs) {
+                     return lhs.m_score < rhs.m_score;
+                   });
+
+  std::vector<c_CribPlacement> output;
+  std::set<std::pair<size_t, RawBytes>> seen_keystreams;
+  RawBytes implied_keystream;
+  for (const auto &placement : placements) {
+    if (output.size() >= max_placements) {
+      break;
+    }
+    implied_keystream.assign(num_columns, 0);
+    apply_crib(matrix, placement, crib, implied_keystream);
+    implied_keystream.erase(std::begin(implied_keystream),
+                            std::begin(implied_keystream) +
+                                placement.m_column);
+    implied_keystream.resize(crib.size());
+    if (seen_keystreams.emplace(placement.m_column, implied_keystream)
+            .second) {
+      output.push_back(placement);
+    }
+  }
+  return output;
+}
+
+void apply_crib(const c_KeystreamMatrix &matrix,
+                const c_CribPlacement &placement, const ByteSpan crib,
+                RawBytes &keystream) {
+  if (placement.m_column + crib.size() > matrix.row_length(placement.m_row)) {
+    throw std::out_of_range("Crib runs past the end of the ciphertext!");
+  }
+  if (keystream.size() < placement.m_column + crib.size()) {
+    keystream.resize(placement.m_column + crib.size());
+  }
+  for (size_t index = 0; index < crib.size(); ++index) {
+    const size_t column_index = placement.m_column + index;
+    keystream[column_index] =
+        matrix.at(placement.m_row, column_index) ^ crib[index];
+  }
+}
+
+std::vector<RawBytes>
+decrypt_fixed_nonce(const std::span<const RawBytes> ciphertexts,
+                    const ByteSpan keystream) {
+  std::vector<RawBytes> output;
+  output.reserve(ciphertexts.size());
+  for (const auto &ciphertext : ciphertexts) {
+    const size_t length = std::min(ciphertext.size(), keystream.size());
+    output.emplace_back(std::begin(ciphertext),
+                        std::begin(ciphertext) + length);
+    xor_in_place(output.back(), keystream.first(length));
+  }
+  return output;
+}
@@ -14,7 +14,7 @@
 #include <unordered_map>
 #include <utility>
 
-FreqMap gen_frequency(const RawBytes &input) {
+FreqMap gen_frequency(const ByteSpan input) {
   FreqMap output(english_freq_map);
   double valid = 0;
   for (auto &[_, value] : output) {
@@ -48,3 +48,74 @@ double score_freq(const FreqMap &input) {
   }
   return accumulate;
 }
+
+constexpr inline double UPPER_CASE_WEIGHT = 0.1;
+constexpr inline double TRANSITION_WEIGHT = 1.0;
+
+c_CandidateModel::c_CandidateModel(const FreqMap &freq_map) {
+  size_t num_other_printable = 0;
+  for (size_t byte = 0; byte < 256; ++byte) {
+    const char character = char(byte);
+    const bool is_printable = std::isprint(byte) || character == '\n';
+    if (freq_map.find(character) == freq_map.end() &&
+        freq_map.find(char(std::tolower(byte))) == freq_map.end() &&
+        is_printable) {
+      ++num_other_printable;
+    }
+  }
+
+  const auto other_entry = freq_map.find('?');
+  const double other_weight =
+      (other_entry == freq_map.end() || num_other_printable == 0)
+          ? 0.0
+          : other_entry->second / double(num_other_printable);
+
+  for (size_t byte = 0; byte < 256; ++byte) {
+    const char character = char(byte);
+    const auto entry = freq_map.find(character);
+    const auto lower_entry = freq_map.find(char(std::tolower(byte)));
+    if (entry != freq_map.end() && character != '?') {
+      m_prior[byte] = entry->second;
+    } else if (lower_entry != freq_map.end() && std::isupper(byte)) {
+      m_prior[byte] = lower_entry->second * UPPER_CASE_WEIGHT;
+    } else if (std::isprint(byte) || character == '\n') {
+      m_prior[byte] = other_weight;
+    } else {
+      m_prior[byte] = 0.0;
+    }
+  }
+}
+
+CandidateOrder sort_candidates(const std::array<double, 256> &score) {
+  CandidateOrder output;
+  for (size_t byte = 0; byte < 256; ++byte) {
+    output[byte] = uint8_t(byte);
+  }
+  std::stable_sort(std::begin(output), std::end(output),
+                   [&score](const uint8_t lhs, const uint8_t rhs) {
+                     return score[lhs] > score[rhs];
+                   });
+  return output;
+}
+
+CandidateOrder c_CandidateModel::order(const uint8_t previous_byte) const {
+  std::array<double, 256> score(m_prior);
+  const uint32_t total = m_transition_totals[previous_byte];
+  if (total > 0) {
+    for (size_t byte = 0; byte < 256; ++byte) {
+      score[byte] += TRANSITION_WEIGHT *
+                     (double(m_transition_counts[previous_byte][byte]) / total);
+    }
+  }
+  return sort_candidates(score);
+}
+
+CandidateOrder c_CandidateModel::order() const {
+  return sort_candidates(m_prior);
+}
+
+void c_CandidateModel::observe(const uint8_t previous_byte,
+                               const uint8_t next_byte) {
+  ++m_transition_counts[previous_byte][next_byte];
+  ++m_transition_totals[previous_byte];
+}
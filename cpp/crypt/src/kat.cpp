@@ -0,0 +1,254 @@
+#include <kat.hpp>
+
+#include <aes.hpp>
+#include <block.hpp>
+#include <cipher.hpp>
+#include <mode.hpp>
+#include <raw_bytes.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <istream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+static KATMode kat_mode_from_name(const std::string &name) {
+  std::string upper_name = name;
+  std::transform(upper_name.begin(), upper_name.end(), upper_name.begin(),
+                 [](const unsigned char input) { return std::toupper(input); });
+  if (upper_name.find("MCT") != std::string::npos) {
+    throw std::invalid_argument("Monte Carlo KAT files are not supported: " +
+                                name);
+  }
+  if (upper_name.starts_with("ECB")) {
+    return KATMode::ecb;
+  } else if (upper_name.starts_with("CBC")) {
+    return KATMode::cbc;
+  } else if (upper_name.starts_with("CTR")) {
+    return KATMode::ctr;
+  } else if (upper_name.starts_with("KEYEXPANSION")) {
+    return KATMode::key_expansion;
+  }
+  throw std::invalid_argument("No supported mode in KAT file name: " + name);
+}
+
+static std::string_view trim(std::string_view input) {
+  const auto is_space = [](const unsigned char input) {
+    return std::isspace(input) != 0;
+  };
+  while (!input.empty() && is_space(input.front())) {
+    input.remove_prefix(1);
+  }
+  while (!input.empty() && is_space(input.back())) {
+    input.remove_suffix(1);
+  }
+  return input;
+}
+
+static void validate_kat_vector(const c_KATFile &file,
+                                const c_KATVector &vector) {
+  const auto fail = [&file, &vector](const std::string &reason) {
+    throw std::invalid_argument(file.m_name + " COUNT = " +
+                                std::to_string(vector.m_count) + ": " +
+                                reason);
+  };
+  const size_t key_length_words = vector.m_key.size() / WORD_SIZE_BYTES;
+  if (vector.m_key.size() % WORD_SIZE_BYTES != 0 ||
+      (key_length_words != AES_128_KEY_LENGTH_WORDS &&
+       key_length_words != AES_192_KEY_LENGTH_WORDS &&
+       key_length_words != AES_256_KEY_LENGTH_WORDS)) {
+    fail("KEY is not 16, 24 or 32 bytes");
+  }
+  if (file.m_mode == KATMode::key_expansion) {
+    if (vector.m_expanded_key.empty()) {
+      fail("missing EXPANDED");
+    }
+    return;
+  }
+  if (vector.m_plaintext.size() != vector.m_ciphertext.size()) {
+    fail("PLAINTEXT and CIPHERTEXT differ in length");
+  }
+  if (file.m_mode != KATMode::ctr &&
+      vector.m_plaintext.size() % BLOCK_SIZE_BYTES != 0) {
+    fail("PLAINTEXT is not a whole number of blocks");
+  }
+  if (file.m_mode != KATMode::ecb && vector.m_iv.size() != BLOCK_SIZE_BYTES) {
+    fail("IV is not one block");
+  }
+}
+
+c_KATFile parse_kat_file(std::istream &input, const std::string &name) {
+  c_KATFile file;
+  file.m_name = name;
+  file.m_mode = kat_mode_from_name(name);
+
+  KATDirection direction = KATDirection::encrypt;
+  bool has_vector = false;
+  c_KATVector vector;
+  const auto finish_vector = [&] {
+    if (has_vector) {
+      validate_kat_vector(file, vector);
+      file.m_vectors.push_back(std::move(vector));
+    }
+    vector = c_KATVector{};
+    has_vector = false;
+  };
+
+  std::string line;
+  while (std::getline(input, line)) {
+    const std::string_view text = trim(line);
+    if (text.empty() || text.front() == '#') {
+      continue;
+    }
+    if (text.front() == '[') {
+      // Other sections, such as [KEYSIZE = 128], carry nothing we need
+      if (text == "[ENCRYPT]") {
+        finish_vector();
+        direction = KATDirection::encrypt;
+      } else if (text == "[DECRYPT]") {
+        finish_vector();
+        direction = KATDirection::decrypt;
+      }
+      continue;
+    }
+
+    const size_t separator = text.find('=');
+    if (separator == std::string_view::npos) {
+      throw std::invalid_argument(name + ": expected NAME = value, got " +
+                                  std::string(text));
+    }
+    const std::string_view field = trim(text.substr(0, separator));
+    const std::string value(trim(text.substr(separator + 1)));
+    if (field == "COUNT") {
+      finish_vector();
+      has_vector = true;
+      vector.m_direction = direction;
+      vector.m_count = std::stoul(value);
+    } else if (!has_vector) {
+      throw std::invalid_argument(name + ": " + std::string(field) +
+                                  " before COUNT");
+    } else if (field == "KEY") {
+      vector.m_key = from_hex_string(value);
+    } else if (field == "IV") {
+      vector.m_iv = from_hex_string(value);
+    } else if (field == "PLAINTEXT") {
+      vector.m_plaintext = from_hex_string(value);
+    } else if (field == "CIPHERTEXT") {
+      vector.m_ciphertext = from_hex_string(value);
+    } else if (field == "EXPANDED") {
+      vector.m_expanded_key = from_hex_string(value);
+    } else {
+      throw std::invalid_argument(name + ": unknown field " +
+                                  std::string(field));
+    }
+  }
+  finish_vector();
+  return file;
+}
+
+c_KATFile load_kat_file(const std::string &path) {
+  std::ifstream input(path, std::ios::in);
+  if (!input.is_open()) {
+    throw std::runtime_error("Couldn't open file: " + path);
+  }
+  return parse_kat_file(input, std::filesystem::path(path).filename());
+}
+
+template <typename KeyType> RawBytes expand_kat_key(const RawBytes &key_raw) {
+  const auto key_schedule = gen_key_schedule(gen_key<KeyType>(key_raw));
+  RawBytes output;
+  for (const auto &word : key_schedule) {
+    output.insert(output.end(), word.begin(), word.end());
+  }
+  return output;
+}
+
+static RawBytes expand_kat_key(const RawBytes &key_raw) {
+  switch (key_raw.size()) {
+  case AES_128_KEY_LENGTH_WORDS * WORD_SIZE_BYTES:
+    return expand_kat_key<AES128Key>(key_raw);
+  case AES_192_KEY_LENGTH_WORDS * WORD_SIZE_BYTES:
+    return expand_kat_key<AES192Key>(key_raw);
+  default:
+    return expand_kat_key<AES256Key>(key_raw);
+  }
+}
+
+static bool run_kat_vector(const c_CipherBackend &backend, const KATMode mode,
+                           const c_KATVector &vector) {
+  const std::unique_ptr<c_BlockCipher> cipher =
+      backend.m_factory(vector.m_key);
+  const bool is_encrypt = vector.m_direction == KATDirection::encrypt;
+  const RawBytes &input = is_encrypt ? vector.m_plaintext : vector.m_ciphertext;
+  const RawBytes &expected =
+      is_encrypt ? vector.m_ciphertext : vector.m_plaintext;
+
+  RawBytes output(input.size());
+  switch (mode) {
+  case KATMode::ecb:
+    if (is_encrypt) {
+      cipher->encrypt_blocks(input.data(), output.data(),
+                             input.size() / BLOCK_SIZE_BYTES);
+    } else {
+      cipher->decrypt_blocks(input.data(), output.data(),
+                             input.size() / BLOCK_SIZE_BYTES);
+    }
+    break;
+  case KATMode::cbc: {
+    // KAT messages are whole blocks, so there is no padding
+    ByteBlock chain = from_raw_bytes_to_byte_block(vector.m_iv);
+    if (is_encrypt) {
+      CBC_encrypt_blocks(*cipher, chain, input, output);
+    } else {
+      CBC_decrypt_blocks(*cipher, chain, input, output);
+    }
+    break;
+  }
+  case KATMode::ctr:
+    CTR_crypt(*cipher, from_raw_bytes_to_byte_block(vector.m_iv), input,
+              output);
+    break;
+  case KATMode::key_expansion:
+    break;
+  }
+  return output == expected;
+}
+
+static void record_kat_vector(const c_KATFile &file,
+                              const c_KATVector &vector, const bool is_passed,
+                              c_KATResult &result) {
+  if (is_passed) {
+    ++result.m_num_passed;
+  } else {
+    result.m_failures.push_back(
+        {file.m_name, vector.m_direction, vector.m_count});
+  }
+}
+
+void run_kat_file(const c_CipherBackend &backend, const c_KATFile &file,
+                  c_KATResult &result) {
+  if (file.m_mode == KATMode::key_expansion) {
+    return;
+  }
+  for (const c_KATVector &vector : file.m_vectors) {
+    record_kat_vector(file, vector,
+                      run_kat_vector(backend, file.m_mode, vector), result);
+  }
+}
+
+void run_kat_key_expansion_file(const c_KATFile &file, c_KATResult &result) {
+  if (file.m_mode != KATMode::key_expansion) {
+    return;
+  }
+  for (const c_KATVector &vector : file.m_vectors) {
+    record_kat_vector(file, vector,
+                      expand_kat_key(vector.m_key) == vector.m_expanded_key,
+                      result);
+  }
+}
@@ -0,0 +1,368 @@
+#include <mode.hpp>
+
+#include <padding.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+RawBytes ECB_encrypt(const c_BlockCipher &cipher,
+                     const RawBytes &plaintext_raw) {
+  RawBytes ciphertext_raw(pkcs7_padded_length(plaintext_raw.size()));
+  std::copy(std::begin(plaintext_raw), std::end(plaintext_raw),
+            std::begin(ciphertext_raw));
+  pad_pkcs7_in_place(ciphertext_raw, plaintext_raw.size());
+  cipher.encrypt_blocks(ciphertext_raw.data(), ciphertext_raw.data(),
+                        ciphertext_raw.size() / BLOCK_SIZE_BYTES);
+  return ciphertext_raw;
+}
+
+RawBytes ECB_decrypt(const c_BlockCipher &cipher,
+                     const RawBytes &ciphertext_raw) {
+  if (ciphertext_raw.size() % BLOCK_SIZE_BYTES != 0) {
+    throw std::invalid_argument("ECB ciphertext is not a whole number of "
+                                "blocks");
+  }
+  RawBytes plaintext_raw(ciphertext_raw.size());
+  cipher.decrypt_blocks(ciphertext_raw.data(), plaintext_raw.data(),
+                        ciphertext_raw.size() / BLOCK_SIZE_BYTES);
+  plaintext_raw.resize(strip_pkcs7_padding(plaintext_raw).size());
+  return plaintext_raw;
+}
+
+static void check_cbc_blocks(const ByteSpan input,
+                             const std::span<uint8_t> output) {
+  if (input.size() % BLOCK_SIZE_BYTES != 0) {
+    throw std::invalid_argument("CBC input is not a whole number of blocks");
+  }
+  if (output.size() < input.size()) {
+    throw std::invalid_argument("CBC output is too small!");
+  }
+}
+
+void CBC_encrypt_blocks(const c_BlockCipher &cipher, ByteBlock &chain,
+                        const ByteSpan input, const std::span<uint8_t> output) {
+  check_cbc_blocks(input, output);
+  c_PackedBlock chain_block = load_block(chain);
+  for (size_t offset = 0; offset < input.size(); offset += BLOCK_SIZE_BYTES) {
+    uint8_t *block = output.data() + offset;
+    store_block(chain_block ^ load_block(input.data() + offset), block);
+    cipher.encrypt_blocks(block, block, 1);
+    chain_block = load_block(block);
+  }
+  chain = to_byte_block(chain_block);
+}
+
+void CBC_decrypt_blocks(const c_BlockCipher &cipher, ByteBlock &chain,
+                        const ByteSpan input, const std::span<uint8_t> output) {
+  check_cbc_blocks(input, output);
+  if (input.empty()) {
+    return;
+  }
+  // Decryption has no chain to wait on, so every block goes in one call
+  cipher.decrypt_blocks(input.data(), output.data(),
+                        input.size() / BLOCK_SIZE_BYTES);
+  const size_t last_offset = input.size() - BLOCK_SIZE_BYTES;
+  xor_in_place(output.first(BLOCK_SIZE_BYTES),
+               ByteSpan{reinterpret_cast<const uint8_t *>(&chain),
+                        BLOCK_SIZE_BYTES});
+  xor_in_place(output.subspan(BLOCK_SIZE_BYTES, last_offset),
+               input.first(last_offset));
+  chain = from_raw_bytes_to_byte_block(input.subspan(last_offset));
+}
+
+RawBytes CBC_encrypt(const c_BlockCipher &cipher, const RawBytes &plaintext_raw,
+                     const ByteBlock &iv) {
+  RawBytes ciphertext_raw(pkcs7_padded_length(plaintext_raw.size()));
+  std::copy(std::begin(plaintext_raw), std::end(plaintext_raw),
+            std::begin(ciphertext_raw));
+  pad_pkcs7_in_place(ciphertext_raw, plaintext_raw.size());
+
+  ByteBlock chain = iv;
+  CBC_encrypt_blocks(cipher, chain, ciphertext_raw, ciphertext_raw);
+  return ciphertext_raw;
+}
+
+std::vector<RawBytes> CBC_encrypt_streams(const c_BlockCipher &cipher,
+                                          std::span<const RawBytes> plaintexts,
+                                          std::span<const ByteBlock> ivs) {
+  if (plaintexts.size() != ivs.size()) {
+    throw std::invalid_argument("Every CBC stream needs its own IV!");
+  }
+  const size_t num_streams = plaintexts.size();
+  std::vector<RawBytes> ciphertexts(num_streams);
+  for (size_t stream_index = 0; stream_index < num_streams; ++stream_index) {
+    const RawBytes &plaintext_raw = plaintexts[stream_index];
+    RawBytes &ciphertext_raw = ciphertexts[stream_index];
+    ciphertext_raw.resize(pkcs7_padded_length(plaintext_raw.size()));
+    std::copy(std::begin(plaintext_raw), std::end(plaintext_raw),
+              std::begin(ciphertext_raw));
+    pad_pkcs7_in_place(ciphertext_raw, plaintext_raw.size());
+  }
+
+  std::vector<size_t> num_blocks(num_streams);
+  for (size_t stream_index = 0; stream_index < num_streams; ++stream_index) {
+    num_blocks[stream_index] =
+        ciphertexts[stream_index].size() / BLOCK_SIZE_BYTES;
+  }
+  const c_ChainSchedule schedule(std::move(num_blocks));
+  const std::vector<size_t> &order = schedule.m_order;
+
+  // Slot i holds the chaining value of stream order[i], starting at its IV
+  RawBytes chains(num_streams * BLOCK_SIZE_BYTES);
+  for (size_t slot = 0; slot < num_streams; ++slot) {
+    store_block(load_block(ivs[order[slot]]),
+                chains.data() + (slot * BLOCK_SIZE_BYTES));
+  }
+
+  for (size_t block_index = 0;; ++block_index) {
+    const size_t num_active = schedule.num_running(block_index);
+    if (num_active == 0) {
+      break;
+    }
+    const size_t offset = block_index * BLOCK_SIZE_BYTES;
+    for (size_t slot = 0; slot < num_active; ++slot) {
+      uint8_t *chain = chains.data() + (slot * BLOCK_SIZE_BYTES);
+      store_block(load_block(chain) ^
+                      load_block(ciphertexts[order[slot]].data() + offset),
+                  chain);
+    }
+    cipher.encrypt_blocks(chains.data(), chains.data(), num_active);
+    for (size_t slot = 0; slot < num_active; ++slot) {
+      std::memcpy(ciphertexts[order[slot]].data() + offset,
+                  chains.data() + (slot * BLOCK_SIZE_BYTES), BLOCK_SIZE_BYTES);
+    }
+  }
+  return ciphertexts;
+}
+
+RawBytes CBC_decrypt(const c_BlockCipher &cipher,
+                     const RawBytes &ciphertext_raw, const ByteBlock &iv) {
+  if (ciphertext_raw.size() % BLOCK_SIZE_BYTES != 0) {
+    throw std::invalid_argument("CBC ciphertext is not a whole number of "
+                                "blocks");
+  }
+  RawBytes plaintext_raw(ciphertext_raw.size());
+  ByteBlock chain = iv;
+  CBC_decrypt_blocks(cipher, chain, ciphertext_raw, plaintext_raw);
+  plaintext_raw.resize(strip_pkcs7_padding(plaintext_raw).size());
+  return plaintext_raw;
+}
+
+// Increments the last NumBytes bytes of the block as a big-endian integer,
+// 16 for SP 800-38A CTR and 4 for the inc32 of GCM
+template <size_t NumBytes> void increment_counter(ByteBlock &counter) {
+  uint8_t *counter_bytes = reinterpret_cast<uint8_t *>(&counter);
+  for (size_t byte_index = BLOCK_SIZE_BYTES;
+       byte_index-- > BLOCK_SIZE_BYTES - NumBytes;) {
+    if (++counter_bytes[byte_index] != 0) {
+      break;
+    }
+  }
+}
+
+template <size_t CounterBytes>
+void counter_mode_xor(const c_BlockCipher &cipher, ByteBlock counter,
+                      ByteSpan input, std::span<uint8_t> output) {
+  if (output.size() < input.size()) {
+    throw std::invalid_argument("Counter mode output is too small!");
+  }
+  std::array<ByteBlock, CTR_BATCH_BLOCKS> keystream;
+  const uint8_t *keystream_bytes =
+      reinterpret_cast<const uint8_t *>(keystream.data());
+
+  for (size_t offset = 0; offset < input.size();
+       offset += CTR_BATCH_BLOCKS * BLOCK_SIZE_BYTES) {
+    const size_t num_bytes =
+        std::min(input.size() - offset, CTR_BATCH_BLOCKS * BLOCK_SIZE_BYTES);
+    const size_t num_blocks =
+        (num_bytes + BLOCK_SIZE_BYTES - 1) / BLOCK_SIZE_BYTES;
+    for (size_t block_index = 0; block_index < num_blocks; ++block_index) {
+      keystream[block_index] = counter;
+      increment_counter<CounterBytes>(counter);
+    }
+    cipher.encrypt_blocks(keystream_bytes,
+                          reinterpret_cast<uint8_t *>(keystream.data()),
+                          num_blocks);
+    for (size_t byte_index = 0; byte_index < num_bytes; ++byte_index) {
+      output[offset + byte_index] =
+          input[offset + byte_index] ^ keystream_bytes[byte_index];
+    }
+  }
+}
+
+void CTR_crypt(const c_BlockCipher &cipher, const ByteBlock &initial_counter,
+               ByteSpan input, std::span<uint8_t> output) {
+  counter_mode_xor<BLOCK_SIZE_BYTES>(cipher, initial_counter, input, output);
+}
+
+RawBytes CTR_crypt(const c_BlockCipher &cipher,
+                   const ByteBlock &initial_counter, const RawBytes &input) {
+  RawBytes output(input.size());
+  CTR_crypt(cipher, initial_counter, input, output);
+  return output;
+}
+
+// A GF(2^128) element in the bit order of SP 800-38D, where bit 0 is the
+// top bit of byte 0
+struct c_GhashBlock {
+  uint64_t m_high = 0;
+  uint64_t m_low = 0;
+};
+
+static uint64_t load_big_endian_64(const uint8_t *input) {
+  uint64_t output = 0;
+  for (size_t byte_index = 0; byte_index < sizeof(output); ++byte_index) {
+    output = (output << 8) | input[byte_index];
+  }
+  return output;
+}
+
+static void store_big_endian_64(const uint64_t input, uint8_t *output) {
+  for (size_t byte_index = 0; byte_index < sizeof(input); ++byte_index) {
+    output[byte_index] = uint8_t(input >> (8 * (7 - byte_index)));
+  }
+}
+
+static c_GhashBlock load_ghash_block(const uint8_t *input) {
+  return {load_big_endian_64(input), load_big_endian_64(input + 8)};
+}
+
+// Algorithm 1 of SP 800-38D, with masks in place of branches on the data
+static c_GhashBlock ghash_multiply(const c_GhashBlock &input_x,
+                                   const c_GhashBlock &input_y) {
+  constexpr uint64_t REDUCTION = uint64_t(0xe1) << 56;
+  c_GhashBlock output;
+  c_GhashBlock value = input_y;
+  for (size_t bit_index = 0; bit_index < 128; ++bit_index) {
+    const uint64_t word = (bit_index < 64) ? input_x.m_high : input_x.m_low;
+    const uint64_t bit = (word >> (63 - (bit_index % 64))) & 1;
+    output.m_high ^= value.m_high & (0 - bit);
+    output.m_low ^= value.m_low & (0 - bit);
+
+    const uint64_t carry = value.m_low & 1;
+    value.m_low = (value.m_low >> 1) | (value.m_high << 63);
+    value.m_high = (value.m_high >> 1) ^ (REDUCTION & (0 - carry));
+  }
+  return output;
+}
+
+struct c_Ghash {
+  c_Ghash(const c_GhashBlock &hash_key)
+      : m_hash_key(hash_key) {}
+
+  // Zero pads a partial final block
+  void update(const ByteSpan input) {
+    for (size_t offset = 0; offset < input.size();
+         offset += BLOCK_SIZE_BYTES) {
+      std::array<uint8_t, BLOCK_SIZE_BYTES> block{};
+      std::memcpy(block.data(), input.data() + offset,
+                  std::min(BLOCK_SIZE_BYTES, input.size() - offset));
+      const c_GhashBlock input_block = load_ghash_block(block.data());
+      m_state.m_high ^= input_block.m_high;
+      m_state.m_low ^= input_block.m_low;
+      m_state = ghash_multiply(m_state, m_hash_key);
+    }
+  }
+
+  void update_lengths(const size_t first_num_bytes,
+                      const size_t second_num_bytes) {
+    std::array<uint8_t, BLOCK_SIZE_BYTES> block;
+    store_big_endian_64(uint64_t(first_num_bytes) * 8, block.data());
+    store_big_endian_64(uint64_t(second_num_bytes) * 8, block.data() + 8);
+    update(block);
+  }
+
+  ByteBlock digest() const {
+    ByteBlock output;
+    uint8_t *output_bytes = reinterpret_cast<uint8_t *>(&output);
+    store_big_endian_64(m_state.m_high, output_bytes);
+    store_big_endian_64(m_state.m_low, output_bytes + 8);
+    return output;
+  }
+
+  const c_GhashBlock m_hash_key;
+  c_GhashBlock m_state;
+};
+
+static c_Ghash gen_ghash(const c_BlockCipher &cipher) {
+  std::array<uint8_t, BLOCK_SIZE_BYTES> hash_key{};
+  cipher.encrypt_blocks(hash_key.data(), hash_key.data(), 1);
+  return c_Ghash(load_ghash_block(hash_key.data()));
+}
+
+static ByteBlock gen_pre_counter_block(const c_BlockCipher &cipher,
+                                       const ByteSpan iv) {
+  ByteBlock pre_counter_block{};
+  uint8_t *block_bytes = reinterpret_cast<uint8_t *>(&pre_counter_block);
+  if (iv.size() == GCM_IV_LENGTH_BYTES) {
+    std::memcpy(block_bytes, iv.data(), iv.size());
+    block_bytes[BLOCK_SIZE_BYTES - 1] = 1;
+    return pre_counter_block;
+  }
+  c_Ghash ghash = gen_ghash(cipher);
+  ghash.update(iv);
+  ghash.update_lengths(0, iv.size());
+  return ghash.digest();
+}
+
+static ByteBlock gen_gcm_tag(const c_BlockCipher &cipher,
+                             const ByteBlock &pre_counter_block,
+                             const ByteSpan aad, const ByteSpan ciphertext) {
+  c_Ghash ghash = gen_ghash(cipher);
+  ghash.update(aad);
+  ghash.update(ciphertext);
+  ghash.update_lengths(aad.size(), ciphertext.size());
+
+  const ByteBlock hash = ghash.digest();
+  ByteBlock tag;
+  cipher.encrypt_blocks(reinterpret_cast<const uint8_t *>(&pre_counter_block),
+                        reinterpret_cast<uint8_t *>(&tag), 1);
+  return tag ^ hash;
+}
+
+RawBytes GCM_encrypt(const c_BlockCipher &cipher, const ByteSpan iv,
+                     const ByteSpan aad, const ByteSpan plaintext,
+                     ByteBlock &tag) {
+  const ByteBlock pre_counter_block = gen_pre_counter_block(cipher, iv);
+  ByteBlock counter = pre_counter_block;
+  increment_counter<WORD_SIZE_BYTES>(counter);
+
+  RawBytes ciphertext(plaintext.size());
+  counter_mode_xor<WORD_SIZE_BYTES>(cipher, counter, plaintext, ciphertext);
+  tag = gen_gcm_tag(cipher, pre_counter_block, aad, ciphertext);
+  return ciphertext;
+}
+
+bool GCM_decrypt(const c_BlockCipher &cipher, const ByteSpan iv,
+                 const ByteSpan aad, const ByteSpan ciphertext,
+                 const ByteBlock &tag, RawBytes &plaintext) {
+  plaintext.clear();
+  const ByteBlock pre_counter_block = gen_pre_counter_block(cipher, iv);
+  const ByteBlock expected_tag =
+      gen_gcm_tag(cipher, pre_counter_block, aad, ciphertext);
+
+  // Compare every byte, so the time taken says nothing about the tag
+  const ByteBlock difference = expected_tag ^ tag;
+  const uint8_t *difference_bytes =
+      reinterpret_cast<const uint8_t *>(&difference);
+  uint8_t accumulated = 0;
+  for (size_t byte_index = 0; byte_index < GCM_TAG_LENGTH_BYTES;
+       ++byte_index) {
+    accumulated |= difference_bytes[byte_index];
+  }
+  if (accumulated != 0) {
+    return false;
+  }
+
+  ByteBlock counter = pre_counter_block;
+  increment_counter<WORD_SIZE_BYTES>(counter);
+  plaintext.resize(ciphertext.size());
+  counter_mode_xor<WORD_SIZE_BYTES>(cipher, counter, ciphertext, plaintext);
+  return true;
+}
@@ -0,0 +1,99 @@
+#include <oracle.hpp>
+
+#include <rand.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+
+void c_LatencyHistogram::record(const std::chrono::nanoseconds latency) {
+  const uint64_t latency_ns = std::max<int64_t>(latency.count(), 0);
+  const size_t bucket = std::min<size_t>(std::bit_width(latency_ns),
+                                         LATENCY_HISTOGRAM_NUM_BUCKETS - 1);
+  m_buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+uint64_t c_LatencyHistogram::count() const {
+  uint64_t total = 0;
+  for (const auto &bucket : m_buckets) {
+    total += bucket.load(std::memory_order_relaxed);
+  }
+  return total;
+}
+
+std::chrono::nanoseconds
+c_LatencyHistogram::percentile(const double fraction) const {
+  const uint64_t total = count();
+  if (total == 0) {
+    return std::chrono::nanoseconds(0);
+  }
+  const uint64_t rank = std::max<uint64_t>(uint64_t(fraction * total), 1);
+  uint64_t seen = 0;
+  for (size_t bucket = 0; bucket < LATENCY_HISTOGRAM_NUM_BUCKETS; ++bucket) {
+    seen += m_buckets[bucket].load(std::memory_order_relaxed);
+    if (seen >= rank) {
+      // Report the upper edge of the bucket
+      return std::chrono::nanoseconds(uint64_t(1) << bucket);
+    }
+  }
+  return std::chrono::nanoseconds(uint64_t(1)
+                                  << (LATENCY_HISTOGRAM_NUM_BUCKETS - 1));
+}
+
+void c_LatencyHistogram::reset() {
+  for (auto &bucket : m_buckets) {
+    bucket.store(0, std::memory_order_relaxed);
+  }
+}
+
+std::ostream &operator<<(std::ostream &out,
+                         const c_LatencyHistogram &histogram) {
+  for (size_t bucket = 0; bucket < LATENCY_HISTOGRAM_NUM_BUCKETS; ++bucket) {
+    const uint64_t bucket_count =
+        histogram.m_buckets[bucket].load(std::memory_order_relaxed);
+    if (bucket_count == 0) {
+      continue;
+    }
+    out << "  < " << (uint64_t(1) << bucket) << "ns: " << bucket_count
+        << std::endl;
+  }
+  return out;
+}
+
+void c_OracleStats::record(const size_t num_calls, const size_t bytes_in,
+                           const size_t bytes_out,
+                           const std::chrono::nanoseconds latency) {
+  m_num_calls.fetch_add(num_calls, std::memory_order_relaxed);
+  m_num_round_trips.fetch_add(1, std::memory_order_relaxed);
+  m_bytes_in.fetch_add(bytes_in, std::memory_order_relaxed);
+  m_bytes_out.fetch_add(bytes_out, std::memory_order_relaxed);
+  m_latency.record(latency);
+}
+
+void c_OracleStats::reset() {
+  m_num_calls = 0;
+  m_num_round_trips = 0;
+  m_bytes_in = 0;
+  m_bytes_out = 0;
+  m_latency.reset();
+}
+
+std::ostream &operator<<(std::ostream &out, const c_OracleStats &stats) {
+  out << "Oracle calls: " << stats.m_num_calls << std::endl;
+  out << "Oracle round trips: " << stats.m_num_round_trips << std::endl;
+  out << "Bytes in: " << stats.m_bytes_in << " out: " << stats.m_bytes_out
+      << std::endl;
+  out << "Round trip latency p50: " << stats.m_latency.percentile(0.5).count()
+      << "ns p99: " << stats.m_latency.percentile(0.99).count() << "ns"
+      << std::endl;
+  out << stats.m_latency;
+  return out;
+}
+
+RawBytes gen_random_prefix(const size_t max_length_bytes) {
+  c_RandomByteGenerator generator;
+  return generator.generate_n_random_bytes(
+      generator.generate_in_range(0, max_length_bytes));
+}
@@ -0,0 +1,89 @@
+#include <padding.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stdexcept>
+
+// All ones if lhs < rhs, otherwise zero. Both must be below 2^63.
+size_t constant_time_less_mask(const size_t lhs, const size_t rhs) {
+  constexpr size_t SIGN_SHIFT = std::numeric_limits<size_t>::digits - 1;
+  return size_t(0) - ((lhs - rhs) >> SIGN_SHIFT);
+}
+
+size_t constant_time_equal_mask(const size_t lhs, const size_t rhs) {
+  return ~(constant_time_less_mask(lhs, rhs) |
+           constant_time_less_mask(rhs, lhs));
+}
+
+size_t pkcs7_padded_length(const size_t length,
+                           const size_t block_size_bytes) {
+  return ((length / block_size_bytes) + 1) * block_size_bytes;
+}
+
+size_t pad_pkcs7_in_place(const std::span<uint8_t> buffer, const size_t length,
+                          const size_t block_size_bytes) {
+  const size_t padded_length = pkcs7_padded_length(length, block_size_bytes);
+  if (buffer.size() < padded_length) {
+    throw std::invalid_argument("Buffer too small for PKCS#7 padding");
+  }
+  const uint8_t padding_byte = uint8_t(padded_length - length);
+  std::fill(std::begin(buffer) + length, std::begin(buffer) + padded_length,
+            padding_byte);
+  return padded_length;
+}
+
+RawBytes add_pkcs7_padding(const RawBytes &input,
+                           const size_t block_size_bytes) {
+  RawBytes output(pkcs7_padded_length(input.size(), block_size_bytes));
+  std::copy(std::begin(input), std::end(input), std::begin(output));
+  pad_pkcs7_in_place(output, input.size(), block_size_bytes);
+  return output;
+}
+
+bool validate_pkcs7_padding(const ByteSpan input,
+                            const size_t block_size_bytes,
+                            size_t &unpadded_length) {
+  // The length is public, so it is fine to branch on it
+  if (input.empty() || input.size() % block_size_bytes != 0) {
+    return false;
+  }
+
+  const size_t padding_length = input.back();
+  size_t bad_mask = constant_time_equal_mask(padding_length, 0) |
+                    constant_time_less_mask(block_size_bytes, padding_length);
+
+  const ByteSpan final_block = input.last(block_size_bytes);
+  for (size_t distance = 1; distance <= block_size_bytes; ++distance) {
+    const size_t in_padding_mask =
+        ~constant_time_less_mask(padding_length, distance);
+    const size_t byte = final_block[block_size_bytes - distance];
+    bad_mask |=
+        in_padding_mask & ~constant_time_equal_mask(byte, padding_length);
+  }
+
+  unpadded_length = input.size() - (padding_length & ~bad_mask);
+  return bad_mask == 0;
+}
+
+bool validate_pkcs7_padding(const ByteSpan input,
+                            const size_t block_size_bytes) {
+  size_t unpadded_length;
+  return validate_pkcs7_padding(input, block_size_bytes, unpadded_length);
+}
+
+ByteSpan strip_pkcs7_padding(const ByteSpan input,
+                             const size_t block_size_bytes) {
+  size_t unpadded_length;
+  if (!validate_pkcs7_padding(input, block_size_bytes, unpadded_length)) {
+    throw std::invalid_argument("Invalid PKCS#7 padding");
+  }
+  return input.first(unpadded_length);
+}
+
+RawBytes remove_pkcs7_padding(const RawBytes &input,
+                              const size_t block_size_bytes) {
+  const ByteSpan output = strip_pkcs7_padding(input, block_size_bytes);
+  return RawBytes(std::begin(output), std::end(output));
+}
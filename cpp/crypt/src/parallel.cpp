@@ -0,0 +1,11 @@
+#include <parallel.hpp>
+
+#include <algorithm>
+#include <thread>
+
+size_t get_num_workers(const size_t num_threads, const size_t num_items) {
+  const size_t requested_threads =
+      (num_threads == 0) ? std::thread::hardware_concurrency() : num_threads;
+  return std::clamp<size_t>(requested_threads, 1,
+                            std::max<size_t>(num_items, 1));
+}
@@ -0,0 +1,95 @@
+#include <rand.hpp>
+
+#include <drbg.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <span>
+
+struct c_ThreadRandomState {
+  void fill(std::span<uint8_t> output) {
+    if (output.size() >= RANDOM_BUFFER_SIZE_BYTES) {
+      m_drbg.generate(output);
+      return;
+    }
+    if (output.size() > RANDOM_BUFFER_SIZE_BYTES - m_buffer_offset) {
+      m_drbg.generate(m_buffer);
+      m_buffer_offset = 0;
+    }
+    std::memcpy(output.data(), m_buffer.data() + m_buffer_offset,
+                output.size());
+    // Handed out bytes must not linger in the buffer
+    std::memset(m_buffer.data() + m_buffer_offset, 0, output.size());
+    m_buffer_offset += output.size();
+  }
+
+  void reset(c_CtrDrbg &&drbg) {
+    m_drbg = std::move(drbg);
+    m_buffer.fill(0);
+    m_buffer_offset = RANDOM_BUFFER_SIZE_BYTES;
+  }
+
+  c_CtrDrbg m_drbg;
+  std::array<uint8_t, RANDOM_BUFFER_SIZE_BYTES> m_buffer{};
+  size_t m_buffer_offset = RANDOM_BUFFER_SIZE_BYTES;
+};
+
+c_ThreadRandomState &get_thread_random_state() {
+  thread_local c_ThreadRandomState state;
+  return state;
+}
+
+void fill_random_bytes(std::span<uint8_t> output) {
+  get_thread_random_state().fill(output);
+}
+
+void seed_thread_random(const uint64_t seed) {
+  get_thread_random_state().reset(c_CtrDrbg(seed));
+}
+
+void reseed_thread_random() { get_thread_random_state().reset(c_CtrDrbg()); }
+
+c_RandomByteGenerator::c_RandomByteGenerator() = default;
+
+c_RandomByteGenerator::c_RandomByteGenerator(const uint64_t seed)
+    : m_drbg(std::make_unique<c_CtrDrbg>(seed)) {}
+
+c_RandomByteGenerator::c_RandomByteGenerator(c_RandomByteGenerator &&) =
+    default;
+
+c_RandomByteGenerator &
+c_RandomByteGenerator::operator=(c_RandomByteGenerator &&) = default;
+
+c_RandomByteGenerator::~c_RandomByteGenerator() = default;
+
+void c_RandomByteGenerator::fill(std::span<uint8_t> output) {
+  if (m_drbg) {
+    m_drbg->generate(output);
+  } else {
+    fill_random_bytes(output);
+  }
+}
+
+size_t c_RandomByteGenerator::generate_in_range(const size_t begin,
+                                                const size_t end_inclusive) {
+  const uint64_t range = uint64_t(end_inclusive - begin) + 1;
+  if (range == 0) {
+    // The full 64 bit range
+    uint64_t output;
+    fill(std::span{reinterpret_cast<uint8_t *>(&output), sizeof(output)});
+    return begin + size_t(output);
+  }
+  // Reject draws from the incomplete copy of the range at the top
+  const uint64_t limit =
+      std::numeric_limits<uint64_t>::max() -
+      (std::numeric_limits<uint64_t>::max() % range + 1) % range;
+  uint64_t output;
+  do {
+    fill(std::span{reinterpret_cast<uint8_t *>(&output), sizeof(output)});
+  } while (output > limit);
+  return begin + size_t(output % range);
+}
@@ -1,8 +1,17 @@
 #include <raw_bytes.hpp>
 
+#include <block.hpp>
+#include <packed_block.hpp>
+
+#include <algorithm>
+#include <array>
 #include <cmath>
 #include <cstdint>
+#include <cstring>
 #include <iostream>
+#include <numeric>
+#include <span>
+#include <stdexcept>
 #include <string>
 
 RawBytes from_hex_string(const std::string &input) {
@@ -105,7 +114,7 @@ std::ostream &to_base64_string(std::ostream &out, const RawBytes &input) {
       prev_byte = input.back();
       current_byte = 0;
     } else {
-      prev_byte = input[iter - 1];
+      prev_byte = (iter > 0) ? input[iter - 1] : 0;
       current_byte = input[iter];
     }
     if (iter % 3 == 0) {
@@ -260,18 +269,101 @@ RawBytes prepend_bytes(const RawBytes &original, const RawBytes &prefix) {
   return output;
 }
 
+// XOR_UNROLL_BLOCKS blocks per iteration keeps the loads in flight
+constexpr inline size_t XOR_UNROLL_BLOCKS = 4;
+
+static void xor_bytes(uint8_t *output, const uint8_t *input,
+                      const size_t num_bytes) {
+  constexpr size_t UNROLL_BYTES = XOR_UNROLL_BLOCKS * BLOCK_SIZE_BYTES;
+  size_t offset = 0;
+  for (; offset + UNROLL_BYTES <= num_bytes; offset += UNROLL_BYTES) {
+    for (size_t block = 0; block < UNROLL_BYTES; block += BLOCK_SIZE_BYTES) {
+      store_block(load_block(output + offset + block) ^
+                      load_block(input + offset + block),
+                  output + offset + block);
+    }
+  }
+  for (; offset + BLOCK_SIZE_BYTES <= num_bytes; offset += BLOCK_SIZE_BYTES) {
+    store_block(load_block(output + offset) ^ load_block(input + offset),
+                output + offset);
+  }
+  for (; offset < num_bytes; ++offset) {
+    output[offset] ^= input[offset];
+  }
+}
+
+void xor_in_place(std::span<uint8_t> output, const ByteSpan input) {
+  if (output.size() != input.size()) {
+    throw std::length_error("XOR operands differ in length!");
+  }
+  xor_bytes(output.data(), input.data(), output.size());
+}
+
+void xor_in_place(std::span<uint8_t> output, const uint8_t key) {
+  xor_repeating_in_place(output, ByteSpan{&key, 1});
+}
+
+void xor_repeating_in_place(std::span<uint8_t> output, const ByteSpan key,
+                            const size_t key_offset) {
+  if (key.empty()) {
+    throw std::length_error("Repeating XOR key is empty!");
+  }
+
+  // A short key repeated to whole periods of lcm(key, block) bytes, as many
+  // as the buffer holds or the output needs, so each pass over the pattern is
+  // kilobytes of whole blocks rather than one period
+  std::array<uint8_t, REPEATING_XOR_MAX_PATTERN_KEY_BYTES * BLOCK_SIZE_BYTES>
+      pattern_buffer;
+  ByteSpan pattern = key;
+  if (key.size() < REPEATING_XOR_MAX_PATTERN_KEY_BYTES) {
+    const size_t period = std::lcm(key.size(), BLOCK_SIZE_BYTES);
+    const size_t num_periods = std::clamp<size_t>(
+        (key_offset % key.size() + output.size() + period - 1) / period, 1,
+        pattern_buffer.size() / period);
+    const size_t pattern_length = num_periods * period;
+    for (size_t offset = 0; offset < period; offset += key.size()) {
+      std::copy(std::begin(key), std::end(key),
+                std::begin(pattern_buffer) + offset);
+    }
+    // Each copy doubles the pattern
+    for (size_t length = period; length < pattern_length;) {
+      const size_t num_bytes = std::min(length, pattern_length - length);
+      std::memcpy(pattern_buffer.data() + length, pattern_buffer.data(),
+                  num_bytes);
+      length += num_bytes;
+    }
+    pattern = ByteSpan{pattern_buffer.data(), pattern_length};
+  }
+
+  size_t pattern_offset = key_offset % key.size();
+  for (size_t offset = 0; offset < output.size();) {
+    const size_t num_bytes =
+        std::min(pattern.size() - pattern_offset, output.size() - offset);
+    xor_bytes(output.data() + offset, pattern.data() + pattern_offset,
+              num_bytes);
+    offset += num_bytes;
+    pattern_offset = 0;
+  }
+}
+
+RawBytes &operator^=(RawBytes &output, const ByteSpan input) {
+  xor_in_place(output, input);
+  return output;
+}
+
+RawBytes &operator^=(RawBytes &output, const uint8_t key) {
+  xor_in_place(output, key);
+  return output;
+}
+
 RawBytes operator^(const RawBytes &input_1, const RawBytes &input_2) {
   RawBytes output(input_1);
-  for (size_t index = 0; index < output.size(); ++index) {
-    output[index] ^= input_2[index];
-  }
+  output ^= input_2;
   return output;
 }
 
-RawBytes operator^(const RawBytes &input, uint8_t key) {
+RawBytes operator^(const RawBytes &input, const uint8_t key) {
   RawBytes output(input);
-  for (auto &element : output) {
-    element ^= key;
-  }
+  output ^= key;
   return output;
 }
@@ -0,0 +1,73 @@
+#include <token.hpp>
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+static c_ProfileFactory &get_thread_profile_factory() {
+  thread_local c_ProfileFactory factory;
+  return factory;
+}
+
+static std::vector<ByteBlock> &get_thread_token_scratch() {
+  thread_local std::vector<ByteBlock> scratch;
+  return scratch;
+}
+
+void c_TokenService::issue_token(const std::string_view email,
+                                 RawBytes &token) const {
+  const c_ProfileCookieView cookie = {
+      email, get_thread_profile_factory().next_uid(), "user"};
+  const size_t length = serialized_length(cookie);
+  const size_t padded_length = pkcs7_padded_length(length);
+  token.resize(padded_length);
+
+  size_t num_written = 0;
+  serialize_profile_cookie(
+      cookie,
+      std::span{reinterpret_cast<char *>(token.data()), padded_length},
+      num_written);
+  pad_pkcs7_in_place(token, num_written);
+
+  const std::span<ByteBlock> blocks{reinterpret_cast<ByteBlock *>(token.data()),
+                                    padded_length / BLOCK_SIZE_BYTES};
+  m_encrypter.encrypt(blocks, blocks);
+}
+
+RawBytes c_TokenService::issue_token(const std::string_view email) const {
+  RawBytes token;
+  issue_token(email, token);
+  return token;
+}
+
+CookieError c_TokenService::verify_token(const ByteSpan token,
+                                         c_ProfileCookie &output) const {
+  if (token.empty() || token.size() % BLOCK_SIZE_BYTES != 0) {
+    return CookieError::bad_token;
+  }
+  std::vector<ByteBlock> &scratch = get_thread_token_scratch();
+  scratch.resize(token.size() / BLOCK_SIZE_BYTES);
+  m_encrypter.decrypt(
+      std::span{reinterpret_cast<const ByteBlock *>(token.data()),
+                scratch.size()},
+      scratch);
+
+  const ByteSpan plaintext{reinterpret_cast<const uint8_t *>(scratch.data()),
+                           token.size()};
+  size_t length = 0;
+  if (!validate_pkcs7_padding(plaintext, BLOCK_SIZE_BYTES, length)) {
+    return CookieError::bad_token;
+  }
+
+  c_ProfileCookieView cookie;
+  const CookieError error = parse_profile_cookie(
+      {reinterpret_cast<const char *>(plaintext.data()), length}, cookie);
+  if (error != CookieError::ok) {
+    return error;
+  }
+  output.m_email.assign(cookie.m_email);
+  output.m_uid = cookie.m_uid;
+  output.m_role.assign(cookie.m_role);
+  return CookieError::ok;
+}
@@ -0,0 +1,212 @@
+#include <cipher.hpp>
+
+#include <aes.hpp>
+#include <block.hpp>
+
+#include <array>
+#include <cstdint>
+#include <memory>
+
+// Each round is four table lookups per column: SubBytes, ShiftRows and
+// MixColumns folded into 256 entry tables of 32 bit columns. Byte r of a
+// column is bits 8r to 8r + 7 of its word.
+using TTable = std::array<uint32_t, 256>;
+
+struct c_TTables {
+  // m_encrypt[k][x] is the column row k contributes when it holds x
+  std::array<TTable, WORD_SIZE_BYTES> m_encrypt;
+  std::array<TTable, WORD_SIZE_BYTES> m_decrypt;
+};
+
+static uint8_t gf_multiply(uint8_t input_a, uint8_t input_b) {
+  uint8_t output = 0;
+  while (input_b != 0) {
+    if (input_b & 1) {
+      output ^= input_a;
+    }
+    input_a = uint8_t(input_a << 1) ^ ((input_a & 0x80) ? 0x1b : 0x00);
+    input_b >>= 1;
+  }
+  return output;
+}
+
+static uint32_t pack_column(const uint8_t byte_0, const uint8_t byte_1,
+                            const uint8_t byte_2, const uint8_t byte_3) {
+  return uint32_t(byte_0) | (uint32_t(byte_1) << 8) |
+         (uint32_t(byte_2) << 16) | (uint32_t(byte_3) << 24);
+}
+
+static uint32_t rotate_column(const uint32_t input, const size_t num_bytes) {
+  if (num_bytes == 0) {
+    return input;
+  }
+  return (input << (8 * num_bytes)) | (input >> (32 - (8 * num_bytes)));
+}
+
+static c_TTables gen_ttables() {
+  c_TTables tables;
+  for (size_t value = 0; value < 256; ++value) {
+    const uint8_t sub = sub_byte(uint8_t(value));
+    const uint8_t inv_sub = inv_sub_byte(uint8_t(value));
+    // The first columns of the MixColumns and InvMixColumns matrices
+    const uint32_t encrypt_column = pack_column(
+        gf_multiply(sub, 2), sub, sub, gf_multiply(sub, 3));
+    const uint32_t decrypt_column =
+        pack_column(gf_multiply(inv_sub, 14), gf_multiply(inv_sub, 9),
+                    gf_multiply(inv_sub, 13), gf_multiply(inv_sub, 11));
+    for (size_t row_index = 0; row_index < WORD_SIZE_BYTES; ++row_index) {
+      tables.m_encrypt[row_index][value] =
+          rotate_column(encrypt_column, row_index);
+      tables.m_decrypt[row_index][value] =
+          rotate_column(decrypt_column, row_index);
+    }
+  }
+  return tables;
+}
+
+static const c_TTables &get_ttables() {
+  static const c_TTables tables = gen_ttables();
+  return tables;
+}
+
+static uint8_t get_row_byte(const uint32_t column, const size_t row_index) {
+  return uint8_t(column >> (8 * row_index));
+}
+
+using BlockColumns = std::array<uint32_t, BLOCK_SIZE_WORDS>;
+
+static BlockColumns load_columns(const uint8_t *input) {
+  BlockColumns output;
+  for (size_t column_index = 0; column_index < BLOCK_SIZE_WORDS;
+       ++column_index) {
+    const uint8_t *column = input + (column_index * WORD_SIZE_BYTES);
+    output[column_index] =
+        pack_column(column[0], column[1], column[2], column[3]);
+  }
+  return output;
+}
+
+static void store_columns(const BlockColumns &input, uint8_t *output) {
+  for (size_t column_index = 0; column_index < BLOCK_SIZE_WORDS;
+       ++column_index) {
+    for (size_t row_index = 0; row_index < WORD_SIZE_BYTES; ++row_index) {
+      output[(column_index * WORD_SIZE_BYTES) + row_index] =
+          get_row_byte(input[column_index], row_index);
+    }
+  }
+}
+
+template <typename KeyScheduleType>
+BlockColumns gen_round_key_columns(const KeyScheduleType &key_schedule,
+                                   const size_t round_index) {
+  return load_columns(reinterpret_cast<const uint8_t *>(
+      &key_schedule[round_index * BLOCK_SIZE_WORDS]));
+}
+
+static void add_round_key(BlockColumns &state, const BlockColumns &round_key) {
+  for (size_t column_index = 0; column_index < BLOCK_SIZE_WORDS;
+       ++column_index) {
+    state[column_index] ^= round_key[column_index];
+  }
+}
+
+// Row r of output column c comes from input column c + r * direction, which
+// is ShiftRows for direction 1 and InvShiftRows for direction 3
+template <size_t Direction>
+BlockColumns table_round(const BlockColumns &state,
+                         const std::array<TTable, WORD_SIZE_BYTES> &tables) {
+  BlockColumns output;
+  for (size_t column_index = 0; column_index < BLOCK_SIZE_WORDS;
+       ++column_index) {
+    output[column_index] =
+        tables[0][get_row_byte(state[column_index], 0)] ^
+        tables[1][get_row_byte(state[(column_index + Direction) % 4], 1)] ^
+        tables[2][get_row_byte(state[(column_index + 2 * Direction) % 4], 2)] ^
+        tables[3][get_row_byte(state[(column_index + 3 * Direction) % 4], 3)];
+  }
+  return output;
+}
+
+// The last round has no MixColumns, so it substitutes bytes directly
+template <size_t Direction>
+BlockColumns final_round(const BlockColumns &state,
+                         uint8_t (*substitute)(uint8_t)) {
+  BlockColumns output;
+  for (size_t column_index = 0; column_index < BLOCK_SIZE_WORDS;
+       ++column_index) {
+    std::array<uint8_t, WORD_SIZE_BYTES> column;
+    for (size_t row_index = 0; row_index < WORD_SIZE_BYTES; ++row_index) {
+      const size_t source_index =
+          (column_index + (row_index * Direction)) % BLOCK_SIZE_WORDS;
+      column[row_index] =
+          substitute(get_row_byte(state[source_index], row_index));
+    }
+    output[column_index] =
+        pack_column(column[0], column[1], column[2], column[3]);
+  }
+  return output;
+}
+
+template <typename KeyType, typename KeyScheduleType>
+struct c_TTableCipher : public c_BlockCipher {
+  static constexpr size_t NUM_ROUNDS =
+      (std::tuple_size<KeyScheduleType>{} / BLOCK_SIZE_WORDS) - 1;
+  static constexpr size_t SHIFT_ROWS_DIRECTION = 1;
+  static constexpr size_t INV_SHIFT_ROWS_DIRECTION = BLOCK_SIZE_WORDS - 1;
+
+  c_TTableCipher(const KeyType &key) {
+    const KeyScheduleType key_schedule = gen_key_schedule(key);
+    const c_DecryptionKeySchedule<KeyScheduleType> decryption_key_schedule =
+        gen_decryption_key_schedule(key_schedule);
+    for (size_t round_index = 0; round_index <= NUM_ROUNDS; ++round_index) {
+      m_round_keys[round_index] =
+          gen_round_key_columns(key_schedule, round_index);
+      m_decryption_round_keys[round_index] = gen_round_key_columns(
+          decryption_key_schedule.m_round_keys, round_index);
+    }
+  }
+
+  void encrypt_blocks(const uint8_t *input, uint8_t *output,
+                      const size_t num_blocks) const override {
+    const c_TTables &tables = get_ttables();
+    for (size_t offset = 0; offset < num_blocks * BLOCK_SIZE_BYTES;
+         offset += BLOCK_SIZE_BYTES) {
+      BlockColumns state = load_columns(input + offset);
+      add_round_key(state, m_round_keys[0]);
+      for (size_t round_index = 1; round_index < NUM_ROUNDS; ++round_index) {
+        state = table_round<SHIFT_ROWS_DIRECTION>(state, tables.m_encrypt);
+        add_round_key(state, m_round_keys[round_index]);
+      }
+      state = final_round<SHIFT_ROWS_DIRECTION>(state, sub_byte);
+      add_round_key(state, m_round_keys[NUM_ROUNDS]);
+      store_columns(state, output + offset);
+    }
+  }
+
+  // The equivalent inverse cipher, so decryption has the same shape
+  void decrypt_blocks(const uint8_t *input, uint8_t *output,
+                      const size_t num_blocks) const override {
+    const c_TTables &tables = get_ttables();
+    for (size_t offset = 0; offset < num_blocks * BLOCK_SIZE_BYTES;
+         offset += BLOCK_SIZE_BYTES) {
+      BlockColumns state = load_columns(input + offset);
+      add_round_key(state, m_decryption_round_keys[NUM_ROUNDS]);
+      for (size_t round_index = NUM_ROUNDS - 1; round_index > 0;
+           --round_index) {
+        state =
+            table_round<INV_SHIFT_ROWS_DIRECTION>(state, tables.m_decrypt);
+        add_round_key(state, m_decryption_round_keys[round_index]);
+      }
+      state = final_round<INV_SHIFT_ROWS_DIRECTION>(state, inv_sub_byte);
+      add_round_key(state, m_decryption_round_keys[0]);
+      store_columns(state, output + offset);
+    }
+  }
+
+  std::array<BlockColumns, NUM_ROUNDS + 1> m_round_keys;
+  std::array<BlockColumns, NUM_ROUNDS + 1> m_decryption_round_keys;
+};
+
+std::unique_ptr<c_BlockCipher> make_ttable_cipher(const RawBytes &key_raw) {
+  return make_aes_cipher<c_TTableCipher>(key_raw);
+}
@@ -0,0 +1,245 @@
+#include <xts.hpp>
+
+#include <packed_block.hpp>
+#include <parallel.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+
+// Tweaks in a batch are computed as this many independent chains
+constexpr size_t XTS_TWEAK_LANES = 4;
+
+static_assert(XTS_BATCH_BLOCKS % XTS_TWEAK_LANES == 0,
+              "XTS batches hold whole groups of tweak lanes");
+
+#if !defined(__SSE2__)
+static uint64_t load_little_endian_64(const uint8_t *input) {
+  uint64_t output = 0;
+  for (size_t byte_index = sizeof(output); byte_index-- > 0;) {
+    output = (output << 8) | input[byte_index];
+  }
+  return output;
+}
+#endif
+
+static void store_little_endian_64(const uint64_t input, uint8_t *output) {
+  for (size_t byte_index = 0; byte_index < sizeof(input); ++byte_index) {
+    output[byte_index] = uint8_t(input >> (8 * byte_index));
+  }
+}
+
+// The tweak is a 128 bit little-endian integer, so its two 64 bit halves
+// sit in the low and high lanes of the block. Multiplies it by x^NumBits
+// modulo x^128 + x^7 + x^2 + x + 1: the bits shifted out of the top wrap
+// around as their carryless product with 0x87.
+template <unsigned NumBits>
+static c_PackedBlock multiply_by_alpha_power(const c_PackedBlock &tweak) {
+  static_assert(NumBits >= 1 && NumBits <= 57,
+                "The wrapped bits times 0x87 must fit in the low half");
+#if defined(__SSE2__)
+  const __m128i carries = _mm_srli_epi64(tweak.m_data, 64 - NumBits);
+  // The low half's carry moves up into the high half and the high half's
+  // wraps around into the low half
+  const __m128i swapped = _mm_shuffle_epi32(carries, 0x4e);
+  const __m128i wrapped = _mm_move_epi64(swapped);
+  __m128i output = _mm_xor_si128(_mm_slli_epi64(tweak.m_data, NumBits),
+                                 swapped);
+  output = _mm_xor_si128(output, _mm_slli_epi64(wrapped, 1));
+  output = _mm_xor_si128(output, _mm_slli_epi64(wrapped, 2));
+  return {_mm_xor_si128(output, _mm_slli_epi64(wrapped, 7))};
+#else
+  std::array<uint8_t, BLOCK_SIZE_BYTES> bytes;
+  store_block(tweak, bytes.data());
+  const uint64_t low = load_little_endian_64(bytes.data());
+  const uint64_t high = load_little_endian_64(bytes.data() + 8);
+  const uint64_t wrapped = high >> (64 - NumBits);
+  store_little_endian_64((low << NumBits) ^ wrapped ^ (wrapped << 1) ^
+                             (wrapped << 2) ^ (wrapped << 7),
+                         bytes.data());
+  store_little_endian_64((high << NumBits) | (low >> (64 - NumBits)),
+                         bytes.data() + 8);
+  return load_block(bytes.data());
+#endif
+}
+
+static c_PackedBlock multiply_by_alpha(const c_PackedBlock &tweak) {
+  return multiply_by_alpha_power<1>(tweak);
+}
+
+// XORs each block with its tweak before and after the cipher, advancing the
+// tweak once per block. The tweaks for a batch are generated up front so
+// the backend sees XTS_BATCH_BLOCKS independent blocks per call. Only the
+// first XTS_TWEAK_LANES of them step by x; each later one is the tweak
+// XTS_TWEAK_LANES back times x^XTS_TWEAK_LANES, so that many
+// multiplications are in flight at once rather than one long chain.
+static void crypt_blocks(const c_BlockCipher &cipher, const bool is_encrypt,
+                         c_PackedBlock &tweak, const uint8_t *input,
+                         uint8_t *output, const size_t num_blocks) {
+  std::array<c_PackedBlock, XTS_BATCH_BLOCKS> tweaks;
+  std::array<uint8_t, XTS_BATCH_BLOCKS * BLOCK_SIZE_BYTES> buffer;
+
+  for (size_t block_index = 0; block_index < num_blocks;
+       block_index += XTS_BATCH_BLOCKS) {
+    const size_t num_batch_blocks =
+        std::min(XTS_BATCH_BLOCKS, num_blocks - block_index);
+    const size_t offset = block_index * BLOCK_SIZE_BYTES;
+
+    tweaks[0] = tweak;
+    for (size_t batch_index = 1;
+         batch_index < std::min(XTS_TWEAK_LANES, num_batch_blocks);
+         ++batch_index) {
+      tweaks[batch_index] = multiply_by_alpha(tweaks[batch_index - 1]);
+    }
+    for (size_t batch_index = XTS_TWEAK_LANES; batch_index < num_batch_blocks;
+         ++batch_index) {
+      tweaks[batch_index] =
+          multiply_by_alpha_power<XTS_TWEAK_LANES>(
+              tweaks[batch_index - XTS_TWEAK_LANES]);
+    }
+    tweak = multiply_by_alpha(tweaks[num_batch_blocks - 1]);
+
+    for (size_t batch_index = 0; batch_index < num_batch_blocks;
+         ++batch_index) {
+      const size_t batch_offset = batch_index * BLOCK_SIZE_BYTES;
+      store_block(load_block(input + offset + batch_offset) ^
+                      tweaks[batch_index],
+                  buffer.data() + batch_offset);
+    }
+    if (is_encrypt) {
+      cipher.encrypt_blocks(buffer.data(), buffer.data(), num_batch_blocks);
+    } else {
+      cipher.decrypt_blocks(buffer.data(), buffer.data(), num_batch_blocks);
+    }
+    for (size_t batch_index = 0; batch_index < num_batch_blocks;
+         ++batch_index) {
+      const size_t batch_offset = batch_index * BLOCK_SIZE_BYTES;
+      store_block(load_block(buffer.data() + batch_offset) ^
+                      tweaks[batch_index],
+                  output + offset + batch_offset);
+    }
+  }
+}
+
+c_XTSCipher::c_XTSCipher(const RawBytes &key_raw)
+    : c_XTSCipher(get_default_cipher_backend().m_name, key_raw) {}
+
+c_XTSCipher::c_XTSCipher(const std::string_view backend_name,
+                         const RawBytes &key_raw) {
+  if (key_raw.size() != XTS_AES_128_KEY_LENGTH_BYTES &&
+      key_raw.size() != XTS_AES_256_KEY_LENGTH_BYTES) {
+    throw std::invalid_argument("XTS-AES keys are 32 or 64 bytes!");
+  }
+  const auto middle = key_raw.begin() + (key_raw.size() / 2);
+  m_data_cipher =
+      make_block_cipher(backend_name, RawBytes(key_raw.begin(), middle));
+  m_tweak_cipher =
+      make_block_cipher(backend_name, RawBytes(middle, key_raw.end()));
+}
+
+void c_XTSCipher::encrypt_sector(const uint64_t sector_number,
+                                 const ByteSpan input,
+                                 std::span<uint8_t> output) const {
+  crypt_sector(true, sector_number, input, output);
+}
+
+void c_XTSCipher::decrypt_sector(const uint64_t sector_number,
+                                 const ByteSpan input,
+                                 std::span<uint8_t> output) const {
+  crypt_sector(false, sector_number, input, output);
+}
+
+void c_XTSCipher::encrypt_sectors(const uint64_t first_sector,
+                                  const size_t sector_size,
+                                  const ByteSpan input,
+                                  std::span<uint8_t> output,
+                                  const size_t num_threads) const {
+  crypt_sectors(true, first_sector, sector_size, input, output, num_threads);
+}
+
+void c_XTSCipher::decrypt_sectors(const uint64_t first_sector,
+                                  const size_t sector_size,
+                                  const ByteSpan input,
+                                  std::span<uint8_t> output,
+                                  const size_t num_threads) const {
+  crypt_sectors(false, first_sector, sector_size, input, output, num_threads);
+}
+
+void c_XTSCipher::crypt_sector(const bool is_encrypt,
+                               const uint64_t sector_number,
+                               const ByteSpan input,
+                               std::span<uint8_t> output) const {
+  if (input.size() < BLOCK_SIZE_BYTES) {
+    throw std::invalid_argument("XTS sectors are at least one block!");
+  }
+  if (output.size() < input.size()) {
+    throw std::invalid_argument("XTS output is too small!");
+  }
+
+  std::array<uint8_t, BLOCK_SIZE_BYTES> tweak_bytes{};
+  store_little_endian_64(sector_number, tweak_bytes.data());
+  m_tweak_cipher->encrypt_blocks(tweak_bytes.data(), tweak_bytes.data(), 1);
+  c_PackedBlock tweak = load_block(tweak_bytes.data());
+
+  const size_t num_full_blocks = input.size() / BLOCK_SIZE_BYTES;
+  const size_t num_partial_bytes = input.size() % BLOCK_SIZE_BYTES;
+  if (num_partial_bytes == 0) {
+    crypt_blocks(*m_data_cipher, is_encrypt, tweak, input.data(),
+                 output.data(), num_full_blocks);
+    return;
+  }
+
+  // Ciphertext stealing: the last full block borrows the tail of the
+  // partial one. Decryption uses the last two tweaks in the other order.
+  crypt_blocks(*m_data_cipher, is_encrypt, tweak, input.data(), output.data(),
+               num_full_blocks - 1);
+  c_PackedBlock next_tweak = multiply_by_alpha(tweak);
+  c_PackedBlock &first_tweak = is_encrypt ? tweak : next_tweak;
+  c_PackedBlock &second_tweak = is_encrypt ? next_tweak : tweak;
+
+  const size_t last_full_offset = (num_full_blocks - 1) * BLOCK_SIZE_BYTES;
+  const size_t partial_offset = num_full_blocks * BLOCK_SIZE_BYTES;
+  std::array<uint8_t, BLOCK_SIZE_BYTES> last_block;
+  crypt_blocks(*m_data_cipher, is_encrypt, first_tweak,
+               input.data() + last_full_offset, last_block.data(), 1);
+
+  std::array<uint8_t, BLOCK_SIZE_BYTES> stolen_block;
+  std::memcpy(stolen_block.data(), input.data() + partial_offset,
+              num_partial_bytes);
+  std::memcpy(stolen_block.data() + num_partial_bytes,
+              last_block.data() + num_partial_bytes,
+              BLOCK_SIZE_BYTES - num_partial_bytes);
+  std::memcpy(output.data() + partial_offset, last_block.data(),
+              num_partial_bytes);
+  crypt_blocks(*m_data_cipher, is_encrypt, second_tweak, stolen_block.data(),
+               output.data() + last_full_offset, 1);
+}
+
+void c_XTSCipher::crypt_sectors(const bool is_encrypt,
+                                const uint64_t first_sector,
+                                const size_t sector_size, const ByteSpan input,
+                                std::span<uint8_t> output,
+                                const size_t num_threads) const {
+  if (sector_size < BLOCK_SIZE_BYTES || input.size() % sector_size != 0) {
+    throw std::invalid_argument("XTS input is not a whole number of "
+                                "sectors!");
+  }
+  if (output.size() < input.size()) {
+    throw std::invalid_argument("XTS output is too small!");
+  }
+  const size_t num_sectors = input.size() / sector_size;
+  for_each_run(num_sectors, num_threads, [&](const size_t begin_sector,
+                                             const size_t end_sector) {
+    for (size_t sector_index = begin_sector; sector_index < end_sector;
+         ++sector_index) {
+      const size_t offset = sector_index * sector_size;
+      crypt_sector(is_encrypt, first_sector + sector_index,
+                   input.subspan(offset, sector_size),
+                   output.subspan(offset, sector_size));
+    }
+  });
+}
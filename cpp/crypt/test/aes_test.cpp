@@ -0,0 +1,135 @@
+#include <generators.hpp>
+
+#include <aes.hpp>
+#include <block.hpp>
+#include <packed_block.hpp>
+#include <raw_bytes.hpp>
+
+#include <doctest/doctest.h>
+#include <rapidcheck.h>
+
+#include <cstdint>
+#include <string>
+
+namespace testing {
+
+template <typename KeyType> auto gen_property_key_schedule() {
+  return gen_key_schedule(gen_key<KeyType>(gen_bytes(sizeof(KeyType))));
+}
+
+template <typename KeyType>
+void check_aes_properties(const std::string &key_name) {
+  CHECK(rc::check(key_name + " AES_inv_cipher inverts AES_cipher", [] {
+    const auto key_schedule = gen_property_key_schedule<KeyType>();
+    const ByteBlock plaintext = gen_block();
+    ByteBlock ciphertext;
+    AES_cipher(plaintext, ciphertext, key_schedule);
+    ByteBlock decrypted;
+    AES_inv_cipher(ciphertext, decrypted, key_schedule);
+    RC_ASSERT(decrypted == plaintext);
+  }));
+
+  CHECK(rc::check(key_name + " equivalent inverse cipher matches the "
+                             "inverse cipher",
+                  [] {
+                    const auto key_schedule =
+                        gen_property_key_schedule<KeyType>();
+                    const ByteBlock ciphertext = gen_block();
+                    ByteBlock expected;
+                    AES_inv_cipher(ciphertext, expected, key_schedule);
+                    c_PackedBlock state = load_block(ciphertext);
+                    AES_inv_cipher(state,
+                                   gen_decryption_key_schedule(key_schedule));
+                    RC_ASSERT(to_byte_block(state) == expected);
+                  }));
+
+  CHECK(rc::check(key_name + " multi-block kernels match one block at a time",
+                  [] {
+                    const auto key_schedule =
+                        gen_property_key_schedule<KeyType>();
+                    const size_t num_blocks =
+                        *rc::gen::inRange<size_t>(0, MAX_PROPERTY_BLOCKS);
+                    const RawBytes input =
+                        gen_bytes(num_blocks * BLOCK_SIZE_BYTES);
+                    RawBytes encrypted(input.size());
+                    AES_cipher_bytes(input.data(), encrypted.data(),
+                                     num_blocks, key_schedule);
+                    RawBytes decrypted(input.size());
+                    AES_inv_cipher_bytes(input.data(), decrypted.data(),
+                                         num_blocks, key_schedule);
+                    for (size_t block_index = 0; block_index < num_blocks;
+                         ++block_index) {
+                      const ByteBlock block =
+                          from_raw_bytes_to_byte_block(input, block_index);
+                      ByteBlock expected;
+                      AES_cipher(block, expected, key_schedule);
+                      RC_ASSERT(from_raw_bytes_to_byte_block(
+                                    encrypted, block_index) == expected);
+                      AES_inv_cipher(block, expected, key_schedule);
+                      RC_ASSERT(from_raw_bytes_to_byte_block(
+                                    decrypted, block_index) == expected);
+                    }
+                  }));
+
+  CHECK(rc::check(key_name + " AES_ECB_decrypt inverts AES_ECB_encrypt", [] {
+    const auto key_schedule = gen_property_key_schedule<KeyType>();
+    const RawBytes plaintext = gen_bytes_up_to(MAX_PROPERTY_BYTES);
+    const RawBytes ciphertext = AES_ECB_encrypt(plaintext, key_schedule);
+    RC_ASSERT(ciphertext.size() % BLOCK_SIZE_BYTES == 0);
+    RC_ASSERT(ciphertext.size() > plaintext.size());
+    RC_ASSERT(AES_ECB_decrypt(ciphertext, key_schedule) == plaintext);
+  }));
+
+  CHECK(rc::check(key_name + " AES_CBC_decrypt inverts AES_CBC_encrypt", [] {
+    const auto key_schedule = gen_property_key_schedule<KeyType>();
+    const RawBytes plaintext = gen_bytes_up_to(MAX_PROPERTY_BYTES);
+    const RawBytes iv = gen_bytes(BLOCK_SIZE_BYTES);
+    const RawBytes ciphertext = AES_CBC_encrypt(plaintext, key_schedule, iv);
+    RC_ASSERT(AES_CBC_decrypt(ciphertext, key_schedule, iv) == plaintext);
+  }));
+}
+
+// FIPS-197 Appendix C shares one plaintext across the three key sizes
+template <typename KeyType>
+void check_fips_197_example(const std::string &key_hex,
+                            const std::string &ciphertext_hex) {
+  const auto key_schedule =
+      gen_key_schedule(gen_key<KeyType>(from_hex_string(key_hex)));
+  const ByteBlock plaintext = from_raw_bytes_to_byte_block(
+      from_hex_string("00112233445566778899aabbccddeeff"));
+  ByteBlock ciphertext;
+  AES_cipher(plaintext, ciphertext, key_schedule);
+  CHECK(from_byte_block_to_raw_bytes(ciphertext) ==
+        from_hex_string(ciphertext_hex));
+  ByteBlock decrypted;
+  AES_inv_cipher(ciphertext, decrypted, key_schedule);
+  CHECK(decrypted == plaintext);
+}
+
+TEST_SUITE("crypt.aes") {
+
+  TEST_CASE("AES-128") { check_aes_properties<AES128Key>("AES-128"); }
+
+  TEST_CASE("AES-192") { check_aes_properties<AES192Key>("AES-192"); }
+
+  TEST_CASE("AES-256") { check_aes_properties<AES256Key>("AES-256"); }
+
+  TEST_CASE("FIPS-197 Appendix C.1") {
+    check_fips_197_example<AES128Key>("000102030405060708090a0b0c0d0e0f",
+                                      "69c4e0d86a7b0430d8cdb78070b4c55a");
+  }
+
+  TEST_CASE("FIPS-197 Appendix C.2") {
+    check_fips_197_example<AES192Key>(
+        "000102030405060708090a0b0c0d0e0f1011121314151617",
+        "dda97ca4864cdfe06eaf70a0ec0d7191");
+  }
+
+  TEST_CASE("FIPS-197 Appendix C.3") {
+    check_fips_197_example<AES256Key>(
+        "000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f",
+        "8ea2b7ca516745bfeafc49904b496089");
+  }
+}
+
+} // namespace testing
@@ -0,0 +1,106 @@
+#include <generators.hpp>
+
+#include <analysis.hpp>
+#include <raw_bytes.hpp>
+
+#include <doctest/doctest.h>
+#include <rapidcheck.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+namespace testing {
+
+static bool is_close(const double lhs, const double rhs) {
+  return std::abs(lhs - rhs) <= 1e-9 * std::max(1.0, std::abs(rhs));
+}
+
+TEST_SUITE("crypt.analysis") {
+
+  TEST_CASE("histograms") {
+    CHECK(rc::check("gen_histogram counts every byte", [] {
+      const RawBytes input = gen_bytes_up_to(MAX_PROPERTY_BYTES);
+      const c_ByteHistogram histogram = gen_histogram(input);
+      c_ByteHistogram expected;
+      for (const uint8_t byte : input) {
+        ++expected.m_counts[byte];
+      }
+      RC_ASSERT(histogram.m_counts == expected.m_counts);
+      RC_ASSERT(histogram.m_total == input.size());
+    }));
+
+    CHECK(rc::check("column histograms match striding by hand", [] {
+      const RawBytes input = gen_bytes_up_to(MAX_PROPERTY_BYTES);
+      const size_t num_columns = *rc::gen::inRange<size_t>(1, 41);
+      const auto histograms = gen_column_histograms(input, num_columns);
+      for (size_t column = 0; column < num_columns; ++column) {
+        RawBytes striped;
+        for (size_t index = column; index < input.size();
+             index += num_columns) {
+          striped.push_back(input[index]);
+        }
+        const c_ByteHistogram expected = gen_histogram(striped);
+        RC_ASSERT(histograms[column].m_counts == expected.m_counts);
+        RC_ASSERT(histograms[column].m_total == expected.m_total);
+      }
+    }));
+
+    CHECK(rc::check("index of coincidence is unchanged by single byte XOR",
+                    [](const RawBytes &input, const uint8_t key) {
+                      RC_ASSERT(is_close(
+                          index_of_coincidence(gen_histogram(input ^ key)),
+                          index_of_coincidence(gen_histogram(input))));
+                    }));
+
+    CHECK(index_of_coincidence(gen_histogram(RawBytes(10, 'a'))) == 1.0);
+    CHECK(index_of_coincidence(gen_histogram(from_ascii_string("abcd"))) ==
+          0.0);
+  }
+
+  TEST_CASE("single XOR scores") {
+    const c_LanguageModel &model = english_language_model();
+    CHECK(rc::check("scoring every key from one histogram matches XOR", [&] {
+      const RawBytes input = gen_bytes_up_to(MAX_PROPERTY_BYTES);
+      const c_ByteHistogram histogram = gen_histogram(input);
+      const auto log_scores =
+          score_single_xor_keys(histogram, model, ScoreMethod::log_likelihood);
+      const auto chi_scores =
+          score_single_xor_keys(histogram, model, ScoreMethod::chi_squared);
+      const uint8_t key = *rc::gen::arbitrary<uint8_t>();
+      const c_ByteHistogram xord = gen_histogram(input ^ key);
+      if (input.empty()) {
+        RC_ASSERT(log_scores[key] == 0.0);
+        return;
+      }
+      RC_ASSERT(is_close(log_scores[key],
+                         -log_likelihood(xord, model) / input.size()));
+      RC_ASSERT(is_close(chi_scores[key], chi_squared(xord, model)));
+    }));
+
+    const RawBytes english = from_ascii_string(
+        "Cooking MC's like a pound of bacon, the quick brown fox");
+    CHECK(score_text(english, model) < score_text(english ^ 0x20, model));
+    CHECK(score_text(english, model) < score_text(english ^ 0x01, model));
+  }
+
+  TEST_CASE("language models") {
+    const RawBytes corpus = from_ascii_string("abababab abab aba");
+    const c_LanguageModel model(corpus);
+    double total = 0.0;
+    for (const double probability : model.m_probabilities) {
+      CHECK(probability > 0.0);
+      total += probability;
+    }
+    CHECK(is_close(total, 1.0));
+    CHECK(model.m_probabilities['a'] > model.m_probabilities['c']);
+    CHECK(ngram_log_likelihood(from_ascii_string("abab"), model, 2) >
+          ngram_log_likelihood(from_ascii_string("aabb"), model, 2));
+    CHECK_THROWS_AS(ngram_log_likelihood(corpus, model, 4),
+                    std::invalid_argument);
+  }
+}
+
+} // namespace testing
@@ -0,0 +1,148 @@
+#include <arena.hpp>
+
+#include <doctest/doctest.h>
+#include <rapidcheck.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <utility>
+#include <vector>
+
+namespace testing {
+
+// Small enough that a handful of allocations spill into further chunks
+constexpr inline size_t ARENA_TEST_CHUNK_BYTES = 256;
+
+static bool is_aligned(const void *pointer, const size_t alignment) {
+  return reinterpret_cast<uintptr_t>(pointer) % alignment == 0;
+}
+
+TEST_SUITE("crypt.arena") {
+
+  TEST_CASE("c_BumpArena") {
+    c_BumpArena arena(ARENA_TEST_CHUNK_BYTES);
+    CHECK(arena.bytes_in_use() == 0U);
+    CHECK(arena.m_stats.m_num_chunk_allocations == 0U);
+
+    const c_BumpArena::c_Mark start = arena.mark();
+    void *first = arena.allocate(100, 1);
+    void *second = arena.allocate(100, 1);
+    CHECK(arena.bytes_in_use() == 200U);
+    CHECK(arena.m_stats.m_num_chunk_allocations == 1U);
+
+    // Does not fit in what is left of the first chunk
+    const c_BumpArena::c_Mark before_third = arena.mark();
+    void *third = arena.allocate(100, 1);
+    CHECK(arena.m_stats.m_num_chunk_allocations == 2U);
+    CHECK(arena.m_stats.m_high_water_bytes == arena.bytes_in_use());
+
+    // Rewinding hands the same memory out again without touching the heap
+    arena.rewind(before_third);
+    CHECK(arena.allocate(100, 1) == third);
+    arena.rewind(start);
+    CHECK(arena.bytes_in_use() == 0U);
+    CHECK(arena.allocate(100, 1) == first);
+    CHECK(arena.allocate(100, 1) == second);
+    CHECK(arena.allocate(100, 1) == third);
+    CHECK(arena.m_stats.m_num_chunk_allocations == 2U);
+    CHECK(arena.m_stats.m_num_allocations == 7U);
+
+    // Deallocation is a no-op
+    const size_t bytes_in_use = arena.bytes_in_use();
+    arena.deallocate(third, 100, 1);
+    CHECK(arena.bytes_in_use() == bytes_in_use);
+
+    // A request larger than a chunk gets a chunk of its own
+    arena.rewind(start);
+    CHECK(is_aligned(arena.allocate(4 * ARENA_TEST_CHUNK_BYTES, 64), 64));
+    CHECK(arena.m_stats.m_num_chunk_allocations == 3U);
+  }
+
+  TEST_CASE("rewind and reuse") {
+    CHECK(rc::check("Replaying after a rewind reuses every allocation", [] {
+      const std::vector<size_t> sizes = *rc::gen::container<
+          std::vector<size_t>>(rc::gen::inRange<size_t>(0, 300));
+      std::vector<std::pair<size_t, size_t>> requests;
+      for (const size_t num_bytes : sizes) {
+        // Powers of two up to 64
+        requests.emplace_back(num_bytes,
+                              size_t(1) << *rc::gen::inRange<size_t>(0, 7));
+      }
+      c_BumpArena arena(ARENA_TEST_CHUNK_BYTES);
+      const c_BumpArena::c_Mark start = arena.mark();
+      std::vector<void *> pointers;
+      for (const auto &[num_bytes, alignment] : requests) {
+        pointers.push_back(arena.allocate(num_bytes, alignment));
+        RC_ASSERT(is_aligned(pointers.back(), alignment));
+        RC_ASSERT(arena.bytes_in_use() <= arena.m_stats.m_bytes_reserved);
+      }
+      const c_ArenaStats warmed_up = arena.m_stats;
+
+      arena.rewind(start);
+      RC_ASSERT(arena.bytes_in_use() == 0U);
+      for (size_t index = 0; index < requests.size(); ++index) {
+        RC_ASSERT(arena.allocate(requests[index].first,
+                                 requests[index].second) == pointers[index]);
+      }
+      RC_ASSERT(arena.m_stats.m_num_chunk_allocations ==
+                warmed_up.m_num_chunk_allocations);
+      RC_ASSERT(arena.m_stats.m_bytes_reserved == warmed_up.m_bytes_reserved);
+      RC_ASSERT(arena.m_stats.m_high_water_bytes ==
+                warmed_up.m_high_water_bytes);
+    }));
+  }
+
+  TEST_CASE("c_ScratchScope") {
+    c_BumpArena &arena = scratch_arena();
+    const size_t bytes_in_use = arena.bytes_in_use();
+    const void *outer_data = nullptr;
+    {
+      c_ScratchScope outer;
+      ScratchBytes outer_raw(64, 'A', scratch_resource());
+      outer_data = outer_raw.data();
+      CHECK(arena.bytes_in_use() >= bytes_in_use + 64);
+      const void *inner_data = nullptr;
+      {
+        c_ScratchScope inner;
+        ScratchBytes inner_raw(64, 'B', scratch_resource());
+        inner_data = inner_raw.data();
+      }
+      // The inner scope gave its buffer back, the outer one still holds
+      const size_t outer_bytes_in_use = arena.bytes_in_use();
+      {
+        c_ScratchScope inner;
+        ScratchBytes inner_raw(64, 'C', scratch_resource());
+        CHECK(inner_raw.data() == inner_data);
+      }
+      CHECK(arena.bytes_in_use() == outer_bytes_in_use);
+      CHECK(outer_raw == ScratchBytes(64, 'A'));
+    }
+    CHECK(arena.bytes_in_use() == bytes_in_use);
+
+    const size_t num_chunk_allocations = arena.m_stats.m_num_chunk_allocations;
+    {
+      c_ScratchScope scope;
+      ScratchBytes outer_raw(64, 'D', scratch_resource());
+      CHECK(outer_raw.data() == outer_data);
+    }
+    CHECK(arena.m_stats.m_num_chunk_allocations == num_chunk_allocations);
+  }
+
+  TEST_CASE("c_ScratchResourceScope") {
+    REQUIRE(scratch_resource_override() == nullptr);
+    CHECK(scratch_resource() == &scratch_arena());
+    {
+      c_ScratchResourceScope heap(std::pmr::new_delete_resource());
+      CHECK(scratch_resource() == std::pmr::new_delete_resource());
+      {
+        c_ScratchResourceScope arena(nullptr);
+        CHECK(scratch_resource() == &scratch_arena());
+      }
+      CHECK(scratch_resource() == std::pmr::new_delete_resource());
+    }
+    CHECK(scratch_resource_override() == nullptr);
+  }
+}
+
+} // namespace testing
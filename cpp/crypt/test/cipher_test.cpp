@@ -0,0 +1,374 @@
+#include <generators.hpp>
+
+#include <aes.hpp>
+#include <cipher.hpp>
+#include <mode.hpp>
+#include <raw_bytes.hpp>
+#include <xts.hpp>
+
+#include <doctest/doctest.h>
+#include <rapidcheck.h>
+
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace testing {
+
+// Every registered backend against the reference, so that a new backend is
+// covered as soon as it registers
+static void check_backend_properties(const c_CipherBackend &backend) {
+  const std::string &name = backend.m_name;
+
+  CHECK(rc::check(name + " blocks match the reference backend", [&backend] {
+    const RawBytes key = gen_aes_key();
+    const std::unique_ptr<c_BlockCipher> cipher = backend.m_factory(key);
+    const std::unique_ptr<c_BlockCipher> reference =
+        make_reference_cipher(key);
+    const size_t num_blocks = *rc::gen::inRange<size_t>(0, MAX_PROPERTY_BLOCKS);
+    const RawBytes input = gen_bytes(num_blocks * BLOCK_SIZE_BYTES);
+
+    RawBytes expected(input.size());
+    reference->encrypt_blocks(input.data(), expected.data(), num_blocks);
+    RawBytes output(input.size());
+    cipher->encrypt_blocks(input.data(), output.data(), num_blocks);
+    RC_ASSERT(output == expected);
+
+    reference->decrypt_blocks(input.data(), expected.data(), num_blocks);
+    cipher->decrypt_blocks(input.data(), output.data(), num_blocks);
+    RC_ASSERT(output == expected);
+
+    // In place
+    output = input;
+    cipher->encrypt_blocks(output.data(), output.data(), num_blocks);
+    cipher->decrypt_blocks(output.data(), output.data(), num_blocks);
+    RC_ASSERT(output == input);
+  }));
+
+  CHECK(rc::check(name + " ECB round trips and matches AES_ECB_encrypt",
+                  [&backend] {
+                    const RawBytes key = gen_aes_key();
+                    const std::unique_ptr<c_BlockCipher> cipher =
+                        backend.m_factory(key);
+                    const RawBytes plaintext =
+                        gen_bytes_up_to(MAX_PROPERTY_BYTES);
+                    const RawBytes ciphertext = ECB_encrypt(*cipher, plaintext);
+                    RC_ASSERT(ECB_decrypt(*cipher, ciphertext) == plaintext);
+                    if (key.size() == sizeof(AES128Key)) {
+                      RC_ASSERT(ciphertext ==
+                                AES_ECB_encrypt(plaintext,
+                                                gen_key_schedule(
+                                                    gen_key<AES128Key>(key))));
+                    }
+                  }));
+
+  CHECK(rc::check(name + " CBC round trips and matches AES_CBC_encrypt",
+                  [&backend] {
+                    const RawBytes key = gen_aes_key();
+                    const std::unique_ptr<c_BlockCipher> cipher =
+                        backend.m_factory(key);
+                    const RawBytes plaintext =
+                        gen_bytes_up_to(MAX_PROPERTY_BYTES);
+                    const ByteBlock iv = gen_block();
+                    const RawBytes ciphertext =
+                        CBC_encrypt(*cipher, plaintext, iv);
+                    RC_ASSERT(CBC_decrypt(*cipher, ciphertext, iv) ==
+                              plaintext);
+                    if (key.size() == sizeof(AES128Key)) {
+                      RC_ASSERT(ciphertext ==
+                                AES_CBC_encrypt(plaintext,
+                                                gen_key_schedule(
+                                                    gen_key<AES128Key>(key)),
+                                                iv));
+                    }
+                  }));
+
+  CHECK(rc::check(name + " unpadded CBC in two pieces matches CBC_encrypt",
+                  [&backend] {
+                    const std::unique_ptr<c_BlockCipher> cipher =
+                        backend.m_factory(gen_aes_key());
+                    const size_t num_blocks =
+                        *rc::gen::inRange<size_t>(0, MAX_PROPERTY_BLOCKS);
+                    const size_t split_offset =
+                        *rc::gen::inRange<size_t>(0, num_blocks + 1) *
+                        BLOCK_SIZE_BYTES;
+                    const RawBytes plaintext =
+                        gen_bytes(num_blocks * BLOCK_SIZE_BYTES);
+                    const ByteBlock iv = gen_block();
+                    // CBC_encrypt adds one block of padding at the end
+                    RawBytes expected = CBC_encrypt(*cipher, plaintext, iv);
+                    expected.resize(plaintext.size());
+
+                    // Encrypts in place, carrying the chain across pieces
+                    RawBytes ciphertext = plaintext;
+                    const std::span<uint8_t> ciphertext_span{ciphertext};
+                    ByteBlock chain = iv;
+                    CBC_encrypt_blocks(*cipher, chain,
+                                       ciphertext_span.first(split_offset),
+                                       ciphertext_span.first(split_offset));
+                    CBC_encrypt_blocks(*cipher, chain,
+                                       ciphertext_span.subspan(split_offset),
+                                       ciphertext_span.subspan(split_offset));
+                    RC_ASSERT(ciphertext == expected);
+                    RC_ASSERT(num_blocks == 0 ||
+                              from_byte_block_to_raw_bytes(chain) ==
+                                  RawBytes(ciphertext.end() - BLOCK_SIZE_BYTES,
+                                           ciphertext.end()));
+
+                    RawBytes decrypted(plaintext.size());
+                    const std::span<uint8_t> decrypted_span{decrypted};
+                    chain = iv;
+                    CBC_decrypt_blocks(*cipher, chain,
+                                       ByteSpan{ciphertext}.first(split_offset),
+                                       decrypted_span.first(split_offset));
+                    CBC_decrypt_blocks(
+                        *cipher, chain,
+                        ByteSpan{ciphertext}.subspan(split_offset),
+                        decrypted_span.subspan(split_offset));
+                    RC_ASSERT(decrypted == plaintext);
+                  }));
+
+  {
+    const std::unique_ptr<c_BlockCipher> cipher =
+        backend.m_factory(RawBytes(BLOCK_SIZE_BYTES, 0));
+    ByteBlock chain{};
+    RawBytes buffer(BLOCK_SIZE_BYTES + 1);
+    const ByteSpan block = ByteSpan{buffer}.first(BLOCK_SIZE_BYTES);
+    CHECK_THROWS_AS(CBC_encrypt_blocks(*cipher, chain, buffer, buffer),
+                    std::invalid_argument);
+    CHECK_THROWS_AS(CBC_decrypt_blocks(*cipher, chain, block,
+                                       std::span{buffer}.first(1)),
+                    std::invalid_argument);
+  }
+
+  CHECK(rc::check(name + " CBC_encrypt_streams matches CBC_encrypt",
+                  [&backend] {
+                    const std::unique_ptr<c_BlockCipher> cipher =
+                        backend.m_factory(gen_aes_key());
+                    const size_t num_streams =
+                        *rc::gen::inRange<size_t>(0, 12);
+                    std::vector<RawBytes> plaintexts;
+                    std::vector<ByteBlock> ivs;
+                    for (size_t index = 0; index < num_streams; ++index) {
+                      plaintexts.push_back(gen_bytes_up_to(
+                          MAX_PROPERTY_BYTES / 4));
+                      ivs.push_back(gen_block());
+                    }
+                    const std::vector<RawBytes> ciphertexts =
+                        CBC_encrypt_streams(*cipher, plaintexts, ivs);
+                    RC_ASSERT(ciphertexts.size() == num_streams);
+                    for (size_t index = 0; index < num_streams; ++index) {
+                      RC_ASSERT(ciphertexts[index] ==
+                                CBC_encrypt(*cipher, plaintexts[index],
+                                            ivs[index]));
+                    }
+                  }));
+
+  CHECK(rc::check(name + " CTR is its own inverse and matches the reference",
+                  [&backend] {
+                    const RawBytes key = gen_aes_key();
+                    const std::unique_ptr<c_BlockCipher> cipher =
+                        backend.m_factory(key);
+                    const RawBytes input =
+                        gen_bytes_up_to(2 * MAX_PROPERTY_BYTES);
+                    const ByteBlock counter = gen_block();
+                    const RawBytes output = CTR_crypt(*cipher, counter, input);
+                    RC_ASSERT(output.size() == input.size());
+                    RC_ASSERT(CTR_crypt(*cipher, counter, output) == input);
+                    RC_ASSERT(output == CTR_crypt(*make_reference_cipher(key),
+                                                  counter, input));
+                  }));
+
+  CHECK(rc::check(name + " XTS round trips with ciphertext stealing",
+                  [&backend] {
+                    const RawBytes key = gen_bytes(
+                        *rc::gen::element(XTS_AES_128_KEY_LENGTH_BYTES,
+                                          XTS_AES_256_KEY_LENGTH_BYTES));
+                    const c_XTSCipher cipher(backend.m_name, key);
+                    const c_XTSCipher reference("reference", key);
+                    const size_t sector_size = *rc::gen::inRange<size_t>(
+                        BLOCK_SIZE_BYTES, MAX_PROPERTY_BYTES);
+                    const size_t num_sectors = *rc::gen::inRange<size_t>(1, 5);
+                    const uint64_t first_sector =
+                        *rc::gen::arbitrary<uint32_t>();
+                    const RawBytes input =
+                        gen_bytes(sector_size * num_sectors);
+
+                    RawBytes output(input.size());
+                    cipher.encrypt_sectors(first_sector, sector_size, input,
+                                           output);
+                    RawBytes expected(input.size());
+                    reference.encrypt_sectors(first_sector, sector_size, input,
+                                              expected, 1);
+                    RC_ASSERT(output == expected);
+                    cipher.decrypt_sectors(first_sector, sector_size, output,
+                                           output);
+                    RC_ASSERT(output == input);
+                  }));
+}
+
+struct c_GCMVector {
+  std::string m_key;
+  std::string m_iv;
+  std::string m_aad;
+  std::string m_plaintext;
+  std::string m_ciphertext;
+  std::string m_tag;
+};
+
+// McGrew and Viega, "The Galois/Counter Mode of Operation", test cases 2, 4
+// and 6. Case 6 has a 60 byte IV, which goes through GHASH to make J0.
+static const std::vector<c_GCMVector> GCM_VECTORS = {
+    {"00000000000000000000000000000000", "000000000000000000000000", "",
+     "00000000000000000000000000000000", "0388dace60b6a392f328c2b971b2fe78",
+     "ab6e47d42cec13bdf53a67b21257bddf"},
+    {"feffe9928665731c6d6a8f9467308308", "cafebabefacedbaddecaf888",
+     "feedfacedeadbeeffeedfacedeadbeefabaddad2",
+     "d9313225f88406e5a55909c5aff5269a86a7a9531534f7da2e4c303d8a318a72"
+     "1c3c0c95956809532fcf0e2449a6b525b16aedf5aa0de657ba637b39",
+     "42831ec2217774244b7221b784d0d49ce3aa212f2c02a4e035c17e2329aca12e"
+     "21d514b25466931c7d8f6a5aac84aa051ba30b396a0aac973d58e091",
+     "5bc94fbc3221a5db94fae95ae7121a47"},
+    {"feffe9928665731c6d6a8f9467308308",
+     "9313225df88406e555909c5aff5269aa6a7a9538534f7da1e4c303d2a318a728"
+     "c3c0c95156809539fcf0e2429a6b525416aedbf5a0de6a57a637b39b",
+     "feedfacedeadbeeffeedfacedeadbeefabaddad2",
+     "d9313225f88406e5a55909c5aff5269a86a7a9531534f7da2e4c303d8a318a72"
+     "1c3c0c95956809532fcf0e2449a6b525b16aedf5aa0de657ba637b39",
+     "8ce24998625615b603a033aca13fb894be9112a5c3a211a8ba262a3cca7e2ca7"
+     "01e4a9a4fba43c90ccdcb281d48c7c6fd62875d2aca417034c34aee5",
+     "619cc5aefffe0bfa462af43c1699d050"},
+};
+
+struct c_XTSVector {
+  std::string m_key;
+  uint64_t m_sector_number = 0;
+  std::string m_plaintext;
+  std::string m_ciphertext;
+};
+
+// IEEE 1619 vectors 1 and 2, then a 17 byte sector, which steals all but one
+// byte of the first block, checked against OpenSSL's EVP_aes_128_xts
+static const std::vector<c_XTSVector> XTS_VECTORS = {
+    {"00000000000000000000000000000000"
+     "00000000000000000000000000000000",
+     0,
+     "0000000000000000000000000000000000000000000000000000000000000000",
+     "917cf69ebd68b2ec9b9fe9a3eadda692cd43d2f59598ed858c02c2652fbf922e"},
+    {"11111111111111111111111111111111"
+     "22222222222222222222222222222222",
+     0x3333333333,
+     "4444444444444444444444444444444444444444444444444444444444444444",
+     "c454185e6a16936e39334038acef838bfb186fff7480adc4289382ecd6d394f0"},
+    {"fffefdfcfbfaf9f8f7f6f5f4f3f2f1f0"
+     "bfbebdbcbbbab9b8b7b6b5b4b3b2b1b0",
+     0x9a78563412, "000102030405060708090a0b0c0d0e0f10",
+     "641610679dcbf92e505c41333fb06c2a95"},
+};
+
+// IEEE 1619 vector 4's key on a 600 byte sector of bytes 0, 1, 2, ...: two
+// batches, every tweak lane and a steal, checked against OpenSSL's
+// EVP_aes_128_xts
+constexpr inline uint64_t XTS_LONG_SECTOR_NUMBER = 0x0123456789abcdef;
+constexpr inline size_t XTS_LONG_SECTOR_BYTES = 600;
+static const std::string XTS_LONG_SECTOR_KEY =
+    "27182818284590452353602874713526"
+    "31415926535897932384626433832795";
+static const std::string XTS_LONG_SECTOR_CIPHERTEXT =
+    "4d4e81b33e0f8e156eaa92540dd513bb1fe26984e9142a0c75a9e0f87f792ccd"
+    "35bf656ab380583ddc4714cca586e557cabe41a84681ce12013cf300017a0257"
+    "cdd08e31e5186c61561584f1f4fa6a5e622ed38de7626629cfa51e872f82d29c"
+    "cc7e585c722b4e586bd12de8d8ae34a75396a0761e49420d9d975b5bd7dc8b59"
+    "ca5f5c388c74432cd498e22fc02de345f392e1e3897ef0fa5a5efed108738004"
+    "b372918906b95068980e5a7117e5542b6c763876ffe358ea339de7c63b95151a"
+    "2d6ae63a0cbc0fe99045622e3569195dbf99379d89bf31d4431ba8d46eb03e2e"
+    "e2f95a61d60ea13874b9ee93eee0d5ce4900d0b49134b07f4beb3d8472617974"
+    "75c74a430a957f3479b177791ed1223bed531aac8a13de2a59498e83c1d36fa6"
+    "78f159cd286820e8b1c0d2eed7f2865c30eff89f838e040b4fd5b60148da9be4"
+    "d5e9a079f53c6af3ec529b50ae4a17f8b87a7d9b43a0bc6e5431e83e154b28f5"
+    "327e9ab26c6150e46a7a91b4db5e9a3bf2763553fae7132c75074f90a7cb8fc0"
+    "a73c59090b1c599191ae3e404df4b674b895611b3b6c99aa87dced6630168db4"
+    "2b7129340d566e928be109cdab1565996c5a74f376568dc5281ba8c8b1e47c7c"
+    "cd5aee4b15a98128faa31eb396bd5ac9406eda2ea0002a3fb02632684ea0ef6d"
+    "65681a15e229fdfec7945d066def26e47e48fd5ccb6131cf708a893fef3eab82"
+    "c9674e1d64b5dfc3e62efb8e40226fba2690c5cf3b0c8ac7430833ef53bd7cd2"
+    "3496de2e9741f8a26395aed7237fe83a8926689148eb3503a0ef501ec80f2a16"
+    "5cedef76ef5dae23233f275edefb44998d49e00d897a7189";
+
+TEST_SUITE("crypt.cipher") {
+
+  TEST_CASE("backends") {
+    for (const c_CipherBackend &backend : get_cipher_backends()) {
+      check_backend_properties(backend);
+    }
+  }
+
+  TEST_CASE("GCM known answers") {
+    for (const c_CipherBackend &backend : get_cipher_backends()) {
+      for (const c_GCMVector &vector : GCM_VECTORS) {
+        const std::unique_ptr<c_BlockCipher> cipher =
+            backend.m_factory(from_hex_string(vector.m_key));
+        const RawBytes iv = from_hex_string(vector.m_iv);
+        const RawBytes aad = from_hex_string(vector.m_aad);
+        const RawBytes plaintext = from_hex_string(vector.m_plaintext);
+
+        ByteBlock tag;
+        const RawBytes ciphertext =
+            GCM_encrypt(*cipher, iv, aad, plaintext, tag);
+        CHECK(ciphertext == from_hex_string(vector.m_ciphertext));
+        CHECK(from_byte_block_to_raw_bytes(tag) ==
+              from_hex_string(vector.m_tag));
+
+        RawBytes decrypted;
+        CHECK(GCM_decrypt(*cipher, iv, aad, ciphertext, tag, decrypted));
+        CHECK(decrypted == plaintext);
+
+        ByteBlock tampered_tag = tag;
+        tampered_tag[0][0] ^= 1;
+        RawBytes rejected = plaintext;
+        CHECK_FALSE(
+            GCM_decrypt(*cipher, iv, aad, ciphertext, tampered_tag, rejected));
+        CHECK(rejected.empty());
+      }
+    }
+  }
+
+  TEST_CASE("XTS known answers") {
+    for (const c_CipherBackend &backend : get_cipher_backends()) {
+      for (const c_XTSVector &vector : XTS_VECTORS) {
+        const c_XTSCipher cipher(backend.m_name,
+                                 from_hex_string(vector.m_key));
+        const RawBytes plaintext = from_hex_string(vector.m_plaintext);
+        RawBytes ciphertext(plaintext.size());
+        cipher.encrypt_sector(vector.m_sector_number, plaintext, ciphertext);
+        CHECK(ciphertext == from_hex_string(vector.m_ciphertext));
+        RawBytes decrypted(ciphertext.size());
+        cipher.decrypt_sector(vector.m_sector_number, ciphertext, decrypted);
+        CHECK(decrypted == plaintext);
+      }
+
+      const c_XTSCipher cipher(backend.m_name,
+                               from_hex_string(XTS_LONG_SECTOR_KEY));
+      RawBytes plaintext(XTS_LONG_SECTOR_BYTES);
+      for (size_t index = 0; index < plaintext.size(); ++index) {
+        plaintext[index] = uint8_t(index);
+      }
+      RawBytes ciphertext(plaintext.size());
+      cipher.encrypt_sector(XTS_LONG_SECTOR_NUMBER, plaintext, ciphertext);
+      CHECK(ciphertext == from_hex_string(XTS_LONG_SECTOR_CIPHERTEXT));
+      RawBytes decrypted(ciphertext.size());
+      cipher.decrypt_sector(XTS_LONG_SECTOR_NUMBER, ciphertext, decrypted);
+      CHECK(decrypted == plaintext);
+    }
+  }
+
+  TEST_CASE("unknown backends and key sizes") {
+    CHECK_THROWS_AS(get_cipher_backend("no such backend"),
+                    std::invalid_argument);
+    CHECK_THROWS_AS(make_block_cipher(RawBytes(15)), std::invalid_argument);
+  }
+}
+
+} // namespace testing
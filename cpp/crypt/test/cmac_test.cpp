@@ -0,0 +1,74 @@
+#include <aes.hpp>
+#include <cmac.hpp>
+#include <raw_bytes.hpp>
+
+#include <doctest/doctest.h>
+
+#include <string>
+#include <vector>
+
+namespace testing {
+
+// RFC 4493 section 4, examples 1 to 4: prefixes of one message under one key
+static const std::string CMAC_KEY = "2b7e151628aed2a6abf7158809cf4f3c";
+static const std::string CMAC_MESSAGE =
+    "6bc1bee22e409f96e93d7e117393172aae2d8a571e03ac9c9eb76fac45af8e51"
+    "30c81c46a35ce411e5fbc1191a0a52eff69f2445df4f9b17ad2b417be66c3710";
+
+struct c_CMACVector {
+  size_t m_message_length_bytes = 0;
+  std::string m_tag;
+};
+
+static const std::vector<c_CMACVector> CMAC_VECTORS = {
+    {0, "bb1d6929e95937287fa37d129b756746"},
+    {16, "070a16b46b4d4144f79bdd9dd04a287c"},
+    {40, "dfa66747de9ae63030ca32611497c827"},
+    {64, "51f0bebf7e3b9d92fc49741779363cfe"},
+};
+
+TEST_SUITE("crypt.cmac") {
+
+  TEST_CASE("RFC 4493 examples") {
+    const AES128KeySchedule key_schedule =
+        gen_key_schedule(gen_key<AES128Key>(from_hex_string(CMAC_KEY)));
+    const RawBytes message = from_hex_string(CMAC_MESSAGE);
+
+    std::vector<ByteSpan> messages;
+    for (const c_CMACVector &vector : CMAC_VECTORS) {
+      const ByteSpan prefix =
+          ByteSpan(message).first(vector.m_message_length_bytes);
+      messages.push_back(prefix);
+      CHECK(from_byte_block_to_raw_bytes(CMAC(key_schedule, prefix)) ==
+            from_hex_string(vector.m_tag));
+    }
+
+    const std::vector<ByteBlock> tags = CMAC_batch(key_schedule, messages);
+    REQUIRE(tags.size() == CMAC_VECTORS.size());
+    for (size_t index = 0; index < tags.size(); ++index) {
+      CHECK(from_byte_block_to_raw_bytes(tags[index]) ==
+            from_hex_string(CMAC_VECTORS[index].m_tag));
+    }
+  }
+
+  TEST_CASE("streaming updates") {
+    const AES128KeySchedule key_schedule =
+        gen_key_schedule(gen_key<AES128Key>(from_hex_string(CMAC_KEY)));
+    const RawBytes message = from_hex_string(CMAC_MESSAGE);
+
+    // Example 3 split inside its first block, then reused after finalize
+    c_AES128CMAC cmac(key_schedule);
+    for (size_t repeat = 0; repeat < 2; ++repeat) {
+      cmac.update(ByteSpan(message).first(7));
+      cmac.update(ByteSpan(message).subspan(7, 33));
+      CHECK(from_byte_block_to_raw_bytes(cmac.finalize()) ==
+            from_hex_string(CMAC_VECTORS[2].m_tag));
+    }
+    // An empty update leaves the empty message
+    cmac.update(ByteSpan{});
+    CHECK(from_byte_block_to_raw_bytes(cmac.finalize()) ==
+          from_hex_string(CMAC_VECTORS[0].m_tag));
+  }
+}
+
+} // namespace testing
@@ -0,0 +1,190 @@
+#include <cookie.hpp>
+#include <padding.hpp>
+#include <parallel.hpp>
+
+#include <doctest/doctest.h>
+#include <rapidcheck.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace testing {
+
+// Mostly plain characters, with the two the serializer has to encode
+static const std::string COOKIE_EMAIL_CHARACTERS = "abcxyz019.@_-&=";
+static const std::string COOKIE_ROLE_CHARACTERS = "abcdefghijklmnopqrstuvwxyz";
+
+static std::string gen_cookie_string(const std::string &characters) {
+  return *rc::gen::container<std::string>(rc::gen::elementOf(characters));
+}
+
+static c_ProfileCookie gen_profile_cookie(const std::string &characters) {
+  return c_ProfileCookie(gen_cookie_string(characters),
+                         *rc::gen::arbitrary<size_t>(),
+                         gen_cookie_string(COOKIE_ROLE_CHARACTERS));
+}
+
+static CookieError parse(const std::string_view input) {
+  c_ProfileCookieView cookie;
+  return parse_profile_cookie(input, cookie);
+}
+
+TEST_SUITE("crypt.cookie") {
+
+  TEST_CASE("parse_profile_cookie") {
+    c_ProfileCookieView cookie;
+    REQUIRE(parse_profile_cookie("email=foo@bar.com&uid=10&role=user",
+                                 cookie) == CookieError::ok);
+    CHECK(cookie.m_email == "foo@bar.com");
+    CHECK(cookie.m_uid == 10U);
+    CHECK(cookie.m_role == "user");
+    CHECK(parse("") == CookieError::ok);
+
+    CHECK(parse("email=foo@bar.com&uid") == CookieError::missing_equals);
+    CHECK(parse("email") == CookieError::missing_equals);
+    CHECK(parse("email=a&&role=user") == CookieError::missing_equals);
+
+    CHECK(parse("email=a&admin=true") == CookieError::unknown_key);
+    CHECK(parse("=a") == CookieError::unknown_key);
+
+    CHECK(parse("uid=") == CookieError::bad_uid);
+    CHECK(parse("email=a&uid=12x&role=user") == CookieError::bad_uid);
+    CHECK(parse("uid=-1") == CookieError::bad_uid);
+    // One past the largest 64 bit value
+    CHECK(parse("uid=18446744073709551616") == CookieError::bad_uid);
+    CHECK(parse("uid=18446744073709551615") == CookieError::ok);
+
+    CHECK_THROWS_AS(c_ProfileCookie::from_string("email=a&uid=12x"),
+                    std::invalid_argument);
+  }
+
+  TEST_CASE("serialize_profile_cookie") {
+    CHECK(rc::check("Exactly serialized_length encoded characters are "
+                    "written",
+                    [] {
+                      const c_ProfileCookie cookie =
+                          gen_profile_cookie(COOKIE_EMAIL_CHARACTERS);
+                      const size_t length = serialized_length(cookie.view());
+                      std::string buffer(length, '\0');
+                      size_t num_written = 0;
+                      RC_ASSERT(serialize_profile_cookie(cookie.view(),
+                                                         buffer,
+                                                         num_written) ==
+                                CookieError::ok);
+                      RC_ASSERT(num_written == length);
+                      RC_ASSERT(buffer ==
+                                "email=" +
+                                    c_ProfileCookie::encode_string(
+                                        cookie.m_email) +
+                                    "&uid=" + std::to_string(cookie.m_uid) +
+                                    "&role=" + cookie.m_role);
+                    }));
+
+    CHECK(rc::check("A short buffer is left untouched", [] {
+      const c_ProfileCookie cookie =
+          gen_profile_cookie(COOKIE_EMAIL_CHARACTERS);
+      const size_t length = serialized_length(cookie.view());
+      const std::string untouched(*rc::gen::inRange<size_t>(0, length), '#');
+      std::string buffer = untouched;
+      size_t num_written = 1;
+      RC_ASSERT(serialize_profile_cookie(cookie.view(), buffer,
+                                         num_written) ==
+                CookieError::buffer_too_small);
+      RC_ASSERT(num_written == 0U);
+      RC_ASSERT(buffer == untouched);
+    }));
+  }
+
+  TEST_CASE("round trips") {
+    CHECK(rc::check("from_string inverts to_string", [] {
+      // Parsing leaves an encoded email encoded, so only plain emails
+      // come back as they went in
+      const c_ProfileCookie cookie =
+          gen_profile_cookie(COOKIE_ROLE_CHARACTERS + "019.@_-");
+      const c_ProfileCookie parsed =
+          c_ProfileCookie::from_string(cookie.to_string());
+      RC_ASSERT(parsed.m_email == cookie.m_email);
+      RC_ASSERT(parsed.m_uid == cookie.m_uid);
+      RC_ASSERT(parsed.m_role == cookie.m_role);
+    }));
+
+    CHECK(rc::check("to_string inverts from_string on serialized cookies", [] {
+      const std::string serialized =
+          gen_profile_cookie(COOKIE_EMAIL_CHARACTERS).to_string();
+      RC_ASSERT(c_ProfileCookie::from_string(serialized).to_string() ==
+                serialized);
+    }));
+  }
+
+  TEST_CASE("c_ProfileFactory") {
+    // The serializer encodes the email, so & and = cannot add fields
+    c_UidAllocator uid_allocator;
+    c_ProfileFactory factory(uid_allocator);
+    CHECK(factory.profile_for("foo@bar.com&role=admin") ==
+          "email=foo@bar.com%26role%3Dadmin&uid=0&role=user");
+    const size_t next_uid = c_ProfileCookie::m_uid_allocator.m_next_uid;
+    CHECK(profile_for("foo@bar.com&role=admin") ==
+          "email=foo@bar.com%26role%3Dadmin&uid=" + std::to_string(next_uid) +
+              "&role=user");
+
+    CHECK(rc::check("Batched cookies are padded on block boundaries", [] {
+      const std::vector<std::string> emails =
+          *rc::gen::container<std::vector<std::string>>(
+              rc::gen::container<std::string>(
+                  rc::gen::elementOf(COOKIE_EMAIL_CHARACTERS)));
+      const std::vector<std::string_view> email_views(emails.begin(),
+                                                      emails.end());
+      c_UidAllocator uid_allocator;
+      c_ProfileFactory factory(uid_allocator);
+      const c_ProfileBatch batch = factory.profile_for_batch(email_views);
+
+      RC_ASSERT(batch.size() == emails.size());
+      RC_ASSERT(batch.m_block_offsets.back() == batch.m_blocks.size());
+      const uint8_t *arena =
+          reinterpret_cast<const uint8_t *>(batch.m_blocks.data());
+      for (size_t index = 0; index < batch.size(); ++index) {
+        const std::string expected =
+            c_ProfileCookie(emails[index], index, "user").to_string();
+        RC_ASSERT(batch.cookie(index) == expected);
+        const ByteSpan blocks = batch.blocks(index);
+        RC_ASSERT(blocks.data() ==
+                  arena + (batch.m_block_offsets[index] * BLOCK_SIZE_BYTES));
+        RC_ASSERT(blocks.size() == pkcs7_padded_length(expected.size()));
+        const ByteSpan unpadded = strip_pkcs7_padding(blocks);
+        RC_ASSERT(std::string(unpadded.begin(), unpadded.end()) == expected);
+      }
+    }));
+  }
+
+  TEST_CASE("uids are unique across threads") {
+    constexpr size_t NUM_THREADS = 4;
+    // Spills into a second reserved block on every thread
+    constexpr size_t NUM_PROFILES = UID_BLOCK_SIZE + 1;
+    c_UidAllocator uid_allocator;
+    std::vector<std::vector<size_t>> worker_uids(NUM_THREADS);
+    for_each_worker(NUM_THREADS, [&](const size_t worker_index) {
+      c_ProfileFactory factory(uid_allocator);
+      for (size_t index = 0; index < NUM_PROFILES; ++index) {
+        worker_uids[worker_index].push_back(
+            factory.make_profile("foo@bar.com").m_uid);
+      }
+    });
+
+    std::set<size_t> uids;
+    for (const std::vector<size_t> &worker : worker_uids) {
+      // Each factory counts up through its own reservations
+      CHECK(std::is_sorted(worker.begin(), worker.end()));
+      uids.insert(worker.begin(), worker.end());
+    }
+    CHECK(uids.size() == NUM_THREADS * NUM_PROFILES);
+    // Two blocks per thread, so the shared counter moved eight times
+    CHECK(uid_allocator.m_next_uid == NUM_THREADS * 2 * UID_BLOCK_SIZE);
+  }
+}
+
+} // namespace testing
@@ -0,0 +1,363 @@
+#include <generators.hpp>
+
+#include <aes.hpp>
+#include <cipher.hpp>
+#include <crypt.hpp>
+#include <mode.hpp>
+#include <oracle.hpp>
+#include <padding.hpp>
+#include <raw_bytes.hpp>
+
+#include <doctest/doctest.h>
+#include <rapidcheck.h>
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace testing {
+
+// Two leading blocks whose intermediate bytes end 0x02 x and 0x02 x ^ 3.
+// Guessing x or x ^ 3 for the last byte of either forges valid padding, one
+// as 0x01 and the other as 0x02 0x02, so whichever of the two the candidate
+// order tries first, one block must rule out a longer padding.
+static RawBytes
+gen_longer_padding_prefix(const c_AES128Encrypter &encrypter,
+                          const RawBytes &iv_raw) {
+  const uint8_t last_byte = *rc::gen::arbitrary<uint8_t>();
+  RawBytes prefix_raw = gen_bytes(2 * BLOCK_SIZE_BYTES);
+  const size_t second_to_last = BLOCK_SIZE_BYTES - 2;
+  prefix_raw[second_to_last] = iv_raw[second_to_last] ^ 0x02;
+  prefix_raw[BLOCK_SIZE_BYTES - 1] = last_byte;
+  const RawBytes first_ciphertext_raw = AES_CBC_encrypt(
+      RawBytes(prefix_raw.begin(), prefix_raw.begin() + BLOCK_SIZE_BYTES),
+      encrypter.m_key_schedule, iv_raw);
+  prefix_raw[BLOCK_SIZE_BYTES + second_to_last] =
+      first_ciphertext_raw[second_to_last] ^ 0x02;
+  prefix_raw[(2 * BLOCK_SIZE_BYTES) - 1] = last_byte ^ 0x03;
+  return prefix_raw;
+}
+
+TEST_SUITE("crypt.crypt") {
+
+  TEST_CASE("single byte XOR") {
+    CHECK(rc::check("find_likely_single_xor recovers the key of English text",
+                    [] {
+                      const RawBytes plaintext = gen_english_sentence();
+                      const uint8_t key = *rc::gen::arbitrary<uint8_t>();
+                      const auto [likely_key, score] =
+                          find_likely_single_xor(plaintext ^ key);
+                      RC_ASSERT(uint8_t(likely_key) == key);
+                    }));
+  }
+
+  TEST_CASE("repeating key XOR") {
+    CHECK(rc::check("encrypt_repeating_xor is its own inverse", [] {
+      const RawBytes plaintext = gen_bytes_up_to(MAX_PROPERTY_BYTES);
+      const RawBytes key = gen_bytes(*rc::gen::inRange<size_t>(1, 64));
+      RC_ASSERT(encrypt_repeating_xor(encrypt_repeating_xor(plaintext, key),
+                                      key) == plaintext);
+    }));
+
+    // Cryptopals 1.5
+    CHECK(encrypt_repeating_xor(
+              from_ascii_string("Burning 'em, if you ain't quick and "
+                                "nimble\nI go crazy when I hear a cymbal"),
+              from_ascii_string("ICE")) ==
+          from_hex_string(
+              "0b3637272a2b2e63622c2e69692a23693a2a3c6324202d623d63343c2a2622"
+              "6324272765272a282b2f20430a652e2c652a3124333a653e2b2027630c692b"
+              "20283165286326302e27282f"));
+  }
+
+  TEST_CASE("detect_ecb") {
+    for (const c_CipherBackend &backend : get_cipher_backends()) {
+      CHECK(rc::check(backend.m_name + " ECB with a repeated block is found",
+                      [&backend] {
+                        const std::unique_ptr<c_BlockCipher> cipher =
+                            backend.m_factory(gen_aes_key());
+                        const RawBytes repeated = gen_bytes(BLOCK_SIZE_BYTES);
+                        // Whole blocks between the copies keep both aligned
+                        const size_t gap_blocks =
+                            *rc::gen::inRange<size_t>(0, 8);
+                        RawBytes plaintext =
+                            gen_bytes(gap_blocks * BLOCK_SIZE_BYTES);
+                        plaintext.insert(plaintext.begin(), repeated.begin(),
+                                         repeated.end());
+                        plaintext.insert(plaintext.end(), repeated.begin(),
+                                         repeated.end());
+                        const RawBytes tail = gen_bytes_up_to(
+                            MAX_PROPERTY_BYTES);
+                        plaintext.insert(plaintext.end(), tail.begin(),
+                                         tail.end());
+                        RC_ASSERT(detect_ecb(ECB_encrypt(*cipher, plaintext)));
+                      }));
+
+      CHECK(rc::check(backend.m_name + " CBC is never flagged", [&backend] {
+        const std::unique_ptr<c_BlockCipher> cipher =
+            backend.m_factory(gen_aes_key());
+        // Repeated plaintext blocks are what ECB would give away
+        const RawBytes plaintext(
+            *rc::gen::inRange<size_t>(0, MAX_PROPERTY_BYTES),
+            *rc::gen::arbitrary<uint8_t>());
+        RC_ASSERT(!detect_ecb(CBC_encrypt(*cipher, plaintext, gen_block())));
+      }));
+    }
+  }
+
+  TEST_CASE("block size and length detection") {
+    CHECK(rc::check("The block size and suffix length are found in the "
+                    "expected round trips",
+                    [] {
+                      const c_AES128Encrypter encrypter(
+                          gen_bytes(BLOCK_SIZE_BYTES));
+                      const RawBytes suffix =
+                          gen_bytes_up_to(8 * BLOCK_SIZE_BYTES);
+                      c_ECBSuffixOracle oracle(encrypter, suffix);
+
+                      RC_ASSERT(detect_block_size(oracle) ==
+                                BLOCK_SIZE_BYTES);
+                      // One query alone, then batches until the input
+                      // pushes the padding into a new block
+                      const size_t jump_length =
+                          BLOCK_SIZE_BYTES - (suffix.size() % BLOCK_SIZE_BYTES);
+                      const size_t num_batches =
+                          ((jump_length - 1) / DETECT_BLOCK_SIZE_BATCH_SIZE) +
+                          1;
+                      RC_ASSERT(oracle.m_stats.m_num_round_trips ==
+                                1 + num_batches);
+                      RC_ASSERT(oracle.m_stats.m_num_calls ==
+                                1 + (num_batches *
+                                     DETECT_BLOCK_SIZE_BATCH_SIZE));
+
+                      oracle.m_stats.reset();
+                      RC_ASSERT(detect_length_bytes(BLOCK_SIZE_BYTES,
+                                                    oracle) == suffix.size());
+                      RC_ASSERT(oracle.m_stats.m_num_round_trips == 1U);
+                      RC_ASSERT(oracle.m_stats.m_num_calls ==
+                                BLOCK_SIZE_BYTES + 1);
+                    }));
+  }
+
+  TEST_CASE("c_LatencyHistogram") {
+    using std::chrono::nanoseconds;
+    c_LatencyHistogram histogram;
+    CHECK(histogram.count() == 0U);
+    CHECK(histogram.percentile(0.5) == nanoseconds(0));
+
+    // Bucket n holds [2^(n-1), 2^n), with everything past the top clamped
+    histogram.record(nanoseconds(-5));
+    histogram.record(nanoseconds(0));
+    histogram.record(nanoseconds(1));
+    histogram.record(nanoseconds(2));
+    histogram.record(nanoseconds(3));
+    histogram.record(nanoseconds(1023));
+    histogram.record(nanoseconds(1024));
+    histogram.record(nanoseconds::max());
+    CHECK(histogram.m_buckets[0] == 2U);
+    CHECK(histogram.m_buckets[1] == 1U);
+    CHECK(histogram.m_buckets[2] == 2U);
+    CHECK(histogram.m_buckets[10] == 1U);
+    CHECK(histogram.m_buckets[11] == 1U);
+    CHECK(histogram.m_buckets[LATENCY_HISTOGRAM_NUM_BUCKETS - 1] == 1U);
+    CHECK(histogram.count() == 8U);
+
+    // Percentiles report the upper edge of the bucket holding that rank
+    histogram.reset();
+    CHECK(histogram.count() == 0U);
+    for (size_t index = 0; index < 90; ++index) {
+      histogram.record(nanoseconds(100));
+    }
+    for (size_t index = 0; index < 10; ++index) {
+      histogram.record(nanoseconds(5000));
+    }
+    CHECK(histogram.percentile(0.0) == nanoseconds(128));
+    CHECK(histogram.percentile(0.5) == nanoseconds(128));
+    CHECK(histogram.percentile(0.9) == nanoseconds(128));
+    CHECK(histogram.percentile(0.91) == nanoseconds(8192));
+    CHECK(histogram.percentile(1.0) == nanoseconds(8192));
+  }
+
+  TEST_CASE("byte at a time") {
+    for (const bool use_candidate_model : {false, true}) {
+      CHECK(rc::check("The suffix is recovered, in as many calls as the "
+                      "stats report",
+                      [use_candidate_model] {
+                        const c_AES128Encrypter encrypter(
+                            gen_bytes(BLOCK_SIZE_BYTES));
+                        const RawBytes suffix =
+                            *rc::gen::arbitrary<bool>()
+                                ? gen_english_sentence()
+                                : gen_bytes_up_to(8 * BLOCK_SIZE_BYTES);
+                        c_ECBSuffixOracle oracle(encrypter, suffix);
+                        c_ByteAtATimeConfig config;
+                        config.m_use_candidate_model = use_candidate_model;
+                        config.m_num_threads =
+                            *rc::gen::inRange<size_t>(1, 5);
+                        config.m_batch_size =
+                            *rc::gen::inRange<size_t>(1, 65);
+                        c_ByteAtATimeStats stats;
+                        RC_ASSERT(break_ecb_byte_at_a_time(
+                                      BLOCK_SIZE_BYTES, suffix.size(),
+                                      oracle, config, stats) == suffix);
+                        RC_ASSERT(stats.m_bytes_recovered == suffix.size());
+                        RC_ASSERT(stats.m_oracle_calls ==
+                                  oracle.m_stats.m_num_calls);
+                        if (config.m_num_threads == 1) {
+                          // One worker searches exactly as a serial search
+                          // would, after one probe per prefix length
+                          RC_ASSERT(stats.m_oracle_calls ==
+                                    BLOCK_SIZE_BYTES +
+                                        stats.m_serial_oracle_calls);
+                        }
+                        if (!suffix.empty()) {
+                          RC_ASSERT(stats.expected_oracle_calls_per_byte() ==
+                                    double(stats.m_serial_oracle_calls) /
+                                        suffix.size());
+                          RC_ASSERT(stats.oracle_calls_per_byte() ==
+                                    double(stats.m_oracle_calls) /
+                                        suffix.size());
+                        }
+                      }));
+    }
+
+    // English ranks well under the model, and poorly in numeric order
+    const c_AES128Encrypter encrypter(RawBytes(BLOCK_SIZE_BYTES, 0));
+    const RawBytes suffix = from_ascii_string(
+        "Rollin' in my 5.0\nWith my rag-top down so my hair can blow\n");
+    std::vector<double> expected_calls_per_byte;
+    for (const bool use_candidate_model : {false, true}) {
+      c_ECBSuffixOracle oracle(encrypter, suffix);
+      c_ByteAtATimeConfig config;
+      config.m_use_candidate_model = use_candidate_model;
+      config.m_batch_size = 1;
+      c_ByteAtATimeStats stats;
+      CHECK(break_ecb_byte_at_a_time(BLOCK_SIZE_BYTES, suffix.size(), oracle,
+                                     config, stats) == suffix);
+      CHECK(stats.oracle_calls_per_byte() ==
+            double(BLOCK_SIZE_BYTES + stats.m_serial_oracle_calls) /
+                suffix.size());
+      expected_calls_per_byte.push_back(
+          stats.expected_oracle_calls_per_byte());
+    }
+    CHECK(expected_calls_per_byte[1] < expected_calls_per_byte[0]);
+
+    // Past the suffix the first padding byte still matches, but the next
+    // one sits in a block padded with 0x02 0x02 and cannot
+    for (const size_t num_threads : {1, 4}) {
+      c_ECBSuffixOracle oracle(encrypter, suffix);
+      c_ByteAtATimeConfig config;
+      config.m_num_threads = num_threads;
+      c_ByteAtATimeStats stats;
+      CHECK_THROWS_AS(break_ecb_byte_at_a_time(BLOCK_SIZE_BYTES,
+                                               suffix.size() + 2, oracle,
+                                               config, stats),
+                      std::runtime_error);
+      CHECK(stats.m_bytes_recovered == suffix.size() + 1);
+      CHECK(stats.m_oracle_calls == oracle.m_stats.m_num_calls);
+    }
+  }
+
+  TEST_CASE("random prefix byte at a time") {
+    CHECK(rc::check("The prefix is measured and the suffix recovered, in as "
+                    "many calls as the stats report",
+                    [] {
+                      const c_AES128Encrypter encrypter(
+                          gen_bytes(BLOCK_SIZE_BYTES));
+                      const RawBytes prefix =
+                          gen_bytes_up_to(MAX_RANDOM_PREFIX_LENGTH_BYTES);
+                      // A suffix of repeated marker blocks must not be taken
+                      // for the probe
+                      const bool is_repetitive = *rc::gen::arbitrary<bool>();
+                      const size_t suffix_length = *rc::gen::inRange<size_t>(
+                          0, 8 * BLOCK_SIZE_BYTES);
+                      const RawBytes suffix =
+                          is_repetitive
+                              ? RawBytes(suffix_length, PREFIX_ALIGNMENT_MARKER)
+                              : gen_bytes(suffix_length);
+                      c_ECBSuffixOracle oracle(encrypter, prefix, suffix);
+
+                      const c_PrefixAlignment alignment =
+                          find_prefix_alignment(BLOCK_SIZE_BYTES, oracle);
+                      RC_ASSERT(alignment.m_prefix_length_bytes ==
+                                prefix.size());
+                      RC_ASSERT(alignment.m_suffix_length_bytes ==
+                                suffix.size());
+                      RC_ASSERT(alignment.m_filler_length_bytes >= 1U);
+                      RC_ASSERT(alignment.m_num_prefix_blocks *
+                                    BLOCK_SIZE_BYTES ==
+                                prefix.size() +
+                                    alignment.m_filler_length_bytes);
+                      RC_ASSERT(oracle.m_stats.m_num_round_trips == 1U);
+
+                      oracle.m_stats.reset();
+                      c_ByteAtATimeConfig config;
+                      config.m_num_threads = *rc::gen::inRange<size_t>(1, 5);
+                      c_RandomPrefixStats stats;
+                      RC_ASSERT(break_ecb_random_prefix(BLOCK_SIZE_BYTES,
+                                                        oracle, config,
+                                                        stats) == suffix);
+                      RC_ASSERT(stats.m_alignment_oracle_calls ==
+                                BLOCK_SIZE_BYTES);
+                      RC_ASSERT(oracle.m_stats.m_num_calls ==
+                                stats.oracle_calls());
+                    }));
+
+    const c_AES128Encrypter encrypter(RawBytes(BLOCK_SIZE_BYTES, 0));
+    const c_ECBRandomPrefixOracle oracle(encrypter, RawBytes(), 8);
+    CHECK(oracle.m_secret_prefix_raw.size() <= 8U);
+  }
+
+  TEST_CASE("CBC padding oracle") {
+    CHECK(rc::check("The padded plaintext is recovered, in as many calls as "
+                    "the stats report",
+                    [] {
+                      const c_AES128Encrypter encrypter(
+                          gen_bytes(BLOCK_SIZE_BYTES));
+                      const RawBytes iv_raw = gen_bytes(BLOCK_SIZE_BYTES);
+                      RawBytes plaintext_raw =
+                          gen_longer_padding_prefix(encrypter, iv_raw);
+                      const RawBytes tail_raw =
+                          gen_bytes_up_to(4 * BLOCK_SIZE_BYTES);
+                      plaintext_raw.insert(plaintext_raw.end(),
+                                           tail_raw.begin(), tail_raw.end());
+                      const RawBytes ciphertext_raw = AES_CBC_encrypt(
+                          plaintext_raw, encrypter.m_key_schedule, iv_raw);
+
+                      c_CBCPaddingOracle oracle(encrypter);
+                      c_PaddingOracleConfig config;
+                      config.m_use_candidate_model =
+                          *rc::gen::arbitrary<bool>();
+                      config.m_num_threads = *rc::gen::inRange<size_t>(1, 5);
+                      c_PaddingOracleStats stats;
+                      RC_ASSERT(break_cbc_padding_oracle(oracle, iv_raw,
+                                                         ciphertext_raw,
+                                                         config, stats) ==
+                                add_pkcs7_padding(plaintext_raw));
+                      RC_ASSERT(stats.m_bytes_recovered ==
+                                ciphertext_raw.size());
+                      RC_ASSERT(stats.m_oracle_calls ==
+                                oracle.m_stats.m_num_calls);
+                      RC_ASSERT(stats.m_longer_paddings_ruled_out >= 1U);
+                    }));
+
+    const c_AES128Encrypter encrypter(RawBytes(BLOCK_SIZE_BYTES, 0));
+    c_CBCPaddingOracle oracle(encrypter);
+    const c_PaddingOracleConfig config;
+    c_PaddingOracleStats stats;
+    const RawBytes iv_raw(BLOCK_SIZE_BYTES, 0);
+    CHECK_THROWS_AS(break_cbc_padding_oracle(
+                        oracle, RawBytes(BLOCK_SIZE_BYTES - 1, 0),
+                        RawBytes(BLOCK_SIZE_BYTES, 0), config, stats),
+                    std::invalid_argument);
+    CHECK_THROWS_AS(break_cbc_padding_oracle(
+                        oracle, iv_raw, RawBytes(BLOCK_SIZE_BYTES + 1, 0),
+                        config, stats),
+                    std::invalid_argument);
+    CHECK(oracle.m_stats.m_num_calls == 0U);
+  }
+}
+
+} // namespace testing
@@ -0,0 +1,109 @@
+#include <generators.hpp>
+
+#include <aes.hpp>
+#include <cookie.hpp>
+#include <cut_and_paste.hpp>
+#include <oracle.hpp>
+#include <raw_bytes.hpp>
+
+#include <doctest/doctest.h>
+#include <rapidcheck.h>
+
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace testing {
+
+static const std::vector<std::string> COOKIE_FIELD_NAMES = {
+    "email", "mail", "user", "login", "e", "address", "account"};
+
+// A profile_for with its own field names and a fixed uid
+struct c_CookieFormat {
+  std::string operator()(const std::string_view email) const {
+    return to_string(email, "user");
+  }
+
+  std::string to_string(const std::string_view email,
+                        const std::string &role) const {
+    return m_email_field + "=" +
+           c_ProfileCookie::encode_string(std::string(email)) + "&" +
+           m_uid_field + "=" + std::to_string(m_uid) + "&" + m_role_field +
+           "=" + role;
+  }
+
+  std::string m_email_field;
+  std::string m_uid_field;
+  std::string m_role_field;
+  size_t m_uid = 0;
+};
+
+// Tries emails until the admin role starts a block of its own
+static std::string find_admin_target(const c_CookieFormat &format,
+                                     c_CutAndPastePlan &plan) {
+  for (size_t local_length = 1; local_length <= BLOCK_SIZE_BYTES;
+       ++local_length) {
+    const std::string target =
+        format.to_string(std::string(local_length, 'x') + "@admin.com",
+                         "admin");
+    try {
+      plan = plan_cut_and_paste(format, target, BLOCK_SIZE_BYTES);
+      return target;
+    } catch (const std::invalid_argument &) {
+    }
+  }
+  throw std::logic_error("No email length aligns the role!");
+}
+
+TEST_SUITE("crypt.cut_and_paste") {
+
+  TEST_CASE("forgery") {
+    CHECK(rc::check("Every format variant is forged in one batch", [] {
+      c_CookieFormat format;
+      format.m_email_field = *rc::gen::elementOf(COOKIE_FIELD_NAMES);
+      format.m_uid_field = *rc::gen::elementOf(COOKIE_FIELD_NAMES);
+      format.m_role_field = *rc::gen::elementOf(COOKIE_FIELD_NAMES);
+      format.m_uid = *rc::gen::inRange<size_t>(0, 1000000);
+      RC_ASSERT(find_template_input_offset(format) ==
+                format.m_email_field.size() + 1);
+
+      c_CutAndPastePlan plan;
+      const std::string target = find_admin_target(format, plan);
+      RC_ASSERT(plan.m_probes.size() <= 2U);
+
+      const c_AES128Encrypter encrypter(gen_bytes(BLOCK_SIZE_BYTES));
+      c_CountingOracle oracle([&encrypter, &format](const ByteSpan input) {
+        return encrypter.encrypt(from_ascii_string(format(std::string_view(
+            reinterpret_cast<const char *>(input.data()), input.size()))));
+      });
+      const RawBytes forged_raw =
+          forge_cut_and_paste(plan, BLOCK_SIZE_BYTES, oracle);
+      RC_ASSERT(encrypter.decrypt(forged_raw) == from_ascii_string(target));
+      RC_ASSERT(oracle.m_stats.m_num_round_trips == 1U);
+      RC_ASSERT(oracle.m_stats.m_num_calls == plan.m_probes.size());
+    }));
+  }
+
+  TEST_CASE("unreachable targets") {
+    const c_CookieFormat format{"email", "uid", "role", 10};
+    // The template never writes the role before the uid
+    CHECK_THROWS_AS(plan_cut_and_paste(format,
+                                       "email=xxxxxxxxxx&role=admin&uid=10",
+                                       BLOCK_SIZE_BYTES),
+                    std::invalid_argument);
+    CHECK_THROWS_AS(
+        find_template_input_offset([](std::string_view) {
+          return std::string("constant");
+        }),
+        std::invalid_argument);
+
+    const RawBytes answer(BLOCK_SIZE_BYTES);
+    const std::vector<ByteSpan> answers = {answer};
+    const std::vector<c_BlockSource> sources = {{0, 1}};
+    CHECK_THROWS_AS(splice_blocks(answers, sources, BLOCK_SIZE_BYTES),
+                    std::out_of_range);
+  }
+}
+
+} // namespace testing
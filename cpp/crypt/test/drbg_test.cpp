@@ -0,0 +1,141 @@
+#include <generators.hpp>
+
+#include <drbg.hpp>
+#include <rand.hpp>
+#include <raw_bytes.hpp>
+
+#include <doctest/doctest.h>
+#include <rapidcheck.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace testing {
+
+static DrbgSeed to_drbg_seed(const std::string &hex) {
+  const RawBytes seed_raw = from_hex_string(hex);
+  DrbgSeed seed_material{};
+  std::copy(seed_raw.begin(), seed_raw.end(), seed_material.begin());
+  return seed_material;
+}
+
+static uint64_t draw_uint64(c_CtrDrbg &drbg) {
+  uint64_t output;
+  drbg.generate(std::span{reinterpret_cast<uint8_t *>(&output),
+                          sizeof(output)});
+  return output;
+}
+
+// Half of all 64 bit draws fall above the last complete copy of this range
+constexpr inline size_t HALF_REJECTED_RANGE_END = size_t(1) << 63;
+
+TEST_SUITE("crypt.drbg") {
+
+  TEST_CASE("SP 800-90A known answer") {
+    // CAVP CTR_DRBG, AES-128 without a derivation function or prediction
+    // resistance, COUNT = 0: instantiate, reseed, then generate twice
+    c_CtrDrbg drbg(to_drbg_seed("ed1e7f21ef66ea5d8e2a85b9337245445b71d6393a"
+                                "4eecb0e63c193d0f72f9a9"),
+                   true);
+    drbg.reseed(to_drbg_seed("303fb519f0a4e17d6df0b6426aa0ecb2a36079bd48be"
+                             "47ad2a8dbfe48da3efad"));
+    RawBytes returned_bits(64);
+    drbg.generate(returned_bits);
+    drbg.generate(returned_bits);
+    CHECK(returned_bits ==
+          from_hex_string("f80111d08e874672f32f42997133a5210f7a9375e22cea70"
+                          "587f9cfafebe0f6a6aa2eb68e7dd9164536d53fa020fcab2"
+                          "0f54caddfab7d6d91e5ffec1dfd8deaa"));
+    CHECK(drbg.is_deterministic());
+  }
+
+  TEST_CASE("seeded streams") {
+    CHECK(rc::check("c_CtrDrbg repeats its stream for the same seed", [] {
+      const uint64_t seed = *rc::gen::arbitrary<uint64_t>();
+      const size_t length = *rc::gen::inRange<size_t>(
+          0, 2 * CTR_DRBG_MAX_REQUEST_BYTES);
+      c_CtrDrbg first(seed);
+      c_CtrDrbg second(seed);
+      c_CtrDrbg other(seed + 1);
+      RawBytes first_raw(length);
+      RawBytes second_raw(length);
+      RawBytes other_raw(length);
+      first.generate(first_raw);
+      second.generate(second_raw);
+      other.generate(other_raw);
+      RC_ASSERT(first.is_deterministic());
+      RC_ASSERT(first_raw == second_raw);
+      RC_ASSERT(length < BLOCK_SIZE_BYTES || first_raw != other_raw);
+    }));
+
+    CHECK(rc::check("seed_thread_random repeats the thread's stream", [] {
+      const uint64_t seed = *rc::gen::arbitrary<uint64_t>();
+      // Mixes requests served from the buffer with ones that bypass it
+      const std::vector<size_t> lengths = *rc::gen::container<
+          std::vector<size_t>>(rc::gen::inRange<size_t>(
+          0, 2 * RANDOM_BUFFER_SIZE_BYTES));
+      std::array<RawBytes, 2> streams;
+      for (RawBytes &stream : streams) {
+        seed_thread_random(seed);
+        c_RandomByteGenerator generator;
+        for (const size_t length : lengths) {
+          const RawBytes output = generator.generate_n_random_bytes(length);
+          stream.insert(stream.end(), output.begin(), output.end());
+        }
+      }
+      reseed_thread_random();
+      RC_ASSERT(streams[0] == streams[1]);
+    }));
+  }
+
+  TEST_CASE("generate_in_range") {
+    CHECK(rc::check("Draws stay within the inclusive bounds", [] {
+      c_RandomByteGenerator generator(*rc::gen::arbitrary<uint64_t>());
+      const size_t first = *rc::gen::arbitrary<size_t>();
+      const size_t second = *rc::gen::arbitrary<size_t>();
+      const size_t begin = std::min(first, second);
+      const size_t end_inclusive = std::max(first, second);
+      const size_t output = generator.generate_in_range(begin, end_inclusive);
+      RC_ASSERT(output >= begin);
+      RC_ASSERT(output <= end_inclusive);
+      RC_ASSERT(generator.generate_in_range(begin, begin) == begin);
+    }));
+
+    // Replays the seeded stream eight bytes at a time, dropping the draws
+    // that rejection sampling must skip
+    size_t num_rejected = 0;
+    for (uint64_t seed = 0; seed < 64; ++seed) {
+      c_RandomByteGenerator generator(seed);
+      c_CtrDrbg reference(seed);
+      uint64_t draw = draw_uint64(reference);
+      for (; draw > HALF_REJECTED_RANGE_END; draw = draw_uint64(reference)) {
+        ++num_rejected;
+      }
+      CHECK(generator.generate_in_range(0, HALF_REJECTED_RANGE_END) == draw);
+    }
+    CHECK(num_rejected > 0U);
+
+    // The full range takes every draw as it is
+    c_RandomByteGenerator generator(0);
+    c_CtrDrbg reference(0);
+    CHECK(generator.generate_in_range(0, std::numeric_limits<size_t>::max()) ==
+          draw_uint64(reference));
+
+    // A small range reaches both of its ends
+    std::vector<size_t> counts(6, 0);
+    for (size_t draw_index = 0; draw_index < 600; ++draw_index) {
+      const size_t output = generator.generate_in_range(5, 10);
+      REQUIRE(output >= 5U);
+      REQUIRE(output <= 10U);
+      ++counts[output - 5];
+    }
+    CHECK(std::ranges::all_of(counts, [](size_t count) { return count > 0; }));
+  }
+}
+
+} // namespace testing
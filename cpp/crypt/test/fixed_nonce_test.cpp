@@ -0,0 +1,189 @@
+#include <generators.hpp>
+
+#include <fixed_nonce.hpp>
+#include <raw_bytes.hpp>
+
+#include <doctest/doctest.h>
+#include <rapidcheck.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace testing {
+
+constexpr size_t FIXED_NONCE_TEST_ROWS = 200;
+// Columns with fewer bytes than this are too shallow to be sure of
+constexpr size_t FIXED_NONCE_TEST_MIN_DEPTH = 64;
+
+struct c_FixedNonceCase {
+  std::vector<RawBytes> m_plaintexts;
+  std::vector<RawBytes> m_ciphertexts;
+  RawBytes m_keystream;
+};
+
+static c_FixedNonceCase gen_fixed_nonce_case(const size_t num_rows) {
+  c_FixedNonceCase output;
+  size_t longest = 0;
+  for (size_t row = 0; row < num_rows; ++row) {
+    output.m_plaintexts.push_back(gen_english_sentence());
+    longest = std::max(longest, output.m_plaintexts.back().size());
+  }
+  output.m_keystream = gen_bytes(longest);
+  output.m_ciphertexts = output.m_plaintexts;
+  for (auto &ciphertext : output.m_ciphertexts) {
+    xor_in_place(ciphertext, ByteSpan(output.m_keystream)
+                                 .first(ciphertext.size()));
+  }
+  return output;
+}
+
+TEST_SUITE("crypt.fixed_nonce") {
+
+  TEST_CASE("keystream matrix") {
+    CHECK(rc::check("Columns hold every ciphertext long enough, longest first",
+                    [] {
+                      const size_t num_rows = *rc::gen::inRange<size_t>(
+                          0, FIXED_NONCE_TEST_ROWS);
+                      std::vector<RawBytes> ciphertexts;
+                      for (size_t row = 0; row < num_rows; ++row) {
+                        ciphertexts.push_back(
+                            gen_bytes_up_to(MAX_PROPERTY_BYTES));
+                      }
+                      const c_KeystreamMatrix matrix(ciphertexts);
+                      size_t longest = 0;
+                      for (size_t row = 0; row < ciphertexts.size(); ++row) {
+                        longest = std::max(longest, ciphertexts[row].size());
+                        RC_ASSERT(matrix.row_length(row) ==
+                                  ciphertexts[row].size());
+                      }
+                      RC_ASSERT(matrix.num_rows() == ciphertexts.size());
+                      RC_ASSERT(matrix.num_columns() == longest);
+                      for (size_t column_index = 0;
+                           column_index < longest; ++column_index) {
+                        const ByteSpan column = matrix.column(column_index);
+                        for (size_t rank = 0; rank < column.size(); ++rank) {
+                          const RawBytes &ciphertext =
+                              ciphertexts[matrix.m_row_order[rank]];
+                          RC_ASSERT(column_index < ciphertext.size());
+                          RC_ASSERT(column[rank] == ciphertext[column_index]);
+                        }
+                        RC_ASSERT(
+                            size_t(std::count_if(
+                                std::begin(ciphertexts), std::end(ciphertexts),
+                                [column_index](const RawBytes &ciphertext) {
+                                  return ciphertext.size() > column_index;
+                                })) == column.size());
+                      }
+                    }));
+    CHECK_THROWS_AS(c_KeystreamMatrix(std::vector<RawBytes>{RawBytes(2)})
+                        .at(0, 2),
+                    std::out_of_range);
+  }
+
+  TEST_CASE("keystream recovery") {
+    CHECK(rc::check("Every well covered keystream byte is recovered, on any "
+                    "number of threads",
+                    [] {
+                      const c_FixedNonceCase test_case =
+                          gen_fixed_nonce_case(FIXED_NONCE_TEST_ROWS);
+                      const c_KeystreamMatrix matrix(test_case.m_ciphertexts);
+                      c_FixedNonceConfig config;
+                      config.m_num_threads = 1;
+                      const RawBytes keystream =
+                          recover_fixed_nonce_keystream(
+                              matrix, english_language_model(), config);
+                      config.m_num_threads = *rc::gen::inRange<size_t>(2, 9);
+                      RC_ASSERT(recover_fixed_nonce_keystream(
+                                    matrix, english_language_model(),
+                                    config) == keystream);
+
+                      RC_ASSERT(keystream.size() ==
+                                test_case.m_keystream.size());
+                      for (size_t column_index = 0;
+                           column_index < keystream.size(); ++column_index) {
+                        if (matrix.column_depth(column_index) >=
+                            FIXED_NONCE_TEST_MIN_DEPTH) {
+                          RC_ASSERT(keystream[column_index] ==
+                                    test_case.m_keystream[column_index]);
+                        }
+                      }
+                    }));
+  }
+
+  TEST_CASE("crib dragging") {
+    CHECK(rc::check("A crib from one plaintext is placed where it came from",
+                    [] {
+                      const c_FixedNonceCase test_case =
+                          gen_fixed_nonce_case(FIXED_NONCE_TEST_ROWS);
+                      const c_KeystreamMatrix matrix(test_case.m_ciphertexts);
+                      const size_t row = *rc::gen::inRange<size_t>(
+                          0, FIXED_NONCE_TEST_ROWS);
+                      const RawBytes &plaintext = test_case.m_plaintexts[row];
+                      const size_t crib_length = 16;
+                      const size_t column_index = *rc::gen::inRange<size_t>(
+                          0, plaintext.size() - crib_length + 1);
+                      const RawBytes crib(
+                          std::begin(plaintext) + column_index,
+                          std::begin(plaintext) + column_index + crib_length);
+
+                      RawBytes keystream;
+                      apply_crib(matrix, {row, column_index, 0.0}, crib,
+                                 keystream);
+                      RC_ASSERT(keystream.size() ==
+                                column_index + crib_length);
+                      RC_ASSERT(std::equal(
+                          std::begin(keystream) + column_index,
+                          std::end(keystream),
+                          std::begin(test_case.m_keystream) + column_index));
+
+                      // Other rows may hold the crib too, so any placement
+                      // implying the right keystream will do
+                      const std::vector<c_CribPlacement> placements =
+                          drag_crib(matrix, crib, 1);
+                      RC_ASSERT(placements.size() == 1U);
+                      RawBytes dragged_keystream;
+                      apply_crib(matrix, placements.front(), crib,
+                                 dragged_keystream);
+                      const size_t dragged_column =
+                          placements.front().m_column;
+                      RC_ASSERT(std::equal(
+                          std::begin(dragged_keystream) + dragged_column,
+                          std::end(dragged_keystream),
+                          std::begin(test_case.m_keystream) +
+                              dragged_column));
+                    }));
+    CHECK_THROWS_AS(drag_crib(c_KeystreamMatrix(std::vector<RawBytes>{}),
+                              RawBytes{}, 1),
+                    std::invalid_argument);
+    const c_KeystreamMatrix matrix(std::vector<RawBytes>{RawBytes(4)});
+    RawBytes keystream;
+    CHECK_THROWS_AS(apply_crib(matrix, {0, 2, 0.0}, RawBytes(3), keystream),
+                    std::out_of_range);
+  }
+
+  TEST_CASE("decryption") {
+    CHECK(rc::check("XOR with the keystream, cut to its length", [] {
+      const c_FixedNonceCase test_case = gen_fixed_nonce_case(
+          *rc::gen::inRange<size_t>(1, FIXED_NONCE_TEST_ROWS));
+      RC_ASSERT(decrypt_fixed_nonce(test_case.m_ciphertexts,
+                                    test_case.m_keystream) ==
+                test_case.m_plaintexts);
+      const size_t keystream_length =
+          *rc::gen::inRange<size_t>(0, test_case.m_keystream.size());
+      const std::vector<RawBytes> plaintexts = decrypt_fixed_nonce(
+          test_case.m_ciphertexts,
+          ByteSpan(test_case.m_keystream).first(keystream_length));
+      for (size_t row = 0; row < plaintexts.size(); ++row) {
+        const RawBytes &plaintext = test_case.m_plaintexts[row];
+        RC_ASSERT(plaintexts[row] ==
+                  RawBytes(std::begin(plaintext),
+                           std::begin(plaintext) +
+                               std::min(plaintext.size(), keystream_length)));
+      }
+    }));
+  }
+}
+
+} // namespace testing
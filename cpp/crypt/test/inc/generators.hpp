@@ -0,0 +1,86 @@
+#pragma once
+
+#include <aes.hpp>
+#include <block.hpp>
+#include <cipher.hpp>
+#include <raw_bytes.hpp>
+
+#include <rapidcheck.h>
+
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace testing {
+
+// Longest input the properties generate, long enough to cover every
+// multi-block kernel with a partial batch left over
+constexpr inline size_t MAX_PROPERTY_BLOCKS = 40;
+constexpr inline size_t MAX_PROPERTY_BYTES =
+    MAX_PROPERTY_BLOCKS * BLOCK_SIZE_BYTES;
+
+inline RawBytes gen_bytes(const size_t length) {
+  return *rc::gen::container<RawBytes>(length, rc::gen::arbitrary<uint8_t>());
+}
+
+inline RawBytes gen_bytes_up_to(const size_t max_length) {
+  return gen_bytes(*rc::gen::inRange<size_t>(0, max_length + 1));
+}
+
+inline ByteBlock gen_block() {
+  return from_raw_bytes_to_byte_block(gen_bytes(BLOCK_SIZE_BYTES));
+}
+
+// A 16, 24 or 32 byte key
+inline RawBytes gen_aes_key() {
+  const size_t key_length_words =
+      *rc::gen::element(AES_128_KEY_LENGTH_WORDS, AES_192_KEY_LENGTH_WORDS,
+                        AES_256_KEY_LENGTH_WORDS);
+  return gen_bytes(key_length_words * WORD_SIZE_BYTES);
+}
+
+inline std::string to_hex(const RawBytes &input) {
+  std::stringstream output;
+  to_hex_string(output, input);
+  return output.str();
+}
+
+inline std::string to_base64(const RawBytes &input) {
+  std::stringstream output;
+  to_base64_string(output, input);
+  return output.str();
+}
+
+inline const std::vector<std::string> ENGLISH_WORDS = {
+    "the",   "of",    "and",    "to",     "in",     "is",    "you",
+    "that",  "it",    "he",     "was",    "for",    "on",    "are",
+    "as",    "with",  "his",    "they",   "at",     "be",    "this",
+    "have",  "from",  "or",     "one",    "had",    "by",    "word",
+    "but",   "not",   "what",   "all",    "were",   "we",    "when",
+    "your",  "can",   "said",   "there",  "use",    "an",    "each",
+    "which", "she",   "do",     "how",    "their",  "if",    "will",
+    "up",    "other", "about",  "out",    "many",   "then",  "them",
+    "these", "so",    "some",   "her",    "would",  "make",  "like",
+    "him",   "into",  "time",   "has",    "look",   "two",   "more",
+    "write", "go",    "see",    "number", "no",     "way",   "could",
+    "people"};
+
+// Enough words that the letter and space counts settle
+constexpr inline size_t MIN_SENTENCE_WORDS = 12;
+constexpr inline size_t MAX_SENTENCE_WORDS = 40;
+
+inline RawBytes gen_english_sentence() {
+  const size_t num_words = *rc::gen::inRange<size_t>(MIN_SENTENCE_WORDS,
+                                                     MAX_SENTENCE_WORDS + 1);
+  std::string sentence;
+  for (size_t word_index = 0; word_index < num_words; ++word_index) {
+    if (word_index > 0) {
+      sentence += ' ';
+    }
+    sentence += *rc::gen::elementOf(ENGLISH_WORDS);
+  }
+  return from_ascii_string(sentence);
+}
+
+} // namespace testing
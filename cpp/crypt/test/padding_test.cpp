@@ -0,0 +1,72 @@
+#include <generators.hpp>
+
+#include <padding.hpp>
+#include <raw_bytes.hpp>
+
+#include <doctest/doctest.h>
+#include <rapidcheck.h>
+
+#include <cstdint>
+#include <stdexcept>
+
+namespace testing {
+
+TEST_SUITE("crypt.padding") {
+
+  TEST_CASE("round trip") {
+    CHECK(rc::check("remove_pkcs7_padding inverts add_pkcs7_padding", [] {
+      const size_t block_size_bytes = *rc::gen::inRange<size_t>(1, 256);
+      const RawBytes input = gen_bytes_up_to(MAX_PROPERTY_BYTES);
+      const RawBytes padded = add_pkcs7_padding(input, block_size_bytes);
+      RC_ASSERT(padded.size() ==
+                pkcs7_padded_length(input.size(), block_size_bytes));
+      RC_ASSERT(padded.size() % block_size_bytes == 0);
+      RC_ASSERT(padded.size() > input.size());
+      RC_ASSERT(padded.size() <= input.size() + block_size_bytes);
+
+      size_t unpadded_length = 0;
+      RC_ASSERT(validate_pkcs7_padding(padded, block_size_bytes,
+                                       unpadded_length));
+      RC_ASSERT(unpadded_length == input.size());
+      RC_ASSERT(remove_pkcs7_padding(padded, block_size_bytes) == input);
+    }));
+
+    CHECK(rc::check("pad_pkcs7_in_place matches add_pkcs7_padding", [] {
+      const RawBytes input = gen_bytes_up_to(MAX_PROPERTY_BYTES);
+      RawBytes buffer = input;
+      buffer.resize(pkcs7_padded_length(input.size()));
+      RC_ASSERT(pad_pkcs7_in_place(buffer, input.size()) == buffer.size());
+      RC_ASSERT(buffer == add_pkcs7_padding(input));
+    }));
+  }
+
+  TEST_CASE("bad padding") {
+    CHECK(rc::check("changing any padding byte fails validation", [] {
+      const RawBytes padded =
+          add_pkcs7_padding(gen_bytes_up_to(MAX_PROPERTY_BYTES));
+      const size_t pad_length = padded.back();
+      // A changed final byte can describe shorter padding that is valid
+      RC_PRE(pad_length > 1);
+      RawBytes corrupted = padded;
+      const size_t index = padded.size() - 1 -
+                           *rc::gen::inRange<size_t>(1, pad_length);
+      corrupted[index] ^= *rc::gen::inRange<uint8_t>(1, 255);
+      RC_ASSERT(!validate_pkcs7_padding(corrupted));
+      RC_ASSERT_THROWS(remove_pkcs7_padding(corrupted));
+    }));
+
+    CHECK(rc::check("padding must fill at most one block and not be zero", [] {
+      const uint8_t pad_length = *rc::gen::arbitrary<uint8_t>();
+      RC_PRE(pad_length == 0 || pad_length > BLOCK_SIZE_BYTES);
+      const RawBytes padded(2 * BLOCK_SIZE_BYTES, pad_length);
+      RC_ASSERT(!validate_pkcs7_padding(padded));
+    }));
+
+    CHECK_FALSE(validate_pkcs7_padding(RawBytes{}));
+    CHECK_FALSE(validate_pkcs7_padding(RawBytes(BLOCK_SIZE_BYTES + 1, 1)));
+    CHECK_THROWS_AS(remove_pkcs7_padding(RawBytes(3, 3)),
+                    std::invalid_argument);
+  }
+}
+
+} // namespace testing
@@ -1,8 +1,14 @@
+#include <generators.hpp>
+
 #include <raw_bytes.hpp>
 
 #include <doctest/doctest.h>
 #include <rapidcheck.h>
 
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
 namespace testing {
 
 TEST_SUITE("crypt.raw_bytes") {
@@ -17,6 +23,81 @@ TEST_SUITE("crypt.raw_bytes") {
     rc::check("∀i ∈ ℤ: example(i) == i * 3",
               [](int i) { return (3 * i) == i * 3; });
   }
+
+  TEST_CASE("hex") {
+    CHECK(rc::check("from_hex_string inverts to_hex_string",
+                    [](const RawBytes &input) {
+                      const std::string hex = to_hex(input);
+                      RC_ASSERT(hex.size() == 2 * input.size());
+                      RC_ASSERT(from_hex_string(hex) == input);
+                    }));
+  }
+
+  TEST_CASE("base64") {
+    CHECK(rc::check("from_base64_string inverts to_base64_string",
+                    [](const RawBytes &input) {
+                      const std::string base64 = to_base64(input);
+                      RC_ASSERT(base64.size() == 4 * ((input.size() + 2) / 3));
+                      RC_ASSERT(from_base64_string(base64) == input);
+                    }));
+
+    // Cryptopals 1.1
+    CHECK(to_base64(from_hex_string(
+              "49276d206b696c6c696e6720796f757220627261696e206c696b65206120"
+              "706f69736f6e6f7573206d757368726f6f6d")) ==
+          "SSdtIGtpbGxpbmcgeW91ciBicmFpbiBsaWtlIGEgcG9pc29ub3VzIG11c2hyb29t");
+  }
+
+  TEST_CASE("xor") {
+    CHECK(rc::check("xor_in_place matches XOR byte by byte", [] {
+      const RawBytes input_1 = gen_bytes_up_to(MAX_PROPERTY_BYTES);
+      const RawBytes input_2 = gen_bytes(input_1.size());
+      RawBytes output = input_1;
+      xor_in_place(output, input_2);
+      for (size_t index = 0; index < input_1.size(); ++index) {
+        RC_ASSERT(output[index] == uint8_t(input_1[index] ^ input_2[index]));
+      }
+      RC_ASSERT((output ^ input_2) == input_1);
+    }));
+
+    CHECK(rc::check("XOR with a single byte key is an involution",
+                    [](const RawBytes &input, const uint8_t key) {
+                      RC_ASSERT(((input ^ key) ^ key) == input);
+                    }));
+
+    CHECK(rc::check("xor_repeating_in_place matches XOR byte by byte", [] {
+      const RawBytes input = gen_bytes_up_to(MAX_PROPERTY_BYTES);
+      // Keys either side of the unrolled pattern limit
+      const RawBytes key = gen_bytes(*rc::gen::inRange<size_t>(
+          1, REPEATING_XOR_MAX_PATTERN_KEY_BYTES + 8));
+      const size_t key_offset = *rc::gen::inRange<size_t>(0, 2 * key.size());
+      RawBytes output = input;
+      xor_repeating_in_place(output, key, key_offset);
+      for (size_t index = 0; index < input.size(); ++index) {
+        RC_ASSERT(output[index] ==
+                  uint8_t(input[index] ^
+                          key[(key_offset + index) % key.size()]));
+      }
+    }));
+
+    CHECK(rc::check("xor_repeating_in_place can run in pieces", [] {
+      const RawBytes input = gen_bytes_up_to(MAX_PROPERTY_BYTES);
+      const RawBytes key = gen_bytes(*rc::gen::inRange<size_t>(1, 40));
+      const size_t split = *rc::gen::inRange<size_t>(0, input.size() + 1);
+      RawBytes whole = input;
+      xor_repeating_in_place(whole, key);
+      RawBytes pieces = input;
+      const std::span<uint8_t> pieces_span(pieces);
+      xor_repeating_in_place(pieces_span.first(split), key);
+      xor_repeating_in_place(pieces_span.subspan(split), key, split);
+      RC_ASSERT(pieces == whole);
+    }));
+
+    CHECK_THROWS_AS(RawBytes(3) ^ RawBytes(4), std::length_error);
+    RawBytes output(4);
+    CHECK_THROWS_AS(xor_repeating_in_place(output, RawBytes{}),
+                    std::length_error);
+  }
 }
 
 } // namespace testing
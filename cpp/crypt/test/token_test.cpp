@@ -0,0 +1,77 @@
+#include <generators.hpp>
+
+#include <cookie.hpp>
+#include <token.hpp>
+
+#include <doctest/doctest.h>
+#include <rapidcheck.h>
+
+#include <algorithm>
+#include <string>
+
+namespace testing {
+
+static const std::string TOKEN_EMAIL_CHARACTERS = "abcxyz019.@_-&=";
+
+static CookieError verify(const c_TokenService &service,
+                          const RawBytes &token) {
+  c_ProfileCookie cookie;
+  return service.verify_token(token, cookie);
+}
+
+TEST_SUITE("crypt.token") {
+
+  TEST_CASE("issue_token and verify_token") {
+    CHECK(rc::check("A token verifies to the user profile it was issued for",
+                    [] {
+                      const c_TokenService service(gen_bytes(BLOCK_SIZE_BYTES));
+                      const std::string email =
+                          *rc::gen::container<std::string>(
+                              rc::gen::elementOf(TOKEN_EMAIL_CHARACTERS));
+                      const RawBytes token = service.issue_token(email);
+                      RC_ASSERT(token.size() % BLOCK_SIZE_BYTES == 0);
+
+                      c_ProfileCookie cookie;
+                      RC_ASSERT(service.verify_token(token, cookie) ==
+                                CookieError::ok);
+                      // The cookie keeps the email as it was encoded
+                      RC_ASSERT(cookie.m_email ==
+                                c_ProfileCookie::encode_string(email));
+                      RC_ASSERT(cookie.m_role == "user");
+
+                      // Reusing a buffer gives the next uid, not a stale one
+                      RawBytes reused = token;
+                      service.issue_token(email, reused);
+                      c_ProfileCookie next_cookie;
+                      RC_ASSERT(service.verify_token(reused, next_cookie) ==
+                                CookieError::ok);
+                      RC_ASSERT(next_cookie.m_email == cookie.m_email);
+                      RC_ASSERT(next_cookie.m_uid != cookie.m_uid);
+                    }));
+  }
+
+  TEST_CASE("bad tokens") {
+    const c_TokenService service(RawBytes(BLOCK_SIZE_BYTES, 0));
+    // Three blocks for any uid, so a truncated token still ends in text
+    const RawBytes token = service.issue_token("foo@bar.com");
+    REQUIRE(token.size() == 3 * BLOCK_SIZE_BYTES);
+    REQUIRE(verify(service, token) == CookieError::ok);
+
+    CHECK(verify(service, RawBytes()) == CookieError::bad_token);
+
+    const RawBytes unaligned(token.begin(), token.end() - 1);
+    CHECK(verify(service, unaligned) == CookieError::bad_token);
+
+    // Ends in cookie text rather than padding
+    const RawBytes truncated(token.begin(), token.end() - BLOCK_SIZE_BYTES);
+    CHECK(verify(service, truncated) == CookieError::bad_token);
+
+    // An ECB block swap: the final block now decrypts to "email=foo@bar.co"
+    RawBytes tampered = token;
+    std::copy(token.begin(), token.begin() + BLOCK_SIZE_BYTES,
+              tampered.end() - BLOCK_SIZE_BYTES);
+    CHECK(verify(service, tampered) == CookieError::bad_token);
+  }
+}
+
+} // namespace testing
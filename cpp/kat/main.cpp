@@ -0,0 +1,187 @@
+#include <cipher.hpp>
+#include <kat.hpp>
+#include <raw_bytes.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <future>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+constexpr std::string_view USAGE =
+    "usage: crypt-kat [-backend name] [-throughput bytes] path...\n"
+    "\n"
+    "Runs NIST known-answer vector files (.rsp), or every .rsp file in a\n"
+    "directory, against each registered cipher backend in parallel. Backends\n"
+    "that pass are then timed one at a time. Key schedule tables do not\n"
+    "depend on the backend and are checked once. Exits with 1 if any\n"
+    "vector fails.\n";
+
+constexpr size_t DEFAULT_THROUGHPUT_BYTES = 16 * 1024 * 1024;
+
+struct c_BackendReport {
+  c_CipherBackend m_backend;
+  c_KATResult m_result;
+  double m_megabytes_per_s = 0.0;
+};
+
+static std::vector<c_KATFile> load_kat_files(const std::string &path) {
+  std::vector<std::string> file_paths;
+  if (std::filesystem::is_directory(path)) {
+    for (const auto &entry : std::filesystem::directory_iterator(path)) {
+      if (entry.path().extension() == ".rsp") {
+        file_paths.push_back(entry.path().string());
+      }
+    }
+    std::sort(file_paths.begin(), file_paths.end());
+  } else {
+    file_paths.push_back(path);
+  }
+
+  std::vector<c_KATFile> output;
+  for (const auto &file_path : file_paths) {
+    output.push_back(load_kat_file(file_path));
+  }
+  return output;
+}
+
+// ECB over one buffer, so that every backend runs its widest kernel
+static double measure_megabytes_per_s(const c_CipherBackend &backend,
+                                      const size_t num_bytes) {
+  const RawBytes key_raw(16, 0x2b);
+  const auto cipher = backend.m_factory(key_raw);
+  RawBytes buffer(num_bytes / BLOCK_SIZE_BYTES * BLOCK_SIZE_BYTES, 0x6b);
+  const size_t num_blocks = buffer.size() / BLOCK_SIZE_BYTES;
+  // Warms the caches and the tables
+  cipher->encrypt_blocks(buffer.data(), buffer.data(),
+                         std::min<size_t>(num_blocks, 1024));
+
+  const auto begin = std::chrono::steady_clock::now();
+  cipher->encrypt_blocks(buffer.data(), buffer.data(), num_blocks);
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - begin;
+  return (elapsed.count() > 0.0)
+             ? double(buffer.size()) / 1e6 / elapsed.count()
+             : 0.0;
+}
+
+// Prints one row of the report and any failures under it. Returns whether
+// every vector passed.
+static bool print_kat_result(const std::string &name,
+                             const c_KATResult &result,
+                             const double megabytes_per_s) {
+  const bool is_passed = result.m_failures.empty();
+  std::cout << std::left << std::setw(12) << name
+            << (is_passed ? "PASS" : "FAIL") << std::right << std::setw(8)
+            << result.m_num_passed << " passed" << std::setw(8)
+            << result.m_failures.size() << " failed";
+  if (megabytes_per_s > 0.0) {
+    std::cout << std::setw(10) << std::fixed << std::setprecision(1)
+              << megabytes_per_s << " MB/s";
+  }
+  std::cout << std::endl;
+  for (const auto &failure : result.m_failures) {
+    std::cout << "  " << failure.m_file_name << " "
+              << (failure.m_direction == KATDirection::encrypt ? "ENCRYPT"
+                                                               : "DECRYPT")
+              << " COUNT = " << failure.m_count << std::endl;
+  }
+  return is_passed;
+}
+
+int main(int argc, char **argv) {
+  std::string backend_name;
+  size_t throughput_bytes = DEFAULT_THROUGHPUT_BYTES;
+  std::vector<c_KATFile> files;
+  try {
+    for (int arg_index = 1; arg_index < argc; ++arg_index) {
+      const std::string_view arg = argv[arg_index];
+      if ((arg == "-backend" || arg == "-throughput") &&
+          arg_index + 1 >= argc) {
+        throw std::invalid_argument(std::string(arg) + " needs a value");
+      }
+      if (arg == "-backend") {
+        backend_name = argv[++arg_index];
+      } else if (arg == "-throughput") {
+        throughput_bytes = std::stoul(argv[++arg_index]);
+      } else {
+        std::vector<c_KATFile> path_files = load_kat_files(std::string(arg));
+        files.insert(files.end(), path_files.begin(), path_files.end());
+      }
+    }
+    if (files.empty()) {
+      throw std::invalid_argument("No KAT files given");
+    }
+  } catch (const std::exception &error) {
+    std::cerr << "crypt-kat: " << error.what() << std::endl << USAGE;
+    return 1;
+  }
+
+  std::vector<c_CipherBackend> backends;
+  try {
+    backends = backend_name.empty()
+                   ? get_cipher_backends()
+                   : std::vector{get_cipher_backend(backend_name)};
+  } catch (const std::exception &error) {
+    std::cerr << "crypt-kat: " << error.what() << std::endl;
+    return 1;
+  }
+
+  size_t num_vectors = 0;
+  for (const auto &file : files) {
+    num_vectors += file.m_vectors.size();
+  }
+  std::cout << "Known-answer tests: " << files.size() << " files, "
+            << num_vectors << " vectors, " << backends.size() << " backends"
+            << std::endl;
+
+  // The key schedule does not depend on the backend, so it is checked once
+  c_KATResult key_expansion_result;
+  for (const auto &file : files) {
+    run_kat_key_expansion_file(file, key_expansion_result);
+  }
+
+  // One task per backend; each only reads the shared files
+  std::vector<std::future<c_BackendReport>> futures;
+  for (const auto &backend : backends) {
+    futures.push_back(std::async(std::launch::async, [&files, backend] {
+      c_BackendReport report{backend, {}};
+      for (const auto &file : files) {
+        run_kat_file(backend, file, report.m_result);
+      }
+      return report;
+    }));
+  }
+  std::vector<c_BackendReport> reports;
+  for (auto &future : futures) {
+    reports.push_back(future.get());
+  }
+
+  // Timed alone, so the backends do not compete for cores
+  if (throughput_bytes > 0) {
+    for (auto &report : reports) {
+      if (report.m_result.m_failures.empty()) {
+        report.m_megabytes_per_s =
+            measure_megabytes_per_s(report.m_backend, throughput_bytes);
+      }
+    }
+  }
+
+  bool is_all_passed = true;
+  if (key_expansion_result.m_num_passed > 0 ||
+      !key_expansion_result.m_failures.empty()) {
+    is_all_passed = print_kat_result("keyschedule", key_expansion_result, 0.0);
+  }
+  for (const auto &report : reports) {
+    const bool is_passed = print_kat_result(
+        report.m_backend.m_name, report.m_result, report.m_megabytes_per_s);
+    is_all_passed = is_all_passed && is_passed;
+  }
+  return is_all_passed ? 0 : 1;
+}
@@ -0,0 +1,139 @@
+#include <cookie.hpp>
+#include <raw_bytes.hpp>
+#include <token.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+constexpr size_t DEFAULT_REQUESTS_PER_THREAD = 20000;
+
+// Per request latencies in nanoseconds, of the round trips that succeeded
+struct c_LoadStats {
+  std::vector<uint64_t> m_issue_ns;
+  std::vector<uint64_t> m_verify_ns;
+  // Tokens that were refused, decoded to another email, or threw
+  size_t m_num_failures = 0;
+};
+
+uint64_t elapsed_ns(const std::chrono::steady_clock::time_point begin,
+                    const std::chrono::steady_clock::time_point end) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin)
+      .count();
+}
+
+void run_client(const c_TokenService &service, const size_t client_index,
+                const size_t num_requests, c_LoadStats &stats) {
+  stats.m_issue_ns.reserve(num_requests);
+  stats.m_verify_ns.reserve(num_requests);
+
+  RawBytes token;
+  c_ProfileCookie cookie;
+  const std::string email_prefix =
+      "client" + std::to_string(client_index) + ".user";
+  for (size_t request_index = 0; request_index < num_requests;
+       ++request_index) {
+    const std::string email =
+        email_prefix + std::to_string(request_index) + "@example.com";
+
+    std::chrono::steady_clock::time_point issue_begin;
+    std::chrono::steady_clock::time_point verify_begin;
+    std::chrono::steady_clock::time_point verify_end;
+    CookieError error = CookieError::ok;
+    try {
+      issue_begin = std::chrono::steady_clock::now();
+      service.issue_token(email, token);
+      verify_begin = std::chrono::steady_clock::now();
+      error = service.verify_token(token, cookie);
+      verify_end = std::chrono::steady_clock::now();
+    } catch (const std::exception &) {
+      ++stats.m_num_failures;
+      continue;
+    }
+
+    if (error != CookieError::ok || cookie.m_email != email) {
+      ++stats.m_num_failures;
+      continue;
+    }
+    stats.m_issue_ns.push_back(elapsed_ns(issue_begin, verify_begin));
+    stats.m_verify_ns.push_back(elapsed_ns(verify_begin, verify_end));
+  }
+}
+
+uint64_t percentile(std::vector<uint64_t> &samples, const double fraction) {
+  const size_t rank = std::min(samples.size() - 1,
+                               size_t(fraction * double(samples.size())));
+  std::nth_element(samples.begin(), samples.begin() + rank, samples.end());
+  return samples[rank];
+}
+
+void report(const std::string &name, std::vector<uint64_t> &samples) {
+  if (samples.empty()) {
+    return;
+  }
+  std::cout << name << " p50: " << percentile(samples, 0.5)
+            << "ns p99: " << percentile(samples, 0.99) << "ns" << std::endl;
+}
+
+int main(int argc, char **argv) {
+  const size_t num_threads =
+      (argc > 1) ? std::stoul(argv[1])
+                 : std::max<size_t>(std::thread::hardware_concurrency(), 1);
+  const size_t requests_per_thread =
+      (argc > 2) ? std::stoul(argv[2]) : DEFAULT_REQUESTS_PER_THREAD;
+
+  std::cout << "Token load generator: " << num_threads << " threads, "
+            << requests_per_thread << " requests each" << std::endl;
+
+  const c_TokenService service;
+  std::vector<c_LoadStats> thread_stats(num_threads);
+  std::vector<std::thread> threads;
+  threads.reserve(num_threads);
+
+  const auto begin = std::chrono::steady_clock::now();
+  for (size_t thread_index = 0; thread_index < num_threads; ++thread_index) {
+    threads.emplace_back(run_client, std::cref(service), thread_index,
+                         requests_per_thread,
+                         std::ref(thread_stats[thread_index]));
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  const double elapsed_s =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - begin)
+          .count();
+
+  c_LoadStats stats;
+  for (const auto &client_stats : thread_stats) {
+    stats.m_issue_ns.insert(stats.m_issue_ns.end(),
+                            client_stats.m_issue_ns.begin(),
+                            client_stats.m_issue_ns.end());
+    stats.m_verify_ns.insert(stats.m_verify_ns.end(),
+                             client_stats.m_verify_ns.begin(),
+                             client_stats.m_verify_ns.end());
+    stats.m_num_failures += client_stats.m_num_failures;
+  }
+
+  const size_t num_tokens = num_threads * requests_per_thread;
+  if (num_tokens == 0) {
+    return 0;
+  }
+  std::cout << "Round trips: " << num_tokens << " in " << elapsed_s << "s"
+            << std::endl;
+  std::cout << "Tokens/s: " << size_t(num_tokens / elapsed_s) << std::endl;
+  report("issue_token", stats.m_issue_ns);
+  report("verify_token", stats.m_verify_ns);
+  if (stats.m_num_failures > 0) {
+    std::cerr << "crypt-loadgen: " << stats.m_num_failures << " of "
+              << num_tokens << " round trips failed" << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
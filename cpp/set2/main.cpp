@@ -1,7 +1,7 @@
-#include <functional>
 #include <iostream>
 
 #include <crypt.hpp>
+#include <cut_and_paste.hpp>
 
 void padding_test(const size_t block_size_bytes) {
   const std::string input_key = "YELLOW SUBMARINE";
@@ -98,24 +98,17 @@ void c12() {
       "eW91IHN0b3A/IE5vLCBJIGp1c3QgZHJvdmUgYnkK");
 
   c_AES128SecretKeyEncrypter encrypter;
+  c_ECBSuffixOracle oracle(encrypter, target_plaintext_raw);
 
-  auto do_encrypt_base = [&encrypter](const RawBytes &input_raw) {
-    return encrypter.encrypt(input_raw);
-  };
-  auto do_encrypt_prefix = [&encrypter](const RawBytes &input_raw,
-                                        const RawBytes &prefix_raw) {
-    return encrypter.encrypt(input_raw, prefix_raw);
-  };
-
-  const size_t block_size_bytes = detect_block_size(do_encrypt_base);
+  const size_t block_size_bytes = detect_block_size(oracle);
 
   std::cout << "Detected block size: " << block_size_bytes << std::endl;
 
   const bool is_ecb =
-      detect_ecb(do_encrypt_base(RawBytes(block_size_bytes * 5, 'X')));
+      detect_ecb(oracle.query(RawBytes(block_size_bytes * 5, 'X')));
 
-  const size_t target_plaintext_length_bytes = detect_length_bytes(
-      block_size_bytes, target_plaintext_raw, do_encrypt_prefix);
+  const size_t target_plaintext_length_bytes =
+      detect_length_bytes(block_size_bytes, oracle);
 
   std::cout << "Target plaintext length: " << target_plaintext_length_bytes
             << std::endl;
@@ -123,44 +116,67 @@ void c12() {
   std::cout << "Is ECB: " << is_ecb << std::endl;
 
   std::cout << "Break ECB" << std::endl;
-  const RawBytes decrypted_raw =
-      break_ecb_byte_at_a_time(block_size_bytes, target_plaintext_length_bytes,
-                               encrypter, target_plaintext_raw);
+  const RawBytes decrypted_raw = break_ecb_byte_at_a_time(
+      block_size_bytes, target_plaintext_length_bytes, oracle);
 
   std::cout << "Plaintext after breaking ECB: " << std::endl;
   to_ascii_string(std::cout, decrypted_raw) << std::endl;
+  std::cout << oracle.m_stats;
+
+  for (const bool use_candidate_model : {false, true}) {
+    c_ByteAtATimeConfig config;
+    config.m_use_candidate_model = use_candidate_model;
+    c_ByteAtATimeStats stats;
+    oracle.m_stats.reset();
+
+    const RawBytes ordered_decrypted_raw = break_ecb_byte_at_a_time(
+        block_size_bytes, target_plaintext_length_bytes, oracle, config, stats);
+
+    std::cout << "Candidate model: " << use_candidate_model
+              << " matches: " << (ordered_decrypted_raw == decrypted_raw)
+              << " expected oracle calls per byte: "
+              << stats.expected_oracle_calls_per_byte()
+              << " issued oracle calls per byte: "
+              << stats.oracle_calls_per_byte() << std::endl;
+    std::cout << oracle.m_stats;
+  }
 }
 
-void do_attack(c_AES128SecretKeyEncrypter &encrypter) {
-
-  const std::string email =
-      "123456789@admin" + std::string(char(16 - 5), 16 - 5);
-  const std::string profile_cookie_string = profile_for(email);
-  const RawBytes plaintext_raw = from_ascii_string(profile_cookie_string);
-
-  to_ascii_string_in_blocks(std::cout, plaintext_raw, 16);
-
-  const RawBytes ciphertext_raw = encrypter.encrypt(plaintext_raw);
-
-  to_hex_string_in_blocks(std::cout, ciphertext_raw, 16);
-
-  const ByteBlock second_block =
-      from_raw_bytes_to_byte_block(ciphertext_raw, 1);
-
-  const std::string final_email = "my__@admin.com";
-  const std::string final_profile_cookie_string = profile_for(final_email);
-
-  const RawBytes final_plaintext_raw =
-      from_ascii_string(final_profile_cookie_string);
-
-  to_ascii_string_in_blocks(std::cout, final_plaintext_raw, 16);
-
-  RawBytes final_ciphertext_raw = encrypter.encrypt(final_plaintext_raw);
+// profile_for with the uid pinned, so one email always gives one cookie
+static std::string profile_for_fixed_uid(const std::string_view email) {
+  return c_ProfileCookie(std::string(email), 10, "user").to_string();
+}
 
-  to_hex_string_in_blocks(std::cout, final_ciphertext_raw, 16);
+void do_attack(c_AES128SecretKeyEncrypter &encrypter) {
+  c_CountingOracle oracle([&encrypter](const ByteSpan input) {
+    return encrypter.encrypt(from_ascii_string(profile_for_fixed_uid(
+        std::string_view(reinterpret_cast<const char *>(input.data()),
+                         input.size()))));
+  });
+
+  // Only some email lengths leave the role starting a block of its own
+  std::string target;
+  c_CutAndPastePlan plan;
+  for (size_t local_length = 1; target.empty(); ++local_length) {
+    const std::string email = std::string(local_length, 'x') + "@admin.com";
+    try {
+      const std::string candidate =
+          c_ProfileCookie(email, 10, "admin").to_string();
+      plan = plan_cut_and_paste(profile_for_fixed_uid, candidate,
+                                BLOCK_SIZE_BYTES);
+      target = candidate;
+    } catch (const std::invalid_argument &) {
+    }
+  }
 
-  from_byte_block_to_raw_bytes(second_block, final_ciphertext_raw, 2);
+  std::cout << "Target cookie: " << std::endl;
+  to_ascii_string_in_blocks(std::cout, from_ascii_string(target), 16);
+  for (const std::string &probe : plan.m_probes) {
+    std::cout << "Probe email: " << probe << std::endl;
+  }
 
+  const RawBytes final_ciphertext_raw =
+      forge_cut_and_paste(plan, BLOCK_SIZE_BYTES, oracle);
   to_hex_string_in_blocks(std::cout, final_ciphertext_raw, 16);
 
   const RawBytes attacked_plaintext_raw =
@@ -168,6 +184,13 @@ void do_attack(c_AES128SecretKeyEncrypter &encrypter) {
 
   std::cout << "Attacked cookie: " << std::endl;
   to_ascii_string(std::cout, attacked_plaintext_raw) << std::endl;
+  std::cout << "Role: "
+            << c_ProfileCookie::from_string(
+                   std::string(std::begin(attacked_plaintext_raw),
+                               std::end(attacked_plaintext_raw)))
+                   .m_role
+            << std::endl;
+  std::cout << oracle.m_stats;
 }
 
 void c13() {
@@ -202,6 +225,33 @@ void c13() {
   // to_ascii_string(std::cout, plaintext_recreated_raw) << std::endl;
 }
 
+void c14() {
+  const RawBytes target_plaintext_raw = from_base64_string(
+      "Um9sbGluJyBpbiBteSA1LjAKV2l0aCBteSByYWctdG9wIGRvd24gc28gbXkgaGFpciBjYW4g"
+      "YmxvdwpUaGUgZ2lybGllcyBvbiBzdGFuZGJ5IHdhdmluZyBqdXN0IHRvIHNheSBoaQpEaWQg"
+      "eW91IHN0b3A/IE5vLCBJIGp1c3QgZHJvdmUgYnkK");
+
+  c_AES128SecretKeyEncrypter encrypter;
+  c_ECBRandomPrefixOracle oracle(encrypter, target_plaintext_raw);
+
+  const size_t block_size_bytes = detect_block_size(oracle);
+  std::cout << "Detected block size: " << block_size_bytes << std::endl;
+  oracle.m_stats.reset();
+
+  const c_ByteAtATimeConfig config;
+  c_RandomPrefixStats stats;
+  const RawBytes decrypted_raw =
+      break_ecb_random_prefix(block_size_bytes, oracle, config, stats);
+
+  std::cout << "Plaintext after breaking ECB: " << std::endl;
+  to_ascii_string(std::cout, decrypted_raw) << std::endl;
+  std::cout << "Matches: " << (decrypted_raw == target_plaintext_raw)
+            << " prefix length: " << oracle.m_secret_prefix_raw.size()
+            << " alignment oracle calls: " << stats.m_alignment_oracle_calls
+            << " total oracle calls: " << stats.oracle_calls() << std::endl;
+  std::cout << oracle.m_stats;
+}
+
 int main() {
   std::cout << "Cryptopals set2" << std::endl;
 
@@ -210,6 +260,7 @@ int main() {
   // c11();
   // c12();
   c13();
+  // c14();
 
   return 0;
 }
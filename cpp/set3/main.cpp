@@ -0,0 +1,56 @@
+#include <iostream>
+
+#include <crypt.hpp>
+
+void c17() {
+  const std::vector<std::string> input_strings = {
+      "MDAwMDAwTm93IHRoYXQgdGhlIHBhcnR5IGlzIGp1bXBpbmc=",
+      "MDAwMDAxV2l0aCB0aGUgYmFzcyBraWNrZWQgaW4gYW5kIHRoZSBWZWdhJ3MgYXJlIHB1bXBp"
+      "bic=",
+      "MDAwMDAyUXVpY2sgdG8gdGhlIHBvaW50LCB0byB0aGUgcG9pbnQsIG5vIGZha2luZw==",
+      "MDAwMDAzQ29va2luZyBNQydzIGxpa2UgYSBwb3VuZCBvZiBiYWNvbg==",
+      "MDAwMDA0QnVybmluZyAnZW0sIGlmIHlvdSBhaW4ndCBxdWljayBhbmQgbmltYmxl",
+      "MDAwMDA1SSBnbyBjcmF6eSB3aGVuIEkgaGVhciBhIGN5bWJhbA==",
+      "MDAwMDA2QW5kIGEgaGlnaCBoYXQgd2l0aCBhIHNvdXBlZCB1cCB0ZW1wbw==",
+      "MDAwMDA3SSdtIG9uIGEgcm9sbCwgaXQncyB0aW1lIHRvIGdvIHNvbG8=",
+      "MDAwMDA4b2xsaW4nIGluIG15IGZpdmUgcG9pbnQgb2g=",
+      "MDAwMDA5aXRoIG15IHJhZy10b3AgZG93biBzbyBteSBoYWlyIGNhbiBibG93",
+  };
+
+  c_AES128SecretKeyEncrypter encrypter;
+  c_CBCPaddingOracle oracle(encrypter);
+
+  for (const bool use_candidate_model : {false, true}) {
+    c_PaddingOracleConfig config;
+    config.m_use_candidate_model = use_candidate_model;
+    config.m_num_threads = 0;
+    c_PaddingOracleStats stats;
+    oracle.m_stats.reset();
+
+    for (const auto &input_str : input_strings) {
+      const RawBytes plaintext_raw = from_base64_string(input_str);
+      const RawBytes iv_raw = from_byte_block_to_raw_bytes(gen_rand_block());
+      const RawBytes ciphertext_raw = AES_CBC_encrypt(
+          plaintext_raw, encrypter.m_key_schedule, iv_raw);
+
+      const RawBytes recovered_raw = break_cbc_padding_oracle(
+          oracle, iv_raw, ciphertext_raw, config, stats);
+      to_ascii_string(std::cout,
+                      remove_pkcs7_padding(recovered_raw, BLOCK_SIZE_BYTES))
+          << std::endl;
+    }
+
+    std::cout << "Candidate model: " << use_candidate_model
+              << " oracle queries per byte: " << stats.oracle_calls_per_byte()
+              << std::endl;
+    std::cout << oracle.m_stats;
+  }
+}
+
+int main() {
+  std::cout << "Cryptopals set3" << std::endl;
+
+  c17();
+
+  return 0;
+}